@@ -0,0 +1,227 @@
+/**
+ * @file audio_output.cpp
+ * @brief Implementation of the AudioOutput class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "audio_output.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    /**
+     * @brief Current steady_clock time in nanoseconds
+     */
+    int64_t nowNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+AudioOutput::AudioOutput(const AVIReader& reader)
+    : reader(reader), device(0), sourceFrameBytes(0), deviceFrameBytes(0), expand24(false),
+      stopping(false), running(false), feedPosition(0), startFrame(0),
+      feedDone(false), playedFrames(0), callbackTime(0), underruns(0) {
+    std::memset(&spec, 0, sizeof(spec));
+}
+
+AudioOutput::~AudioOutput() {
+    close();
+}
+
+bool AudioOutput::open() {
+    const WaveFormatEx& format = reader.getWaveFormat();
+
+    SDL_AudioSpec desired;
+    std::memset(&desired, 0, sizeof(desired));
+    desired.freq = static_cast<int>(format.samplesPerSec);
+    desired.channels = static_cast<Uint8>(format.channels);
+    desired.samples = 1024;
+    desired.callback = audioCallback;
+    desired.userdata = this;
+
+    // Map the WAVEFORMATEX sample type onto an SDL sample format
+    expand24 = false;
+    if (format.formatTag == 3 && format.bitsPerSample == 32) {
+        desired.format = AUDIO_F32LSB;
+    } else if (format.formatTag == 1 && format.bitsPerSample == 8) {
+        desired.format = AUDIO_U8;
+    } else if (format.formatTag == 1 && format.bitsPerSample == 16) {
+        desired.format = AUDIO_S16LSB;
+    } else if (format.formatTag == 1 && format.bitsPerSample == 24) {
+        desired.format = AUDIO_S32LSB; // SDL has no packed 24-bit format
+        expand24 = true;
+    } else if (format.formatTag == 1 && format.bitsPerSample == 32) {
+        desired.format = AUDIO_S32LSB;
+    } else {
+        std::cerr << "Error: Unsupported audio sample size: " << format.bitsPerSample << std::endl;
+        return false;
+    }
+
+    sourceFrameBytes = format.blockAlign;
+    deviceFrameBytes = static_cast<uint32_t>(format.channels) * (SDL_AUDIO_BITSIZE(desired.format) / 8);
+    if (format.channels == 0 || sourceFrameBytes * 8u != format.channels * format.bitsPerSample) {
+        std::cerr << "Error: Inconsistent audio format" << std::endl;
+        return false;
+    }
+
+    if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0) {
+        std::cerr << "SDL Audio Init Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    // No allowed changes: SDL converts to the hardware format itself
+    device = SDL_OpenAudioDevice(nullptr, 0, &desired, &spec, 0);
+    if (device == 0) {
+        std::cerr << "Audio Device Error: " << SDL_GetError() << std::endl;
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+        return false;
+    }
+
+    // About a second of buffering rides out disk stalls and slow video frames;
+    // the feeder reads an eighth of a second at a time
+    ring.reset(new RingBuffer(static_cast<size_t>(spec.freq) * deviceFrameBytes));
+    size_t chunkFrames = spec.freq / 8 > 0 ? spec.freq / 8 : 1;
+    readBuffer.resize(chunkFrames * sourceFrameBytes);
+    convertBuffer.resize(chunkFrames * deviceFrameBytes);
+
+    return true;
+}
+
+void AudioOutput::close() {
+    if (device == 0) return;
+
+    stop();
+    SDL_CloseAudioDevice(device);
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    device = 0;
+}
+
+void AudioOutput::start(double seconds) {
+    if (device == 0) return;
+
+    stop();
+
+    if (seconds < 0) seconds = 0;
+    startFrame = static_cast<uint64_t>(seconds * spec.freq);
+    feedPosition = startFrame * sourceFrameBytes;
+    ring->reset();
+    feedDone = false;
+    playedFrames = 0;
+    callbackTime = nowNanoseconds();
+
+    // Prefill so the first callbacks after a seek already have data
+    for (int i = 0; i < 4 && fill(); ++i) {
+    }
+
+    stopping = false;
+    feeder = std::thread(&AudioOutput::feederLoop, this);
+    running = true;
+    SDL_PauseAudioDevice(device, 0);
+}
+
+void AudioOutput::stop() {
+    if (device == 0) return;
+
+    // Pausing waits for a running callback to return
+    SDL_PauseAudioDevice(device, 1);
+    running = false;
+
+    if (feeder.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        feeder.join();
+    }
+}
+
+bool AudioOutput::isDrained() const {
+    return feedDone.load() && ring && ring->readable() == 0;
+}
+
+double AudioOutput::getClock() const {
+    if (device == 0 || spec.freq <= 0) return 0.0;
+
+    double rate = spec.freq;
+    double start = startFrame / rate;
+    if (!running) return start;
+
+    // The buffer handed over by the last callback is what is playing now
+    double bufferSeconds = spec.samples / rate;
+    double sinceCallback = (nowNanoseconds() - callbackTime.load()) / 1e9;
+    if (sinceCallback > bufferSeconds) sinceCallback = bufferSeconds;
+
+    double clock = start + playedFrames.load() / rate - bufferSeconds + sinceCallback;
+    return clock > start ? clock : start;
+}
+
+void AudioOutput::audioCallback(void* userdata, Uint8* stream, int len) {
+    static_cast<AudioOutput*>(userdata)->mix(stream, len);
+}
+
+void AudioOutput::mix(uint8_t* stream, int len) {
+    size_t size = static_cast<size_t>(len);
+    size_t copied = ring->read(stream, size);
+
+    if (copied < size) {
+        // Pad with silence; only counts as an underrun before the end of the stream
+        std::memset(stream + copied, spec.silence, size - copied);
+        if (!feedDone.load()) underruns++;
+    }
+
+    playedFrames += copied / deviceFrameBytes;
+    callbackTime = nowNanoseconds();
+}
+
+bool AudioOutput::fill() {
+    if (feedDone.load()) return false;
+
+    size_t frames = readBuffer.size() / sourceFrameBytes;
+    if (ring->writable() < frames * deviceFrameBytes) return false;
+
+    size_t bytes = reader.readAudio(feedPosition, readBuffer.data(), frames * sourceFrameBytes);
+    bytes -= bytes % sourceFrameBytes;
+    if (bytes == 0) {
+        feedDone = true;
+        return false;
+    }
+    feedPosition += bytes;
+
+    if (expand24) {
+        // Widen packed little-endian 24-bit samples to 32-bit
+        size_t samples = bytes / 3;
+        const uint8_t* src = readBuffer.data();
+        uint8_t* dst = convertBuffer.data();
+        for (size_t i = 0; i < samples; ++i) {
+            dst[i * 4 + 0] = 0;
+            dst[i * 4 + 1] = src[i * 3 + 0];
+            dst[i * 4 + 2] = src[i * 3 + 1];
+            dst[i * 4 + 3] = src[i * 3 + 2];
+        }
+        ring->write(convertBuffer.data(), samples * 4);
+    } else {
+        ring->write(readBuffer.data(), bytes);
+    }
+
+    return true;
+}
+
+void AudioOutput::feederLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (!stopping) {
+        lock.unlock();
+        bool added = fill();
+        lock.lock();
+
+        // Nothing to do until the device drains some of the ring
+        if (!added) {
+            wake.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+}
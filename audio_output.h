@@ -0,0 +1,156 @@
+/**
+ * @file audio_output.h
+ * @brief PCM audio playback and audio clock
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the AudioOutput class, which plays the uncompressed
+ * audio stream of an AVI file through an SDL audio device and reports the
+ * playback position that the video scheduler follows.
+ */
+
+#ifndef AUDIO_OUTPUT_H
+#define AUDIO_OUTPUT_H
+
+#include "avi_reader.h"
+#include "ring_buffer.h"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Audio stream player
+ *
+ * A feeder thread reads the audio stream through the reader and keeps a
+ * lock-free ring buffer about a second ahead of the device. The SDL audio
+ * callback only copies from the ring, so it never blocks on disk I/O or on
+ * the video thread. getClock() returns the time of the sample currently
+ * being heard, interpolated between callbacks.
+ */
+class AudioOutput {
+private:
+    const AVIReader& reader;             ///< Source of the audio stream
+    SDL_AudioDeviceID device;            ///< Open audio device, 0 if none
+    SDL_AudioSpec spec;                  ///< Format the device was opened with
+    uint32_t sourceFrameBytes;           ///< Bytes per sample frame in the file
+    uint32_t deviceFrameBytes;           ///< Bytes per sample frame in the ring
+    bool expand24;                       ///< True if 24-bit samples are widened to 32-bit
+    std::unique_ptr<RingBuffer> ring;    ///< Samples in device format
+    std::vector<uint8_t> readBuffer;     ///< Feeder staging for file data
+    std::vector<uint8_t> convertBuffer;  ///< Feeder staging for widened samples
+
+    std::thread feeder;                  ///< Ring refill thread
+    std::mutex mutex;                    ///< Guards stopping for the feeder wait
+    std::condition_variable wake;        ///< Wakes the feeder when stopping
+    bool stopping;                       ///< Asks the feeder to exit
+    bool running;                        ///< True while the device is playing
+    uint64_t feedPosition;               ///< Next byte of the stream to read
+    uint64_t startFrame;                 ///< Sample frame playback started at
+
+    std::atomic<bool> feedDone;          ///< Feeder reached the end of the stream
+    std::atomic<uint64_t> playedFrames;  ///< Sample frames handed to the device since start
+    std::atomic<int64_t> callbackTime;   ///< steady_clock time of the last callback (ns)
+    std::atomic<uint32_t> underruns;     ///< Callbacks that ran out of data
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param reader Open reader whose audio stream is played; must outlive this object
+     */
+    explicit AudioOutput(const AVIReader& reader);
+
+    /**
+     * @brief Destructor
+     *
+     * Stops playback and closes the device.
+     */
+    ~AudioOutput();
+
+    /**
+     * @brief Open an audio device matching the stream format
+     *
+     * Initializes the SDL audio subsystem and opens the default device,
+     * letting SDL convert to whatever the hardware supports.
+     *
+     * @return true if the device was opened, false otherwise
+     */
+    bool open();
+
+    /**
+     * @brief Stop playback and close the device
+     */
+    void close();
+
+    /**
+     * @brief Start playback at a stream position
+     *
+     * Discards buffered samples, refills the ring from the new position and
+     * unpauses the device.
+     *
+     * @param seconds Position in the audio stream
+     */
+    void start(double seconds);
+
+    /**
+     * @brief Pause playback and stop the feeder
+     */
+    void stop();
+
+    /** @brief True while the device is playing */
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief True once every sample of the stream has been played
+     *
+     * The clock stops advancing at that point, so callers fall back to
+     * their own timing.
+     */
+    bool isDrained() const;
+
+    /**
+     * @brief Time of the sample currently being heard
+     *
+     * @return Position in seconds from the start of the stream
+     */
+    double getClock() const;
+
+    /** @brief Number of callbacks that had to pad with silence */
+    uint32_t getUnderrunCount() const { return underruns.load(); }
+
+private:
+    AudioOutput(const AudioOutput&);
+    AudioOutput& operator=(const AudioOutput&);
+
+    /**
+     * @brief SDL audio callback trampoline
+     */
+    static void audioCallback(void* userdata, Uint8* stream, int len);
+
+    /**
+     * @brief Copy samples from the ring to the device
+     *
+     * @param stream Device buffer
+     * @param len Size of the device buffer in bytes
+     */
+    void mix(uint8_t* stream, int len);
+
+    /**
+     * @brief Top up the ring from the file
+     *
+     * @return true if data was added, false if the ring is full or the stream ended
+     */
+    bool fill();
+
+    /**
+     * @brief Feeder thread main loop
+     */
+    void feederLoop();
+};
+
+#endif // AUDIO_OUTPUT_H
@@ -0,0 +1,199 @@
+/**
+ * @file avi_editor.cpp
+ * @brief Implementation of the AVIEditor class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "avi_editor.h"
+#include "path_pattern.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    bool compareOffsets(const AVIChunkRef& a, const AVIChunkRef& b) {
+        return a.offset < b.offset;
+    }
+
+    double seconds(const AVIStreamHeader& header, double units) {
+        return header.rate > 0 ? units * header.scale / header.rate : 0.0;
+    }
+}
+
+AVIEditor::AVIEditor(const AVIReader& reader, int streamNumber)
+    : reader(reader), streamNumber(streamNumber), bytesWritten(0) {
+}
+
+bool AVIEditor::trim(const std::string& path, uint32_t first, uint32_t last) {
+    const AVIStream& stream = reader.getStream(streamNumber);
+    uint32_t count = stream.getChunkCount();
+    if (!stream.isVideo() || first >= count || last < first) {
+        std::cerr << "Error: Frames " << first << "-" << last << " are not in stream " << streamNumber << std::endl;
+        return false;
+    }
+    if (last >= count) last = count - 1;
+
+    // Delta frames (RLE) need the frames before them back to a key frame
+    uint32_t keyframe = stream.keyframes.empty() ? first : stream.findKeyframe(first);
+    if (keyframe != first) {
+        std::cout << "  Starting at key frame " << keyframe << " instead of " << first << std::endl;
+        first = keyframe;
+    }
+
+    std::vector<AVIChunkRef> chunks;
+    selectChunks(reader, first, last, chunks);
+
+    AVIWriter writer;
+    addStreams(writer);
+    if (!writer.open(path)) return false;
+    bool success = writer.copyChunks(reader, chunks);
+    success = writer.close() && success;
+    bytesWritten += writer.getFileSize();
+    return success;
+}
+
+bool AVIEditor::split(const std::string& pattern, uint32_t framesPerPart) {
+    uint32_t count = reader.getStream(streamNumber).getChunkCount();
+    if (framesPerPart == 0 || count == 0) return false;
+    if (!isNumberPattern(pattern)) {
+        std::cerr << "Error: Output pattern " << pattern << " needs exactly one %d or %u (%% for a literal %)" << std::endl;
+        return false;
+    }
+
+    uint32_t part = 1;
+    for (uint32_t first = 0; first < count; first += framesPerPart, ++part) {
+        uint32_t last = std::min(count - 1, first + (framesPerPart - 1));
+        std::string path = formatNumberPattern(pattern, part);
+        if (!trim(path, first, last)) return false;
+        std::cout << "  " << path << ": frames " << first << "-" << last << std::endl;
+    }
+    return true;
+}
+
+bool AVIEditor::concat(const std::string& path, const std::vector<const AVIReader*>& others) {
+    for (size_t i = 0; i < others.size(); ++i) {
+        if (!isCompatible(*others[i], i + 2)) return false;
+    }
+
+    AVIWriter writer;
+    addStreams(writer);
+    if (!writer.open(path)) return false;
+
+    // Each file is copied whole; chunk runs and block alignment are
+    // worked out per file, so the data of every file can be shared
+    std::vector<AVIChunkRef> chunks;
+    bool success = true;
+    for (size_t i = 0; i <= others.size() && success; ++i) {
+        const AVIReader& source = i == 0 ? reader : *others[i - 1];
+        uint32_t count = source.getStream(streamNumber).getChunkCount();
+        if (count == 0) continue;
+        selectChunks(source, 0, count - 1, chunks);
+        success = writer.copyChunks(source, chunks);
+    }
+    success = writer.close() && success;
+    bytesWritten += writer.getFileSize();
+    return success;
+}
+
+void AVIEditor::selectChunks(const AVIReader& source, uint32_t first, uint32_t last, std::vector<AVIChunkRef>& chunks) const {
+    const AVIStream& video = source.getStream(streamNumber);
+
+    // Everything stored from the first frame up to the frame after the
+    // range; the first and the last cut also take what lies before and
+    // after all frames
+    uint64_t begin = first > 0 ? video.chunkOffsets[first] : 0;
+    uint64_t end = last + 1 < video.getChunkCount() ? video.chunkOffsets[last + 1] : UINT64_MAX;
+    double beginTime = first > 0 ? seconds(video.header, static_cast<double>(video.header.start) + first) : -HUGE_VAL;
+    double endTime = last + 1 < video.getChunkCount() ? seconds(video.header, static_cast<double>(video.header.start) + last + 1) : HUGE_VAL;
+
+    chunks.clear();
+    for (int s = 0; s < source.getStreamCount(); ++s) {
+        const AVIStream& stream = source.getStream(s);
+        const std::vector<uint64_t>& offsets = stream.chunkOffsets;
+        const std::vector<uint32_t>& sizes = stream.chunkSizes;
+        const std::vector<uint32_t>& keyframes = stream.keyframes;
+        if (s != streamNumber && stream.isAudio() && stream.waveFormat.avgBytesPerSec > 0) {
+            // Audio is interleaved ahead of its frames, by up to a second
+            // in capture files and more with preloaded audio, so it goes by
+            // time: a chunk belongs to the range holding its middle, which
+            // keeps it in sync and hands it to exactly one of two adjacent cuts
+            double rate = stream.waveFormat.avgBytesPerSec;
+            double time = seconds(stream.header, stream.header.start);
+            for (size_t i = 0; i < offsets.size(); ++i) {
+                double middle = time + sizes[i] / (2 * rate);
+                time += sizes[i] / rate;
+                if (middle < beginTime || middle >= endTime) continue;
+                AVIChunkRef chunk = { s, offsets[i], sizes[i], true };
+                chunks.push_back(chunk);
+            }
+            continue;
+        }
+
+        size_t from = std::lower_bound(offsets.begin(), offsets.end(), begin) - offsets.begin();
+        size_t to = std::lower_bound(offsets.begin(), offsets.end(), end) - offsets.begin();
+        for (size_t i = from; i < to; ++i) {
+            // Without an index nothing is known to be a delta frame
+            bool keyframe = keyframes.empty() ||
+                            std::binary_search(keyframes.begin(), keyframes.end(), static_cast<uint32_t>(i));
+            AVIChunkRef chunk = { s, offsets[i], sizes[i], keyframe };
+            chunks.push_back(chunk);
+        }
+    }
+    std::sort(chunks.begin(), chunks.end(), compareOffsets);
+}
+
+bool AVIEditor::isCompatible(const AVIReader& other, size_t fileNumber) const {
+    if (other.getStreamCount() != reader.getStreamCount()) {
+        std::cerr << "Error: File " << fileNumber << " has " << other.getStreamCount()
+                  << " streams, the first file " << reader.getStreamCount() << std::endl;
+        return false;
+    }
+
+    for (int s = 0; s < reader.getStreamCount(); ++s) {
+        const AVIStream& a = reader.getStream(s);
+        const AVIStream& b = other.getStream(s);
+        const char* difference = nullptr;
+        if (std::memcmp(a.header.fccType, b.header.fccType, 4) != 0 ||
+            std::memcmp(a.header.fccHandler, b.header.fccHandler, 4) != 0) {
+            difference = "type or codec";
+        } else if (a.header.rate != b.header.rate || a.header.scale != b.header.scale ||
+                   a.header.sampleSize != b.header.sampleSize) {
+            difference = "rate";
+        } else if (std::memcmp(a.chunkId, b.chunkId, 4) != 0) {
+            difference = "chunk ID";
+        } else if (a.isVideo()) {
+            // The image size may or may not be filled in; the rest must match
+            const BitmapInfoHeader& x = a.bitmapHeader;
+            const BitmapInfoHeader& y = b.bitmapHeader;
+            if (x.width != y.width || x.height != y.height || x.planes != y.planes ||
+                x.bitCount != y.bitCount || x.compression != y.compression ||
+                a.palette.size() != b.palette.size() ||
+                (!a.palette.empty() && std::memcmp(a.palette.data(), b.palette.data(), a.palette.size() * sizeof(RGBQuad)) != 0)) {
+                difference = "bitmap format";
+            }
+        } else if (a.format != b.format) {
+            difference = "format";
+        }
+
+        if (difference) {
+            std::cerr << "Error: Stream " << s << " of file " << fileNumber << " differs from the first file ("
+                      << difference << ")" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void AVIEditor::addStreams(AVIWriter& writer) const {
+    // Same streams and formats; lengths and indexes are rebuilt
+    writer.setMainHeader(reader.getMainHeader());
+    for (int s = 0; s < reader.getStreamCount(); ++s) {
+        AVIStreamHeader header = reader.getStream(s).header;
+        header.start = 0;
+        header.initialFrames = 0;
+        writer.addStream(header, reader.getStream(s).format);
+    }
+}
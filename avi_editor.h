@@ -0,0 +1,127 @@
+/**
+ * @file avi_editor.h
+ * @brief Lossless trimming, splitting and concatenation of AVI files
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the AVIEditor class, which cuts frame ranges out of
+ * an AVI file into new files, or joins files, without decoding or
+ * re-encoding anything.
+ */
+
+#ifndef AVI_EDITOR_H
+#define AVI_EDITOR_H
+
+#include "avi_reader.h"
+#include "avi_writer.h"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Frame-accurate cutting of an AVI file
+ *
+ * A cut covers the chunks between the first frame of the range and the
+ * first frame after it, so interleaved audio and other video streams go
+ * with the frames they are stored next to, and consecutive cuts share no
+ * chunk. The chunks are copied with AVIWriter, which lets the kernel copy
+ * or share them without reading them into memory, and the output gets new
+ * headers and indexes. Files of the same format can be joined the same
+ * way.
+ *
+ * Usage example:
+ * @code
+ * AVIEditor editor(reader, reader.getVideoStream());
+ * editor.trim("intro.avi", 0, 299);
+ * editor.split("part%03d.avi", 9000);
+ * editor.concat("all.avi", others);    // this file, then the others
+ * @endcode
+ */
+class AVIEditor {
+private:
+    const AVIReader& reader;         ///< Source file
+    int streamNumber;                ///< Video stream that defines the frame ranges
+    uint64_t bytesWritten;           ///< Size of the files written so far
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param reader Open reader; must outlive this object
+     * @param streamNumber Video stream whose frames define the ranges
+     */
+    AVIEditor(const AVIReader& reader, int streamNumber);
+
+    /**
+     * @brief Write a range of frames to a new file
+     *
+     * A range that starts on a delta frame is extended back to the key
+     * frame before it, so that the output decodes from its first frame.
+     * Key-frame flags are kept in the output indexes.
+     *
+     * @param path Output path
+     * @param first First frame of the range
+     * @param last Last frame of the range (inclusive)
+     * @return true on success, false if the range is empty or a write failed
+     */
+    bool trim(const std::string& path, uint32_t first, uint32_t last);
+
+    /**
+     * @brief Split the file into parts of equal length
+     *
+     * @param pattern Output path with a printf-style part number (e.g. part%03d.avi); parts are numbered from 1
+     * @param framesPerPart Frames per part; the last part may be shorter
+     * @return true if every part was written
+     */
+    bool split(const std::string& pattern, uint32_t framesPerPart);
+
+    /**
+     * @brief Join this file and other files into a new file
+     *
+     * All files must have the same streams with the same formats, chunk
+     * IDs and rates. The headers are taken from this file.
+     *
+     * @param path Output path
+     * @param others Open readers of the files to append, in order
+     * @return true on success, false if a file does not match or a write failed
+     */
+    bool concat(const std::string& path, const std::vector<const AVIReader*>& others);
+
+    /** @brief Total size of the files written */
+    uint64_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    AVIEditor(const AVIEditor&);
+    AVIEditor& operator=(const AVIEditor&);
+
+    /**
+     * @brief Collect the chunks of all streams that belong to a frame range
+     *
+     * Other streams take what is stored between the range's frames; audio
+     * with a known data rate takes the chunks that play during them.
+     *
+     * @param source File to take the chunks from
+     * @param first First frame of the range
+     * @param last Last frame of the range (inclusive)
+     * @param chunks Receives the chunks in file order
+     */
+    void selectChunks(const AVIReader& source, uint32_t first, uint32_t last, std::vector<AVIChunkRef>& chunks) const;
+
+    /**
+     * @brief Check that another file can be appended to this one
+     *
+     * Prints the first difference found.
+     *
+     * @param other File to check
+     * @param fileNumber Position of the file in the output, for messages
+     * @return true if the streams match
+     */
+    bool isCompatible(const AVIReader& other, size_t fileNumber) const;
+
+    /**
+     * @brief Declare the streams of this file in a writer
+     */
+    void addStreams(AVIWriter& writer) const;
+};
+
+#endif // AVI_EDITOR_H
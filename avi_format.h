@@ -0,0 +1,216 @@
+/**
+ * @file avi_format.h
+ * @brief On-disk structures of the RIFF AVI container
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the packed structures that mirror the chunks of an
+ * AVI file (RIFF header, main header, stream headers and formats). They are
+ * shared by the reader, the player and the tools built on top of them.
+ */
+
+#ifndef AVI_FORMAT_H
+#define AVI_FORMAT_H
+
+#include <cstdint>
+
+/**
+ * @brief RIFF file header structure
+ *
+ * Contains the basic RIFF container information for AVI files.
+ */
+#pragma pack(push, 1)
+struct RIFFHeader {
+    char signature[4];      ///< "RIFF" signature
+    uint32_t fileSize;      ///< Total file size minus 8 bytes
+    char format[4];         ///< "AVI " format identifier
+};
+
+/**
+ * @brief Main AVI header structure (avih chunk)
+ *
+ * Contains global information about the AVI file including
+ * frame rate, dimensions, and total frame count.
+ */
+struct AVIMainHeader {
+    uint32_t microSecPerFrame;      ///< Frame duration in microseconds
+    uint32_t maxBytesPerSec;        ///< Maximum data rate
+    uint32_t paddingGranularity;    ///< Padding granularity
+    uint32_t flags;                 ///< AVI file flags
+    uint32_t totalFrames;           ///< Total number of frames
+    uint32_t initialFrames;         ///< Initial frames for interleaved files
+    uint32_t streams;               ///< Number of streams
+    uint32_t suggestedBufferSize;   ///< Suggested buffer size
+    uint32_t width;                 ///< Video width in pixels
+    uint32_t height;                ///< Video height in pixels
+    uint32_t reserved[4];           ///< Reserved fields
+};
+
+/**
+ * @brief Stream header structure (strh chunk)
+ *
+ * Contains information about individual streams (video/audio).
+ */
+struct AVIStreamHeader {
+    char fccType[4];                ///< Stream type ('vids', 'auds', etc.)
+    char fccHandler[4];             ///< Codec handler
+    uint32_t flags;                 ///< Stream flags
+    uint16_t priority;              ///< Stream priority
+    uint16_t language;              ///< Language code
+    uint32_t initialFrames;         ///< Initial frames
+    uint32_t scale;                 ///< Time scale
+    uint32_t rate;                  ///< Rate (rate/scale = samples/second)
+    uint32_t start;                 ///< Start time
+    uint32_t length;                ///< Stream length
+    uint32_t suggestedBufferSize;   ///< Suggested buffer size
+    uint32_t quality;               ///< Quality indicator
+    uint32_t sampleSize;            ///< Sample size
+    struct {
+        int16_t left;               ///< Left coordinate
+        int16_t top;                ///< Top coordinate
+        int16_t right;              ///< Right coordinate
+        int16_t bottom;             ///< Bottom coordinate
+    } frame;                        ///< Frame rectangle
+};
+
+/**
+ * @brief Bitmap info header structure (strf chunk for video)
+ *
+ * Contains detailed information about the video format.
+ */
+struct BitmapInfoHeader {
+    uint32_t size;                  ///< Header size
+    int32_t width;                  ///< Image width
+    int32_t height;                 ///< Image height (negative = top-down)
+    uint16_t planes;                ///< Number of color planes
+    uint16_t bitCount;              ///< Bits per pixel
+    uint32_t compression;           ///< Compression type
+    uint32_t sizeImage;             ///< Image size in bytes
+    int32_t xPelsPerMeter;          ///< Horizontal resolution
+    int32_t yPelsPerMeter;          ///< Vertical resolution
+    uint32_t clrUsed;               ///< Colors used
+    uint32_t clrImportant;          ///< Important colors
+};
+
+/**
+ * @brief Color masks of BI_BITFIELDS bitmaps
+ *
+ * Follow the 40-byte bitmap info header, or are its next fields in the
+ * larger V4 and V5 headers. The alpha mask is only present in those
+ * headers and with BI_ALPHABITFIELDS.
+ */
+struct BitmapColorMasks {
+    uint32_t red;                   ///< Bits of the red channel
+    uint32_t green;                 ///< Bits of the green channel
+    uint32_t blue;                  ///< Bits of the blue channel
+    uint32_t alpha;                 ///< Bits of the alpha channel, 0 if none
+};
+
+/**
+ * @brief Waveform audio format structure (strf chunk for audio)
+ *
+ * WAVEFORMATEX without the trailing extra bytes. Describes PCM and IEEE
+ * float audio streams.
+ */
+struct WaveFormatEx {
+    uint16_t formatTag;             ///< Format type (1 = PCM, 3 = IEEE float)
+    uint16_t channels;              ///< Number of channels
+    uint32_t samplesPerSec;         ///< Sample rate in Hz
+    uint32_t avgBytesPerSec;        ///< Average data rate
+    uint16_t blockAlign;            ///< Bytes per sample frame (all channels)
+    uint16_t bitsPerSample;         ///< Bits per sample of one channel
+};
+
+/**
+ * @brief RGB color quad for palette entries
+ *
+ * Used for 8-bit indexed color palettes.
+ */
+struct RGBQuad {
+    uint8_t blue;                   ///< Blue component
+    uint8_t green;                  ///< Green component
+    uint8_t red;                    ///< Red component
+    uint8_t reserved;               ///< Reserved (usually 0)
+};
+
+/**
+ * @brief Legacy index entry (idx1 chunk)
+ *
+ * One entry per chunk of the movie list, in file order.
+ */
+struct AVIIndexEntry {
+    char chunkId[4];                ///< Four-character code of the chunk
+    uint32_t flags;                 ///< AVIIF_* flags (keyframe, list)
+    uint32_t offset;                ///< Chunk position, relative to the movie list or absolute
+    uint32_t size;                  ///< Chunk data size
+};
+
+/**
+ * @brief OpenDML super index header (indx chunk)
+ *
+ * Stored in the stream list; followed by one AVISuperIndexEntry per
+ * standard index of the stream. Lets files grow past the 4 GB limit of a
+ * single RIFF list.
+ */
+struct AVISuperIndexHeader {
+    uint16_t longsPerEntry;         ///< Entry size in 4-byte units (4)
+    uint8_t indexSubType;           ///< Always 0
+    uint8_t indexType;              ///< AVI_INDEX_OF_INDEXES (0)
+    uint32_t entriesInUse;          ///< Number of valid entries
+    char chunkId[4];                ///< Chunk ID of the indexed stream, e.g. "00dc"
+    uint32_t reserved[3];           ///< Reserved, zero
+};
+
+/**
+ * @brief OpenDML super index entry
+ */
+struct AVISuperIndexEntry {
+    uint64_t offset;                ///< File offset of the ix## chunk header
+    uint32_t size;                  ///< Size of the ix## chunk including its header
+    uint32_t duration;              ///< Stream length covered, in strh units
+};
+
+/**
+ * @brief OpenDML standard index header (ix## chunk)
+ *
+ * Followed by one AVIStandardIndexEntry per chunk of one RIFF list.
+ */
+struct AVIStandardIndexHeader {
+    uint16_t longsPerEntry;         ///< Entry size in 4-byte units (2)
+    uint8_t indexSubType;           ///< Always 0
+    uint8_t indexType;              ///< AVI_INDEX_OF_CHUNKS (1)
+    uint32_t entriesInUse;          ///< Number of valid entries
+    char chunkId[4];                ///< Chunk ID of the indexed stream
+    uint64_t baseOffset;            ///< Base of the entry offsets
+    uint32_t reserved;              ///< Reserved, zero
+};
+
+/**
+ * @brief OpenDML standard index entry
+ */
+struct AVIStandardIndexEntry {
+    uint32_t offset;                ///< Chunk payload position, relative to the base offset
+    uint32_t size;                  ///< Payload size; bit 31 marks a non-key frame
+};
+
+/**
+ * @brief OpenDML extended header (dmlh chunk of the odml list)
+ */
+struct AVIExtendedHeader {
+    uint32_t totalFrames;           ///< Frames of the whole file, across all RIFF lists
+    uint32_t reserved[61];          ///< Reserved, zero
+};
+#pragma pack(pop)
+
+/**
+ * @brief Chunk header structure
+ *
+ * Generic chunk header used throughout AVI files.
+ */
+struct ChunkHeader {
+    char fourCC[4];                 ///< Four-character code
+    uint32_t size;                  ///< Chunk data size
+};
+
+#endif // AVI_FORMAT_H
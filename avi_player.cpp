@@ -7,12 +7,28 @@
  */
 
 #include "avi_player.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+    /**
+     * @brief Playback rates selectable with the UP and DOWN keys
+     */
+    const double kPlaybackRates[] = { 0.1, 0.25, 0.5, 1.0, 1.5, 2.0, 4.0, 8.0, 16.0, 32.0 };
+    const int kPlaybackRateCount = sizeof(kPlaybackRates) / sizeof(kPlaybackRates[0]);
+}
 
 AVIPlayer::AVIPlayer() 
-    : window(nullptr), renderer(nullptr), texture(nullptr), 
-      frameWidth(0), frameHeight(0), fps(0), totalFrames(0), 
-      currentFrame(0), bitsPerPixel(0), bytesPerPixel(0), isTopDown(false),
-      sdlPixelFormat(SDL_PIXELFORMAT_UNKNOWN), isValid(false) {
+    : window(nullptr), renderer(nullptr), convertYUV(false), tenBitTextures(false), scaleOnCPU(false), fullscreen(false),
+      dirtyRegions(false), textureCount(2), vsync(false), comparedPixels(0), changedPixels(0),
+      decodeThreads(0), reader(new AVIReader()), cacheBudget(0),
+      frameWidth(0), frameHeight(0), fps(0), microSecPerFrame(0), frameSeconds(0), totalFrames(0), 
+      currentFrame(0), shownFrame(0), isValid(false),
+      paused(false), looping(false), reverse(false), playbackRate(1.0), needsRedraw(false), loopStart(0), loopEnd(0),
+      audioEnabled(true), audioResync(false),
+      nextItem(0), retiredBytesRead(0), retiredReadCount(0) {
 }
 
 AVIPlayer::~AVIPlayer() {
@@ -20,105 +36,411 @@ AVIPlayer::~AVIPlayer() {
 }
 
 bool AVIPlayer::loadAVI(const std::string& filepath) {
-    file.open(filepath, std::ios::binary);
-    if (!file.is_open()) {
-        std::cerr << "Error: Cannot open file " << filepath << std::endl;
+    Clip clip;
+    if (!openClip(filepath, clip, frameStep()) || !activateClip(clip)) {
         return false;
     }
+    currentFrame = reverse ? static_cast<int64_t>(totalFrames) - 1 : 0;
     
-    // Read RIFF header
-    RIFFHeader riffHeader;
-    file.read(reinterpret_cast<char*>(&riffHeader), sizeof(RIFFHeader));
-    
-    if (strncmp(riffHeader.signature, "RIFF", 4) != 0 || 
-        strncmp(riffHeader.format, "AVI ", 4) != 0) {
-        std::cerr << "Error: Not a valid AVI file" << std::endl;
-        return false;
+    const VideoTrack& primary = *tracks[0];
+    std::cout << "AVI Info:" << std::endl;
+    std::cout << "  Resolution: " << frameWidth << "x" << frameHeight << std::endl;
+    if (tracks.size() > 1) {
+        std::cout << "  Video Streams: " << tracks.size() << std::endl;
     }
+    std::cout << "  FPS: " << fps << std::endl;
+    std::cout << "  Total Frames: " << totalFrames << std::endl;
+    std::cout << "  Bits Per Pixel: " << primary.converter.getBitsPerPixel() << std::endl;
+    std::cout << "  Compression: " << reader->getStream(primary.stream).bitmapHeader.compression << std::endl;
+    std::cout << "  Duration: " << (totalFrames / (float)fps) << " seconds" << std::endl;
     
-    // Parse AVI chunks
-    if (!parseAVIChunks()) {
-        std::cerr << "Error: Failed to parse AVI structure" << std::endl;
+    isValid = true;
+    return true;
+}
+
+bool AVIPlayer::openClip(const std::string& filepath, Clip& clip, int stride) const {
+    // Open, parse and index the file
+    clip.reader.reset(new AVIReader());
+    if (!clip.reader->open(filepath)) {
         return false;
     }
     
+    const AVIMainHeader& mainHeader = clip.reader->getMainHeader();
+    
     // Calculate FPS
     if (mainHeader.microSecPerFrame > 0) {
-        fps = 1000000 / mainHeader.microSecPerFrame;
+        clip.fps = 1000000 / mainHeader.microSecPerFrame;
+        clip.microSecPerFrame = mainHeader.microSecPerFrame;
     } else {
-        fps = 30; // Default fallback
+        clip.fps = 30; // Default fallback
+        clip.microSecPerFrame = 1000000 / clip.fps;
     }
+    if (clip.fps == 0) clip.fps = 1;
     
-    frameWidth = mainHeader.width;
-    frameHeight = mainHeader.height;
-    totalFrames = mainHeader.totalFrames;
-    
-    // Handle negative height (indicates top-down bitmap)
-    if (bitmapHeader.height < 0) {
-        isTopDown = true;
-        bitmapHeader.height = -bitmapHeader.height;
-        frameHeight = bitmapHeader.height;
-        std::cout << "  Image orientation: Top-down" << std::endl;
+    // The stream rate is exact where avih rounds to whole microseconds,
+    // which matters when mapping the audio clock to frames
+    const AVIStreamHeader& streamHeader = clip.reader->getStreamHeader();
+    if (streamHeader.rate > 0 && streamHeader.scale > 0) {
+        clip.frameSeconds = static_cast<double>(streamHeader.scale) / streamHeader.rate;
     } else {
-        isTopDown = false;
-        std::cout << "  Image orientation: Bottom-up" << std::endl;
+        clip.frameSeconds = clip.microSecPerFrame / 1e6;
+    }
+    
+    // Resolve the stream selection: the primary stream by default
+    std::vector<int> streams = requestedStreams;
+    if (streams.empty()) {
+        streams.push_back(clip.reader->getVideoStream());
+    } else if (std::find(streams.begin(), streams.end(), -1) != streams.end()) {
+        streams = clip.reader->getVideoStreams();
+    }
+    
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (!addTrack(clip, streams[i], stride)) {
+            return false;
+        }
+    }
+    
+    clip.ready = true;
+    return true;
+}
+
+bool AVIPlayer::addTrack(Clip& clip, int streamNumber, int stride) const {
+    const AVIStream& stream = clip.reader->getStream(streamNumber);
+    if (!stream.isVideo() || stream.chunkOffsets.empty()) {
+        std::cerr << "Error: Stream " << streamNumber << " is not a video stream" << std::endl;
+        return false;
     }
     
+    std::unique_ptr<VideoTrack> track(new VideoTrack());
+    track->stream = streamNumber;
+    
     // Determine pixel format from bitmap header
-    if (!determinePixelFormat()) {
+    if (!track->converter.configure(stream.bitmapHeader, stream.palette, stream.colorMasks)) {
         std::cerr << "Error: Unsupported pixel format" << std::endl;
         return false;
     }
+    track->converter.setRGBOutput(convertYUV);
+    track->converter.setTenBitOutput(tenBitTextures);
+    
+    // Place the stream to the right of the ones before it
+    track->area.x = static_cast<int>(clip.frameWidth);
+    track->area.y = 0;
+    track->area.w = static_cast<int>(track->converter.getWidth());
+    track->area.h = static_cast<int>(track->converter.getHeight());
+    track->target = track->area;
+    clip.frameWidth += track->converter.getWidth();
+    clip.frameHeight = std::max(clip.frameHeight, track->converter.getHeight());
+    clip.totalFrames = std::max(clip.totalFrames, stream.getChunkCount());
+    
+    // Prefetch blocks of at least a few frames with large sequential reads
+    size_t blockBytes = static_cast<size_t>(stream.maxChunkSize) * 4;
+    if (blockBytes < (32u << 20)) blockBytes = 32u << 20;
+    track->readAhead.reset(new ReadAheadWindow(*clip.reader, streamNumber, blockBytes));
+    track->readAhead->setStride(stride);
+    if (track->converter.isRunLength()) {
+        track->decoder.reset(new RLEDecoder(*clip.reader, streamNumber, track->converter));
+    }
+    if (track->converter.isMotionJPEG()) {
+        track->jpegDecoder.reset(new MJPEGDecoder(*clip.reader, streamNumber, track->converter));
+        track->jpegDecoder->setStride(stride);
+    }
     
-    std::cout << "AVI Info:" << std::endl;
-    std::cout << "  Resolution: " << frameWidth << "x" << frameHeight << std::endl;
-    std::cout << "  FPS: " << fps << std::endl;
-    std::cout << "  Total Frames: " << totalFrames << std::endl;
-    std::cout << "  Bits Per Pixel: " << bitsPerPixel << std::endl;
-    std::cout << "  Compression: " << bitmapHeader.compression << std::endl;
-    std::cout << "  Duration: " << (totalFrames / (float)fps) << " seconds" << std::endl;
-    
-    isValid = true;
+    clip.tracks.push_back(std::move(track));
     return true;
 }
 
+bool AVIPlayer::activateClip(Clip& clip) {
+    std::unique_ptr<Clip> previous(new Clip());
+    previous->reader = std::move(reader);
+    previous->tracks.swap(tracks);
+    for (size_t i = 0; i < previous->tracks.size(); ++i) {
+        retiredBytesRead += previous->tracks[i]->readAhead->getBytesRead();
+        retiredReadCount += previous->tracks[i]->readAhead->getReadCount();
+    }
+    
+    // The audio device reads through the previous reader
+    audio.reset();
+    
+    reader = std::move(clip.reader);
+    tracks.swap(clip.tracks);
+    // Speed or direction may have changed while the clip was preloaded
+    updateStrides();
+    bool resized = clip.frameWidth != frameWidth || clip.frameHeight != frameHeight;
+    frameWidth = clip.frameWidth;
+    frameHeight = clip.frameHeight;
+    fps = clip.fps;
+    microSecPerFrame = clip.microSecPerFrame;
+    frameSeconds = clip.frameSeconds;
+    totalFrames = clip.totalFrames;
+    
+    // Only indexed frames can be displayed or seeked to
+    loopStart = 0;
+    loopEnd = totalFrames;
+    setCacheBudget(cacheBudget);
+    
+    bool success = true;
+    if (renderer) {
+        if (resized) {
+            int windowWidth = static_cast<int>(frameWidth);
+            int windowHeight = static_cast<int>(frameHeight);
+            fitToDisplay(windowWidth, windowHeight);
+            SDL_SetWindowSize(window, windowWidth, windowHeight);
+        }
+        layoutTracks();
+        
+        // Keep the textures of streams whose format and size did not change
+        for (size_t i = 0; i < tracks.size() && i < previous->tracks.size(); ++i) {
+            VideoTrack& track = *tracks[i];
+            VideoTrack& old = *previous->tracks[i];
+            if (old.converter.getPixelFormat() == track.converter.getPixelFormat() &&
+                old.converter.getOutputWidth() == track.converter.getOutputWidth() &&
+                old.converter.getOutputHeight() == track.converter.getOutputHeight()) {
+                track.textures.swap(old.textures);
+                track.texture = old.texture;
+                old.texture = nullptr;
+            }
+        }
+        for (size_t i = 0; i < previous->tracks.size(); ++i) {
+            destroyTextures(*previous->tracks[i]);
+        }
+        success = createTextures();
+    }
+    
+    // Joining the old read-ahead threads could stall playback, so the
+    // preload thread releases the previous clip
+    retiredClip = std::move(previous);
+    return success;
+}
+
 bool AVIPlayer::initSDL() {
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
         std::cerr << "SDL Init Error: " << SDL_GetError() << std::endl;
         return false;
     }
     
+    // Videos larger than the screen open shrunk to fit it
+    int windowWidth = static_cast<int>(frameWidth);
+    int windowHeight = static_cast<int>(frameHeight);
+    fitToDisplay(windowWidth, windowHeight);
+    Uint32 windowFlags = SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE;
+    if (fullscreen) windowFlags |= SDL_WINDOW_FULLSCREEN_DESKTOP;
     window = SDL_CreateWindow("AVI Player",
                             SDL_WINDOWPOS_CENTERED,
                             SDL_WINDOWPOS_CENTERED,
-                            frameWidth, frameHeight,
-                            SDL_WINDOW_SHOWN);
+                            windowWidth, windowHeight,
+                            windowFlags);
     
     if (!window) {
         std::cerr << "Window Creation Error: " << SDL_GetError() << std::endl;
         return false;
     }
     
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    Uint32 presentFlags = vsync ? SDL_RENDERER_PRESENTVSYNC : 0;
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED | presentFlags);
+    if (!renderer) {
+        std::cerr << "Warning: No accelerated renderer (" << SDL_GetError() << "), using software rendering" << std::endl;
+        renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_SOFTWARE | presentFlags);
+    }
     if (!renderer) {
         std::cerr << "Renderer Creation Error: " << SDL_GetError() << std::endl;
         return false;
     }
     
-    // Create texture with the determined pixel format
-    texture = SDL_CreateTexture(renderer,
-                              sdlPixelFormat,
-                              SDL_TEXTUREACCESS_STREAMING,
-                              frameWidth, frameHeight);
+    // The software renderer would convert YUV textures on every upload;
+    // converting once, into the frame cache, with SIMD is cheaper
+    SDL_RendererInfo info;
+    bool hasInfo = SDL_GetRendererInfo(renderer, &info) == 0;
+    if (hasInfo && (info.flags & SDL_RENDERER_SOFTWARE)) {
+        convertYUV = true;
+        // Shrinking during conversion uploads and blits only the pixels
+        // shown, and filters better than the renderer's scaling
+        scaleOnCPU = true;
+        std::cout << "Software renderer: scaling to the window during conversion ("
+                  << Resampler::getImplementation() << ")" << std::endl;
+        // Its textures are plain memory that no GPU reads behind our back
+        textureCount = 1;
+        bool hasYUV = false;
+        for (size_t i = 0; i < tracks.size(); ++i) {
+            tracks[i]->converter.setRGBOutput(true);
+            hasYUV = hasYUV || tracks[i]->converter.getYUVLayout() != FrameConverter::YUV_NONE;
+        }
+        if (hasYUV) {
+            std::cout << "Software renderer: converting YUV on the CPU (" << yuvConvertImplementation() << ")" << std::endl;
+        }
+    }
     
-    if (!texture) {
+    // High-bit-depth streams keep 10 bits where the renderer can show them
+    for (uint32_t i = 0; hasInfo && i < info.num_texture_formats; ++i) {
+        tenBitTextures = tenBitTextures || info.texture_formats[i] == SDL_PIXELFORMAT_ARGB2101010;
+    }
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        tracks[i]->converter.setTenBitOutput(tenBitTextures);
+    }
+    
+    // Accelerated renderers scale the textures with bilinear filtering
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
+    
+    // Create the textures of every stream with the determined pixel format
+    layoutTracks();
+    if (!createTextures()) {
+        return false;
+    }
+    
+    openAudio();
+    
+    return true;
+}
+
+bool AVIPlayer::createTextures() {
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        VideoTrack& track = *tracks[i];
+        if (track.converter.isHighDepth()) {
+            // Large frames are unpacked in bands on all cores
+            if (!bandPool) {
+                bandPool.reset(new ThreadPool());
+                std::cout << "High bit depth: " << deepConvertImplementation() << " kernels, "
+                          << bandPool->getThreadCount() << " band worker(s)" << std::endl;
+            }
+            track.converter.setThreadPool(bandPool.get());
+        }
+        if (track.jpegDecoder) {
+            // Two frames per worker keep every core busy while the
+            // completed ones wait for their turn
+            if (!decodePool) {
+                decodePool.reset(new ThreadPool(decodeThreads));
+                std::cout << "MJPG: " << decodePool->getThreadCount() << " decoding thread(s)" << std::endl;
+            }
+            track.jpegDecoder->startPipeline(*decodePool, *track.readAhead, decodePool->getThreadCount() * 2);
+        }
+        if (track.textures.empty() && !createTexture(track)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool AVIPlayer::createTexture(VideoTrack& track) {
+    track.texture = SDL_CreateTexture(renderer,
+                                      track.converter.getPixelFormat(),
+                                      SDL_TEXTUREACCESS_STREAMING,
+                                      track.converter.getOutputWidth(), track.converter.getOutputHeight());
+    
+    if (!track.texture && track.converter.isPassThrough()) {
+        std::cerr << "Warning: No YUV texture (" << SDL_GetError() << "), converting on the CPU" << std::endl;
+        track.converter.setRGBOutput(true);
+        track.texture = SDL_CreateTexture(renderer,
+                                          track.converter.getPixelFormat(),
+                                          SDL_TEXTUREACCESS_STREAMING,
+                                          track.converter.getOutputWidth(), track.converter.getOutputHeight());
+    }
+    
+    if (!track.texture && track.converter.getPixelFormat() == SDL_PIXELFORMAT_ARGB2101010) {
+        std::cerr << "Warning: No 10-bit texture (" << SDL_GetError() << "), dithering to 8 bits" << std::endl;
+        track.converter.setTenBitOutput(false);
+        track.texture = SDL_CreateTexture(renderer,
+                                          track.converter.getPixelFormat(),
+                                          SDL_TEXTUREACCESS_STREAMING,
+                                          track.converter.getOutputWidth(), track.converter.getOutputHeight());
+    }
+    
+    if (!track.texture) {
         std::cerr << "Texture Creation Error: " << SDL_GetError() << std::endl;
         return false;
     }
     
+    // The rest of the ring takes the format settled on
+    track.textures.push_back(track.texture);
+    while (track.textures.size() < textureCount) {
+        SDL_Texture* texture = SDL_CreateTexture(renderer,
+                                                 track.converter.getPixelFormat(),
+                                                 SDL_TEXTUREACCESS_STREAMING,
+                                                 track.converter.getOutputWidth(), track.converter.getOutputHeight());
+        if (!texture) {
+            std::cerr << "Warning: Only " << track.textures.size() << " streaming texture(s) ("
+                      << SDL_GetError() << ")" << std::endl;
+            break;
+        }
+        track.textures.push_back(texture);
+    }
+    track.nextTexture = 0;
+    track.referenceValid = false;
     return true;
 }
 
+bool AVIPlayer::layoutTracks() {
+    int outputWidth = 0;
+    int outputHeight = 0;
+    if (SDL_GetRendererOutputSize(renderer, &outputWidth, &outputHeight) != 0 ||
+        outputWidth <= 0 || outputHeight <= 0) {
+        outputWidth = static_cast<int>(frameWidth);
+        outputHeight = static_cast<int>(frameHeight);
+    }
+    
+    // The largest size with the frame's aspect ratio; the rest of the
+    // window is left black
+    double scale = std::min(static_cast<double>(outputWidth) / frameWidth,
+                            static_cast<double>(outputHeight) / frameHeight);
+    int left = (outputWidth - static_cast<int>(std::floor(frameWidth * scale))) / 2;
+    int top = (outputHeight - static_cast<int>(std::floor(frameHeight * scale))) / 2;
+    
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        VideoTrack& track = *tracks[i];
+        // Edges are scaled rather than sizes, so neighbors still touch
+        const SDL_Rect& area = track.area;
+        int x0 = left + static_cast<int>(std::floor(area.x * scale));
+        int y0 = top + static_cast<int>(std::floor(area.y * scale));
+        int x1 = left + static_cast<int>(std::floor((area.x + area.w) * scale));
+        int y1 = top + static_cast<int>(std::floor((area.y + area.h) * scale));
+        track.target.x = x0;
+        track.target.y = y0;
+        track.target.w = std::max(x1 - x0, 1);
+        track.target.h = std::max(y1 - y0, 1);
+        if (!scaleOnCPU) continue;
+        
+        bool wasScaled = track.converter.isScaled();
+        uint32_t oldWidth = track.converter.getOutputWidth();
+        uint32_t oldHeight = track.converter.getOutputHeight();
+        track.converter.setOutputSize(static_cast<uint32_t>(track.target.w), static_cast<uint32_t>(track.target.h));
+        if (track.textures.empty() || (track.converter.isScaled() == wasScaled &&
+                               track.converter.getOutputWidth() == oldWidth &&
+                               track.converter.getOutputHeight() == oldHeight)) {
+            continue;
+        }
+        
+        // Frames converted for the previous size are of no use
+        track.cache.clear();
+        destroyTextures(track);
+        if (!createTexture(track)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void AVIPlayer::fitToDisplay(int& width, int& height) const {
+    SDL_Rect bounds;
+    int display = window ? SDL_GetWindowDisplayIndex(window) : 0;
+    if (display < 0 || SDL_GetDisplayUsableBounds(display, &bounds) != 0 || width <= 0 || height <= 0) {
+        return;
+    }
+    if (width > bounds.w || height > bounds.h) {
+        double scale = std::min(static_cast<double>(bounds.w) / width, static_cast<double>(bounds.h) / height);
+        width = std::max(static_cast<int>(width * scale), 1);
+        height = std::max(static_cast<int>(height * scale), 1);
+    }
+}
+
+void AVIPlayer::openAudio() {
+    // Audio is optional: without a device the video plays on its own clock
+    if (audioEnabled && reader->hasAudio()) {
+        audio.reset(new AudioOutput(*reader));
+        if (!audio->open()) {
+            std::cerr << "Warning: Playing without audio" << std::endl;
+            audio.reset();
+        }
+    }
+}
+
 void AVIPlayer::play() {
     if (!isValid) {
         std::cerr << "Error: AVI file not loaded or invalid" << std::endl;
@@ -126,318 +448,518 @@ void AVIPlayer::play() {
     }
     
     bool quit = false;
+    bool completed = false;
     SDL_Event e;
     
-    auto frameTime = std::chrono::milliseconds(1000 / fps);
-    auto lastFrameTime = std::chrono::steady_clock::now();
+    auto nextFrameTime = std::chrono::steady_clock::now();
     
     std::cout << "Playing AVI... Press ESC or close window to exit." << std::endl;
     
-    while (!quit && currentFrame < totalFrames) {
+    nextItem = 1;
+    startPreload();
+    
+    while (!quit) {
         while (SDL_PollEvent(&e)) {
             if (e.type == SDL_QUIT || 
                 (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE)) {
                 quit = true;
+            } else if (e.type == SDL_KEYDOWN) {
+                handleKey(e.key.keysym.sym);
+            } else if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+                if (!layoutTracks()) {
+                    quit = true;
+                } else if (paused) {
+                    // Playback redraws on the next tick anyway
+                    renderFrame(shownFrame);
+                }
             }
         }
         
         auto currentTime = std::chrono::steady_clock::now();
-        if (currentTime - lastFrameTime >= frameTime) {
-            renderFrame(currentFrame);
-            currentFrame++;
-            lastFrameTime = currentTime;
+        if (paused) {
+            // Resume from now rather than catching up on the pause
+            nextFrameTime = currentTime;
         }
         
-        // Small delay to prevent excessive CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-    }
-    
-    if (currentFrame >= totalFrames) {
-        std::cout << "Playback completed!" << std::endl;
-        // Wait for user to close window
-        while (!quit) {
-            while (SDL_PollEvent(&e)) {
-                if (e.type == SDL_QUIT || 
-                    (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE)) {
-                    quit = true;
+        syncAudio();
+        
+        bool due = false;
+        if (audioDrivesClock()) {
+            // Follow the audio clock; frames it has passed are dropped
+            // so video never drifts behind the sound
+            int64_t audioFrame = static_cast<int64_t>(audio->getClock() / frameSeconds);
+            due = audioFrame >= currentFrame;
+            if (due) {
+                if (!needsRedraw) currentFrame = audioFrame;
+                nextFrameTime = currentTime + frameInterval();
+            }
+        } else if (!paused && currentTime >= nextFrameTime) {
+            // When running late, skip whole display ticks instead of
+            // falling behind; skipped frames are never read
+            due = true;
+            std::chrono::nanoseconds interval = frameInterval();
+            int64_t lateTicks = (currentTime - nextFrameTime) / interval;
+            if (!needsRedraw) {
+                currentFrame += lateTicks * frameStep();
+            }
+            nextFrameTime += interval * (lateTicks + 1);
+        }
+        
+        if (due || needsRedraw) {
+            // Wrap around at the ends of the loop section; a playlist
+            // loops as a whole instead
+            if (looping && playlist.size() <= 1 && (currentFrame >= loopEnd || currentFrame < loopStart)) {
+                currentFrame = reverse ? loopEnd - 1 : loopStart;
+                audioResync = true;
+                syncAudio();
+            }
+            
+            // Show the first frame of the next file on the tick that
+            // follows the last frame of this one
+            bool switched = false;
+            if (!reverse && !needsRedraw && currentFrame >= totalFrames && advancePlaylist()) {
+                currentFrame = 0;
+                switched = true;
+            }
+            
+            if (currentFrame >= 0 && currentFrame < totalFrames) {
+                renderFrame(static_cast<uint32_t>(currentFrame));
+                shownFrame = static_cast<uint32_t>(currentFrame);
+                currentFrame += frameStep();
+                completed = false;
+                
+                if (switched) {
+                    // Opened after the first frame is up so it cannot delay it
+                    openAudio();
+                    audioResync = true;
+                    syncAudio();
                 }
+            } else if (!completed) {
+                std::cout << "Playback completed!" << std::endl;
+                completed = true;
+                paused = true;
             }
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            needsRedraw = false;
         }
+        
+        // Small delay to prevent excessive CPU usage
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
-}
-
-bool AVIPlayer::determinePixelFormat() {
-    bitsPerPixel = bitmapHeader.bitCount;
-    bytesPerPixel = (bitsPerPixel + 7) / 8;
     
-    // Only support uncompressed formats
-    if (bitmapHeader.compression != 0) {
-        std::cerr << "Error: Compressed formats not supported (compression = " 
-                  << bitmapHeader.compression << ")" << std::endl;
-        return false;
+    uint64_t bytesRead = retiredBytesRead, readCount = retiredReadCount;
+    uint64_t hits = 0, misses = 0, entries = 0, usedBytes = 0;
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        const VideoTrack& track = *tracks[i];
+        bytesRead += track.readAhead->getBytesRead();
+        readCount += track.readAhead->getReadCount();
+        hits += track.cache.getHits();
+        misses += track.cache.getMisses();
+        entries += track.cache.getEntryCount();
+        usedBytes += track.cache.getUsedBytes();
     }
-    
-    switch (bitsPerPixel) {
-        case 8:
-            // 8-bit indexed color
-            sdlPixelFormat = SDL_PIXELFORMAT_RGB24; // We'll convert to RGB24
-            std::cout << "  Format: 8-bit indexed color" << std::endl;
-            break;
-        case 16:
-            // 16-bit RGB (usually RGB565)
-            sdlPixelFormat = SDL_PIXELFORMAT_RGB565;
-            std::cout << "  Format: 16-bit RGB565" << std::endl;
-            break;
-        case 24:
-            // 24-bit RGB (stored as BGR in AVI)
-            sdlPixelFormat = SDL_PIXELFORMAT_RGB24;
-            std::cout << "  Format: 24-bit RGB" << std::endl;
-            break;
-        case 32:
-            // 32-bit RGBA (stored as BGRA in AVI)
-            sdlPixelFormat = SDL_PIXELFORMAT_RGBA32;
-            std::cout << "  Format: 32-bit RGBA" << std::endl;
-            break;
-        default:
-            std::cerr << "Error: Unsupported bit depth: " << bitsPerPixel << std::endl;
-            return false;
+    std::cout << "Read " << (bytesRead >> 20) << " MB in " << readCount << " reads" << std::endl;
+    if (cacheBudget > 0) {
+        std::cout << "Frame cache: " << hits << " hits, "
+                  << misses << " misses, "
+                  << entries << " frames ("
+                  << (usedBytes >> 20) << " MB) resident" << std::endl;
+    }
+    if (dirtyRegions && comparedPixels > 0) {
+        std::cout << "Dirty regions: " << (changedPixels * 100 / comparedPixels)
+                  << "% of frame pixels uploaded" << std::endl;
+    }
+    if (audio) {
+        audio->stop();
+        std::cout << "Audio underruns: " << audio->getUnderrunCount() << std::endl;
     }
-    
-    return true;
 }
 
-bool AVIPlayer::parseAVIChunks() {
-    ChunkHeader chunk;
-    bool foundMainHeader = false;
-    
-    while (file.read(reinterpret_cast<char*>(&chunk), sizeof(ChunkHeader))) {
-        if (strncmp(chunk.fourCC, "LIST", 4) == 0) {
-            char listType[4];
-            file.read(listType, 4);
-            
-            if (strncmp(listType, "hdrl", 4) == 0) {
-                // Header list - parse headers
-                parseHeaderList(chunk.size - 4);
-                foundMainHeader = true;
-            } else if (strncmp(listType, "movi", 4) == 0) {
-                // Movie data - index frame positions
-                indexFrames(chunk.size - 4);
-                break;
-            } else {
-                // Skip other lists
-                file.seekg(chunk.size - 4, std::ios::cur);
-            }
-        } else {
-            // Skip other chunks
-            file.seekg(chunk.size, std::ios::cur);
-        }
+void AVIPlayer::setCacheBudget(size_t bytes) {
+    cacheBudget = bytes;
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        tracks[i]->cache.setBudget(bytes / tracks.size());
     }
-    
-    return foundMainHeader && !frameOffsets.empty();
 }
 
-void AVIPlayer::parseHeaderList(uint32_t size) {
-    uint32_t bytesRead = 0;
-    ChunkHeader chunk;
+void AVIPlayer::setVideoStreams(const std::vector<int>& streams) {
+    requestedStreams = streams;
+}
+
+void AVIPlayer::setLoop(bool enable) {
+    looping = enable;
+}
+
+void AVIPlayer::setReverse(bool enable) {
+    reverse = enable;
+    updateStrides();
+}
+
+void AVIPlayer::setPlaybackRate(double rate) {
+    if (rate < 0.1) rate = 0.1;
+    if (rate > 32.0) rate = 32.0;
+    playbackRate = rate;
+    updateStrides();
+}
+
+void AVIPlayer::setAudioEnabled(bool enable) {
+    audioEnabled = enable;
+}
+
+void AVIPlayer::setPlaylist(const std::vector<std::string>& files) {
+    playlist = files;
+}
+
+void AVIPlayer::setDecodeThreads(unsigned threads) {
+    decodeThreads = threads;
+}
+
+void AVIPlayer::setFullscreen(bool enable) {
+    fullscreen = enable;
+}
+
+void AVIPlayer::setDirtyRegions(bool enable) {
+    dirtyRegions = enable;
+}
+
+void AVIPlayer::setTextureCount(unsigned count) {
+    textureCount = std::max(1u, std::min(count, 3u));
+}
+
+void AVIPlayer::setVSync(bool enable) {
+    vsync = enable;
+}
+
+void AVIPlayer::startPreload() {
+    if (playlist.size() <= 1 || preloadThread.joinable()) return;
+    if (nextItem >= playlist.size()) {
+        if (!looping) return;
+        nextItem = 0;
+    }
+    
+    nextClip.reset(new Clip());
+    Clip* clip = nextClip.get();
+    Clip* retired = retiredClip.release();
+    std::string path = playlist[nextItem];
+    int stride = frameStep();
     
-    while (bytesRead < size && file.read(reinterpret_cast<char*>(&chunk), sizeof(ChunkHeader))) {
-        bytesRead += sizeof(ChunkHeader);
+    preloadThread = std::thread([this, clip, retired, path, stride] {
+        delete retired;
+        if (!openClip(path, *clip, stride)) return;
         
-        if (strncmp(chunk.fourCC, "avih", 4) == 0) {
-            // Main AVI header
-            file.read(reinterpret_cast<char*>(&mainHeader), sizeof(AVIMainHeader));
-        } else if (strncmp(chunk.fourCC, "LIST", 4) == 0) {
-            char listType[4];
-            file.read(listType, 4);
-            bytesRead += 4;
-            
-            if (strncmp(listType, "strl", 4) == 0) {
-                // Stream list
-                parseStreamList(chunk.size - 4);
-            } else {
-                file.seekg(chunk.size - 4, std::ios::cur);
-            }
-        } else {
-            // Skip other chunks
-            file.seekg(chunk.size, std::ios::cur);
+        // Read the first block of every track now, so the first frames
+        // of the next file come from memory
+        for (size_t i = 0; i < clip->tracks.size(); ++i) {
+            clip->tracks[i]->readAhead->acquire(0);
         }
-        
-        bytesRead += chunk.size;
-    }
+    });
 }
 
-void AVIPlayer::parseStreamList(uint32_t size) {
-    uint32_t bytesRead = 0;
-    ChunkHeader chunk;
-    
-    while (bytesRead < size && file.read(reinterpret_cast<char*>(&chunk), sizeof(ChunkHeader))) {
-        bytesRead += sizeof(ChunkHeader);
+bool AVIPlayer::advancePlaylist() {
+    // Bounded so that a playlist of unreadable files cannot spin forever
+    for (size_t attempt = 0; attempt < playlist.size(); ++attempt) {
+        if (!preloadThread.joinable()) {
+            // Looping may have been switched on after the last file started
+            startPreload();
+            if (!preloadThread.joinable()) return false;
+        }
+        preloadThread.join();
         
-        if (strncmp(chunk.fourCC, "strh", 4) == 0) {
-            // Stream header
-            file.read(reinterpret_cast<char*>(&streamHeader), sizeof(AVIStreamHeader));
-        } else if (strncmp(chunk.fourCC, "strf", 4) == 0) {
-            // Stream format (bitmap info for video)
-            if (strncmp(streamHeader.fccType, "vids", 4) == 0) {
-                file.read(reinterpret_cast<char*>(&bitmapHeader), sizeof(BitmapInfoHeader));
-                
-                // Read palette if present (for 8-bit indexed color)
-                uint32_t remainingBytes = chunk.size - sizeof(BitmapInfoHeader);
-                if (remainingBytes > 0 && bitmapHeader.bitCount == 8) {
-                    uint32_t paletteEntries = remainingBytes / sizeof(RGBQuad);
-                    palette.resize(paletteEntries);
-                    file.read(reinterpret_cast<char*>(palette.data()), remainingBytes);
-                    std::cout << "  Read palette with " << paletteEntries << " entries" << std::endl;
-                } else if (remainingBytes > 0) {
-                    // Skip remaining bytes if not palette data
-                    file.seekg(remainingBytes, std::ios::cur);
-                }
-            } else {
-                file.seekg(chunk.size, std::ios::cur);
-            }
-        } else {
-            file.seekg(chunk.size, std::ios::cur);
+        std::unique_ptr<Clip> clip(std::move(nextClip));
+        const std::string& path = playlist[nextItem++];
+        if (!clip->ready) {
+            std::cerr << "Skipping " << path << std::endl;
+            startPreload();
+            continue;
+        }
+        if (!activateClip(*clip)) {
+            return false;
         }
         
-        bytesRead += chunk.size;
+        std::cout << "Now playing: " << path << std::endl;
+        startPreload();
+        return true;
     }
+    return false;
 }
 
-void AVIPlayer::indexFrames(uint32_t movieSize) {
-    auto movieStart = file.tellg();
-    ChunkHeader chunk;
-    
-    while (file.tellg() < movieStart + static_cast<std::streampos>(movieSize) && 
-           file.read(reinterpret_cast<char*>(&chunk), sizeof(ChunkHeader))) {
-        
-        if (strncmp(chunk.fourCC, "00dc", 4) == 0 || // Uncompressed video
-            strncmp(chunk.fourCC, "00db", 4) == 0) { // DIB format
-            
-            frameOffsets.push_back(static_cast<uint32_t>(file.tellg()));
-            frameSizes.push_back(chunk.size);
+void AVIPlayer::updateStrides() {
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        tracks[i]->readAhead->setStride(frameStep());
+        if (tracks[i]->jpegDecoder) tracks[i]->jpegDecoder->setStride(frameStep());
+    }
+}
+
+int AVIPlayer::frameStep() const {
+    // Show every n-th frame at fast speeds; frameInterval() absorbs the remainder
+    int stride = playbackRate >= 1.0 ? static_cast<int>(std::floor(playbackRate)) : 1;
+    return reverse ? -stride : stride;
+}
+
+std::chrono::nanoseconds AVIPlayer::frameInterval() const {
+    double stride = std::abs(frameStep());
+    return std::chrono::nanoseconds(
+        static_cast<int64_t>(microSecPerFrame * 1000.0 * stride / playbackRate));
+}
+
+bool AVIPlayer::audioDrivesClock() const {
+    return audio && audio->isRunning() && !audio->isDrained();
+}
+
+void AVIPlayer::syncAudio() {
+    if (!audio) return;
+    
+    // Audio only plays forward at normal speed
+    bool wanted = !paused && !reverse && playbackRate == 1.0 &&
+                  currentFrame >= 0 && currentFrame < totalFrames;
+    if (wanted && (audioResync || !audio->isRunning())) {
+        audio->start(currentFrame * frameSeconds);
+    } else if (!wanted && audio->isRunning()) {
+        audio->stop();
+    }
+    audioResync = false;
+}
+
+void AVIPlayer::handleKey(SDL_Keycode key) {
+    switch (key) {
+        case SDLK_SPACE:
+            paused = !paused;
+            break;
+        case SDLK_LEFT:
+            seekTo(static_cast<int64_t>(shownFrame) - fps);
+            break;
+        case SDLK_RIGHT:
+            seekTo(static_cast<int64_t>(shownFrame) + fps);
+            break;
+        case SDLK_COMMA:
+            paused = true;
+            seekTo(static_cast<int64_t>(shownFrame) - 1);
+            break;
+        case SDLK_PERIOD:
+            paused = true;
+            seekTo(static_cast<int64_t>(shownFrame) + 1);
+            break;
+        case SDLK_HOME:
+            seekTo(looping ? loopStart : 0);
+            break;
+        case SDLK_r:
+            // Continue from the frame on screen in the new direction
+            setReverse(!reverse);
+            seekTo(static_cast<int64_t>(shownFrame) + frameStep());
+            std::cout << (reverse ? "Reverse" : "Forward") << " playback" << std::endl;
+            break;
+        case SDLK_UP:
+        case SDLK_DOWN: {
+            // Step to the next faster or slower preset
+            int preset = 0;
+            while (preset < kPlaybackRateCount - 1 && kPlaybackRates[preset] < playbackRate) preset++;
+            if (key == SDLK_UP && kPlaybackRates[preset] <= playbackRate && preset < kPlaybackRateCount - 1) preset++;
+            if (key == SDLK_DOWN && preset > 0) preset--;
+            setPlaybackRate(kPlaybackRates[preset]);
+            std::cout << "Speed: " << playbackRate << "x" << std::endl;
+            break;
         }
-        
-        // Skip chunk data (pad to even boundary)
-        uint32_t skipSize = chunk.size;
-        if (skipSize % 2 == 1) skipSize++; // AVI chunks are padded to even boundaries
-        file.seekg(skipSize, std::ios::cur);
+        case SDLK_1:
+            setPlaybackRate(1.0);
+            std::cout << "Speed: 1x" << std::endl;
+            break;
+        case SDLK_l:
+            looping = !looping;
+            std::cout << "Loop " << (looping ? "on" : "off") << std::endl;
+            break;
+        case SDLK_f:
+            // The size change that follows lays the tracks out again
+            fullscreen = !fullscreen;
+            SDL_SetWindowFullscreen(window, fullscreen ? SDL_WINDOW_FULLSCREEN_DESKTOP : 0);
+            break;
+        case SDLK_LEFTBRACKET:
+            loopStart = shownFrame;
+            if (loopEnd <= loopStart) loopEnd = totalFrames;
+            std::cout << "Loop section: " << loopStart << "-" << (loopEnd - 1) << std::endl;
+            break;
+        case SDLK_RIGHTBRACKET:
+            loopEnd = shownFrame + 1;
+            if (loopStart >= loopEnd) loopStart = 0;
+            std::cout << "Loop section: " << loopStart << "-" << (loopEnd - 1) << std::endl;
+            break;
+        default:
+            break;
     }
+}
+
+void AVIPlayer::seekTo(int64_t frameIndex) {
+    if (frameIndex < 0) frameIndex = 0;
+    if (frameIndex >= static_cast<int64_t>(totalFrames)) frameIndex = totalFrames - 1;
     
-    std::cout << "Indexed " << frameOffsets.size() << " frames" << std::endl;
+    currentFrame = frameIndex;
+    needsRedraw = true;
+    audioResync = true;
 }
 
 void AVIPlayer::renderFrame(uint32_t frameIndex) {
-    if (frameIndex >= frameOffsets.size()) return;
-    
-    file.seekg(frameOffsets[frameIndex]);
-    
-    // Read frame data
-    std::vector<uint8_t> frameData(frameSizes[frameIndex]);
-    file.read(reinterpret_cast<char*>(frameData.data()), frameSizes[frameIndex]);
-    
-    // Update texture
-    void* pixels;
-    int pitch;
-    SDL_LockTexture(texture, nullptr, &pixels, &pitch);
-    
-    convertAndCopyFrame(frameData, static_cast<uint8_t*>(pixels), pitch);
-    
-    SDL_UnlockTexture(texture);
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        updateTrack(*tracks[i], frameIndex);
+    }
     
     // Render
     SDL_RenderClear(renderer);
-    SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        SDL_RenderCopy(renderer, tracks[i]->texture, nullptr, &tracks[i]->target);
+    }
     SDL_RenderPresent(renderer);
 }
 
-void AVIPlayer::convertAndCopyFrame(const std::vector<uint8_t>& frameData, uint8_t* pixels, int pitch) {
-    switch (bitsPerPixel) {
-        case 8:
-            convert8BitToRGB24(frameData, pixels, pitch);
-            break;
-        case 16:
-            convert16BitToRGB565(frameData, pixels, pitch);
+void AVIPlayer::updateTrack(VideoTrack& track, uint32_t frameIndex) {
+    const AVIStream& stream = reader->getStream(track.stream);
+    if (frameIndex >= stream.getChunkCount()) return;
+    
+    uint32_t displayPitch = track.converter.getDisplayPitch();
+    const uint8_t* cached = track.cache.find(frameIndex);
+    
+    if (cached) {
+        // Cache hit: upload the converted frame directly
+        rotateTexture(track);
+        uploadFrame(track, cached);
+        track.referenceValid = false;
+        return;
+    }
+    
+    // Read frame data; short or empty chunks (dropped frames) keep the previous image
+    if (stream.chunkSizes[frameIndex] < track.converter.getSourceFrameSize()) return;
+    const uint8_t* frameData;
+    if (track.jpegDecoder) {
+        // MJPG frames come decoded from the pipeline, which reads them itself
+        frameData = track.jpegDecoder->decode(frameIndex, nullptr);
+    } else {
+        frameData = track.readAhead->acquire(frameIndex);
+        if (track.decoder) {
+            // RLE frames are applied to the image of the frames before them
+            frameData = track.decoder->decode(frameIndex, frameData);
+        }
+    }
+    if (!frameData) return;
+    rotateTexture(track);
+    
+    if (dirtyRegions && track.converter.canConvertChanges()) {
+        uploadChanges(track, frameData);
+        // The cache keeps whole frames for seeking
+        uint8_t* slot = track.cache.insert(frameIndex, track.image.size());
+        if (slot) std::memcpy(slot, track.image.data(), track.image.size());
+        return;
+    }
+    
+    uint8_t* slot = track.cache.insert(frameIndex, track.converter.getDisplayFrameSize());
+    if (slot) {
+        // Convert into the cache, then upload from there
+        track.converter.convert(frameData, slot, displayPitch);
+        uploadFrame(track, slot);
+    } else if (track.converter.isPassThrough() || (track.jpegDecoder && !track.converter.isScaled())) {
+        // YUV frames go to the texture as read; the renderer converts.
+        // Decoded MJPG frames are in the texture format already
+        uploadFrame(track, frameData);
+    } else {
+        // Update texture
+        void* pixels;
+        int pitch;
+        SDL_LockTexture(track.texture, nullptr, &pixels, &pitch);
+        
+        track.converter.convert(frameData, static_cast<uint8_t*>(pixels), pitch);
+        
+        SDL_UnlockTexture(track.texture);
+    }
+}
+
+void AVIPlayer::uploadFrame(VideoTrack& track, const uint8_t* frame) {
+    const uint8_t* planes[3];
+    int pitches[3];
+    track.converter.getPlanes(frame, planes, pitches);
+    
+    FrameConverter::YUVLayout layout = track.converter.isPassThrough() ?
+                                       track.converter.getYUVLayout() : FrameConverter::YUV_NONE;
+    switch (layout) {
+        case FrameConverter::YUV_I420:
+        case FrameConverter::YUV_YV12:
+            SDL_UpdateYUVTexture(track.texture, nullptr, planes[0], pitches[0],
+                                 planes[1], pitches[1], planes[2], pitches[2]);
             break;
-        case 24:
-            convert24BitBGRToRGB(frameData, pixels, pitch);
+        case FrameConverter::YUV_NV12:
+#if SDL_VERSION_ATLEAST(2, 0, 16)
+            SDL_UpdateNVTexture(track.texture, nullptr, planes[0], pitches[0], planes[1], pitches[1]);
+#else
+            // Older SDL takes the planes as one block, chroma after luma
+            SDL_UpdateTexture(track.texture, nullptr, frame, pitches[0]);
+#endif
             break;
-        case 32:
-            convert32BitBGRAToRGBA(frameData, pixels, pitch);
+        default:
+            SDL_UpdateTexture(track.texture, nullptr, frame, pitches[0]);
             break;
     }
 }
 
-void AVIPlayer::convert8BitToRGB24(const std::vector<uint8_t>& frameData, uint8_t* pixels, int pitch) {
-    for (uint32_t y = 0; y < frameHeight; ++y) {
-        uint32_t srcY = isTopDown ? y : (frameHeight - 1 - y);
-        uint8_t* dst = pixels + y * pitch;
-        const uint8_t* src = frameData.data() + srcY * frameWidth;
-        
-        for (uint32_t x = 0; x < frameWidth; ++x) {
-            uint8_t paletteIndex = src[x];
-            if (paletteIndex < palette.size()) {
-                const RGBQuad& color = palette[paletteIndex];
-                dst[x * 3 + 0] = color.red;
-                dst[x * 3 + 1] = color.green;
-                dst[x * 3 + 2] = color.blue;
-            } else {
-                // Fallback for invalid palette index
-                dst[x * 3 + 0] = dst[x * 3 + 1] = dst[x * 3 + 2] = 0;
-            }
+void AVIPlayer::uploadChanges(VideoTrack& track, const uint8_t* frameData) {
+    const FrameConverter& converter = track.converter;
+    uint32_t displayPitch = converter.getDisplayPitch();
+    size_t referenceSize = static_cast<size_t>(converter.getSourceStride()) * converter.getHeight();
+    uint64_t framePixels = static_cast<uint64_t>(converter.getWidth()) * converter.getHeight();
+    comparedPixels += framePixels;
+    
+    if (!track.referenceValid) {
+        // Nothing to compare with: the whole frame is new, and so it is
+        // for every texture of the ring
+        track.image.resize(converter.getDisplayFrameSize());
+        track.reference.assign(frameData, frameData + referenceSize);
+        converter.convert(frameData, track.image.data(), displayPitch);
+        track.referenceValid = true;
+        track.recentRegions.clear();
+        track.staleTextures = track.textures.size();
+    } else {
+        converter.convertChanges(frameData, track.reference.data(), track.image.data(), displayPitch, track.regions);
+        track.recentRegions.push_back(track.regions);
+        while (track.recentRegions.size() > track.textures.size()) {
+            track.recentRegions.pop_front();
         }
     }
-}
-
-void AVIPlayer::convert16BitToRGB565(const std::vector<uint8_t>& frameData, uint8_t* pixels, int pitch) {
-    for (uint32_t y = 0; y < frameHeight; ++y) {
-        uint32_t srcY = isTopDown ? y : (frameHeight - 1 - y);
-        uint16_t* dst = reinterpret_cast<uint16_t*>(pixels + y * pitch);
-        const uint16_t* src = reinterpret_cast<const uint16_t*>(frameData.data() + srcY * frameWidth * 2);
-        
-        for (uint32_t x = 0; x < frameWidth; ++x) {
-            // AVI stores as little-endian, so no conversion needed for RGB565
-            dst[x] = src[x];
+    
+    if (track.staleTextures > 0) {
+        SDL_UpdateTexture(track.texture, nullptr, track.image.data(), displayPitch);
+        --track.staleTextures;
+        changedPixels += framePixels;
+        return;
+    }
+    
+    // The texture last held the frame as many frames ago as there are
+    // textures, so it takes the regions of all of them
+    uint32_t displayBytes = displayPitch / converter.getWidth();
+    for (size_t i = 0; i < track.recentRegions.size(); ++i) {
+        const std::vector<SDL_Rect>& regions = track.recentRegions[i];
+        for (size_t j = 0; j < regions.size(); ++j) {
+            const SDL_Rect& region = regions[j];
+            const uint8_t* pixels = track.image.data() + static_cast<size_t>(region.y) * displayPitch +
+                                    static_cast<size_t>(region.x) * displayBytes;
+            SDL_UpdateTexture(track.texture, &region, pixels, displayPitch);
+            changedPixels += static_cast<uint64_t>(region.w) * region.h;
         }
     }
 }
 
-void AVIPlayer::convert24BitBGRToRGB(const std::vector<uint8_t>& frameData, uint8_t* pixels, int pitch) {
-    for (uint32_t y = 0; y < frameHeight; ++y) {
-        uint32_t srcY = isTopDown ? y : (frameHeight - 1 - y);
-        uint8_t* dst = pixels + y * pitch;
-        const uint8_t* src = frameData.data() + srcY * frameWidth * 3;
-        
-        for (uint32_t x = 0; x < frameWidth; ++x) {
-            // Convert BGR to RGB
-            dst[x * 3 + 0] = src[x * 3 + 2]; // R
-            dst[x * 3 + 1] = src[x * 3 + 1]; // G
-            dst[x * 3 + 2] = src[x * 3 + 0]; // B
-        }
-    }
+void AVIPlayer::rotateTexture(VideoTrack& track) {
+    track.texture = track.textures[track.nextTexture];
+    track.nextTexture = (track.nextTexture + 1) % track.textures.size();
 }
 
-void AVIPlayer::convert32BitBGRAToRGBA(const std::vector<uint8_t>& frameData, uint8_t* pixels, int pitch) {
-    for (uint32_t y = 0; y < frameHeight; ++y) {
-        uint32_t srcY = isTopDown ? y : (frameHeight - 1 - y);
-        uint8_t* dst = pixels + y * pitch;
-        const uint8_t* src = frameData.data() + srcY * frameWidth * 4;
-        
-        for (uint32_t x = 0; x < frameWidth; ++x) {
-            // Convert BGRA to RGBA
-            dst[x * 4 + 0] = src[x * 4 + 2]; // R
-            dst[x * 4 + 1] = src[x * 4 + 1]; // G
-            dst[x * 4 + 2] = src[x * 4 + 0]; // B
-            dst[x * 4 + 3] = src[x * 4 + 3]; // A
-        }
+void AVIPlayer::destroyTextures(VideoTrack& track) {
+    for (size_t i = 0; i < track.textures.size(); ++i) {
+        SDL_DestroyTexture(track.textures[i]);
     }
+    track.textures.clear();
+    track.texture = nullptr;
 }
 
 void AVIPlayer::cleanup() {
-    if (texture) {
-        SDL_DestroyTexture(texture);
-        texture = nullptr;
+    audio.reset();
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        destroyTextures(*tracks[i]);
     }
+    tracks.clear();
     if (renderer) {
         SDL_DestroyRenderer(renderer);
         renderer = nullptr;
@@ -446,8 +968,11 @@ void AVIPlayer::cleanup() {
         SDL_DestroyWindow(window);
         window = nullptr;
     }
-    if (file.is_open()) {
-        file.close();
+    if (preloadThread.joinable()) {
+        preloadThread.join();
     }
+    nextClip.reset();
+    retiredClip.reset();
+    reader->close();
     SDL_Quit();
 }
\ No newline at end of file
@@ -7,134 +7,53 @@
  * 
  * This header defines a simple AVI video player that can load and play
  * uncompressed AVI files using SDL2 for rendering. The player supports
- * various uncompressed pixel formats including 8-bit indexed, 16-bit RGB565,
- * 24-bit RGB, and 32-bit RGBA.
+ * various uncompressed pixel formats including 8-bit indexed, 16-bit RGB555
+ * and RGB565, 24-bit RGB, 32-bit XRGB/ARGB, YUV (YUY2, UYVY, I420, YV12,
+ * NV12), high bit depths (v210, 48-bit RGB, 64-bit RGBA) and Motion-JPEG.
  */
 
 #ifndef AVI_PLAYER_H
 #define AVI_PLAYER_H
 
+#include "audio_output.h"
+#include "avi_reader.h"
+#include "frame_cache.h"
+#include "frame_converter.h"
+#include "mjpeg_decoder.h"
+#include "read_ahead.h"
+#include "rle_decoder.h"
+#include "thread_pool.h"
 #include <SDL2/SDL.h>
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <deque>
 #include <cstring>
 #include <chrono>
 #include <thread>
-
-/**
- * @brief RIFF file header structure
- * 
- * Contains the basic RIFF container information for AVI files.
- */
-#pragma pack(push, 1)
-struct RIFFHeader {
-    char signature[4];      ///< "RIFF" signature
-    uint32_t fileSize;      ///< Total file size minus 8 bytes
-    char format[4];         ///< "AVI " format identifier
-};
-
-/**
- * @brief Main AVI header structure (avih chunk)
- * 
- * Contains global information about the AVI file including
- * frame rate, dimensions, and total frame count.
- */
-struct AVIMainHeader {
-    uint32_t microSecPerFrame;      ///< Frame duration in microseconds
-    uint32_t maxBytesPerSec;        ///< Maximum data rate
-    uint32_t paddingGranularity;    ///< Padding granularity
-    uint32_t flags;                 ///< AVI file flags
-    uint32_t totalFrames;           ///< Total number of frames
-    uint32_t initialFrames;         ///< Initial frames for interleaved files
-    uint32_t streams;               ///< Number of streams
-    uint32_t suggestedBufferSize;   ///< Suggested buffer size
-    uint32_t width;                 ///< Video width in pixels
-    uint32_t height;                ///< Video height in pixels
-    uint32_t reserved[4];           ///< Reserved fields
-};
-
-/**
- * @brief Stream header structure (strh chunk)
- * 
- * Contains information about individual streams (video/audio).
- */
-struct AVIStreamHeader {
-    char fccType[4];                ///< Stream type ('vids', 'auds', etc.)
-    char fccHandler[4];             ///< Codec handler
-    uint32_t flags;                 ///< Stream flags
-    uint16_t priority;              ///< Stream priority
-    uint16_t language;              ///< Language code
-    uint32_t initialFrames;         ///< Initial frames
-    uint32_t scale;                 ///< Time scale
-    uint32_t rate;                  ///< Rate (rate/scale = samples/second)
-    uint32_t start;                 ///< Start time
-    uint32_t length;                ///< Stream length
-    uint32_t suggestedBufferSize;   ///< Suggested buffer size
-    uint32_t quality;               ///< Quality indicator
-    uint32_t sampleSize;            ///< Sample size
-    struct {
-        int16_t left;               ///< Left coordinate
-        int16_t top;                ///< Top coordinate
-        int16_t right;              ///< Right coordinate
-        int16_t bottom;             ///< Bottom coordinate
-    } frame;                        ///< Frame rectangle
-};
-
-/**
- * @brief Bitmap info header structure (strf chunk for video)
- * 
- * Contains detailed information about the video format.
- */
-struct BitmapInfoHeader {
-    uint32_t size;                  ///< Header size
-    int32_t width;                  ///< Image width
-    int32_t height;                 ///< Image height (negative = top-down)
-    uint16_t planes;                ///< Number of color planes
-    uint16_t bitCount;              ///< Bits per pixel
-    uint32_t compression;           ///< Compression type
-    uint32_t sizeImage;             ///< Image size in bytes
-    int32_t xPelsPerMeter;          ///< Horizontal resolution
-    int32_t yPelsPerMeter;          ///< Vertical resolution
-    uint32_t clrUsed;               ///< Colors used
-    uint32_t clrImportant;          ///< Important colors
-};
-
-/**
- * @brief RGB color quad for palette entries
- * 
- * Used for 8-bit indexed color palettes.
- */
-struct RGBQuad {
-    uint8_t blue;                   ///< Blue component
-    uint8_t green;                  ///< Green component
-    uint8_t red;                    ///< Red component
-    uint8_t reserved;               ///< Reserved (usually 0)
-};
-#pragma pack(pop)
-
-/**
- * @brief Chunk header structure
- * 
- * Generic chunk header used throughout AVI files.
- */
-struct ChunkHeader {
-    char fourCC[4];                 ///< Four-character code
-    uint32_t size;                  ///< Chunk data size
-};
+#include <memory>
+#include <string>
 
 /**
  * @brief Simple AVI Player Class
  * 
  * This class provides functionality to load and play uncompressed AVI files
  * using SDL2 for rendering. It supports multiple pixel formats and maintains
- * proper frame timing based on the video's native frame rate.
+ * proper frame timing based on the video's native frame rate. Files with
+ * several video streams can show any selection of them side by side.
+ * Several files can be played back to back as a gapless playlist. The
+ * window can be resized or made fullscreen; the video keeps its aspect
+ * ratio, with black bars on the sides that do not fit.
  * 
  * Supported formats:
- * - 8-bit indexed color (with palette)
- * - 16-bit RGB565
+ * - 8-bit indexed color (with palette), also RLE8 and RLE4 compressed
+ * - 16-bit RGB555 and RGB565, or any BI_BITFIELDS masks
  * - 24-bit RGB (BGR in AVI)
- * - 32-bit RGBA (BGRA in AVI)
+ * - 32-bit XRGB and ARGB (BGRA in AVI), or any BI_BITFIELDS masks
+ * - YUY2, UYVY, I420, YV12 and NV12, uploaded to YUV textures unconverted
+ * - v210, 48-bit RGB and 64-bit RGBA, dithered to 8 bits or shown as
+ *   ARGB2101010 where the renderer supports it
+ * - Motion-JPEG, decoded ahead of playback on a pool of threads
  * 
  * Usage example:
  * @code
@@ -148,28 +67,97 @@ class AVIPlayer {
 private:
     SDL_Window* window;             ///< SDL window handle
     SDL_Renderer* renderer;         ///< SDL renderer handle
-    SDL_Texture* texture;           ///< SDL texture for frame display
+    bool convertYUV;                ///< True if YUV frames are converted to RGB on the CPU
+    bool tenBitTextures;            ///< True if the renderer takes ARGB2101010 textures
+    bool scaleOnCPU;                ///< True if frames are shrunk to the window before upload (software renderer)
+    bool fullscreen;                ///< True while the window fills the screen
+    bool dirtyRegions;              ///< True if only the parts of frames that changed are converted and uploaded
+    unsigned textureCount;          ///< Streaming textures per track, written in turn
+    bool vsync;                     ///< True if presentation waits for the display refresh
+    uint64_t comparedPixels;        ///< Pixels of frames compared for dirty regions
+    uint64_t changedPixels;         ///< Pixels of dirty regions uploaded
+    std::unique_ptr<ThreadPool> bandPool; ///< Workers for high-bit-depth frames, created with the first such track
+    unsigned decodeThreads;         ///< Workers of decodePool, 0 for one per hardware thread
+    std::unique_ptr<ThreadPool> decodePool; ///< Workers for MJPG frames, created with the first such track
     
-    std::ifstream file;             ///< Input file stream
-    AVIMainHeader mainHeader;       ///< Main AVI header
-    AVIStreamHeader streamHeader;   ///< Video stream header
-    BitmapInfoHeader bitmapHeader;  ///< Bitmap format header
+    /**
+     * @brief State of one displayed video stream
+     */
+    struct VideoTrack {
+        int stream;                                  ///< Stream number in the file
+        FrameConverter converter;                    ///< Raw to display format conversion
+        FrameCache cache;                            ///< Converted frames for seeking and looping
+        std::unique_ptr<ReadAheadWindow> readAhead;  ///< Block prefetcher for raw frames
+        std::unique_ptr<RLEDecoder> decoder;         ///< Decoded image of RLE streams, null otherwise
+        std::unique_ptr<MJPEGDecoder> jpegDecoder;   ///< Decode pipeline of MJPG streams, null otherwise
+        std::vector<SDL_Texture*> textures;          ///< Ring of streaming textures, written in turn
+        size_t nextTexture;                          ///< Index of the texture the next frame goes to
+        SDL_Texture* texture;                        ///< Texture holding the latest frame
+        SDL_Rect area;                               ///< Position of the stream in the side-by-side frame
+        SDL_Rect target;                             ///< Position of the stream in the window, letterboxed
+        std::vector<uint8_t> reference;              ///< Raw copy of the frame on the texture, for dirty regions
+        std::vector<uint8_t> image;                  ///< Converted copy of the frame on the texture, for dirty regions
+        std::vector<SDL_Rect> regions;               ///< Dirty regions of the latest frame
+        std::deque<std::vector<SDL_Rect>> recentRegions; ///< Dirty regions of the latest frames, one per ring texture
+        bool referenceValid;                         ///< True if reference and image match the latest texture
+        size_t staleTextures;                        ///< Ring textures still to be filled with whole frames
+        
+        VideoTrack() : stream(-1), nextTexture(0), texture(nullptr), referenceValid(false), staleTextures(0) {}
+    };
     
-    uint32_t frameWidth;            ///< Video frame width
-    uint32_t frameHeight;           ///< Video frame height
-    uint32_t fps;                   ///< Frames per second
-    uint32_t totalFrames;           ///< Total number of frames
-    uint32_t currentFrame;          ///< Current frame index
-    uint32_t bitsPerPixel;          ///< Bits per pixel
-    uint32_t bytesPerPixel;         ///< Bytes per pixel
-    bool isTopDown;                 ///< True if bitmap is top-down
+    /**
+     * @brief An opened file with its tracks, ready to be swapped in
+     */
+    struct Clip {
+        std::unique_ptr<AVIReader> reader;               ///< Frame reader and index
+        std::vector<std::unique_ptr<VideoTrack>> tracks; ///< Video streams to display
+        uint32_t frameWidth;                             ///< Width of all tracks side by side
+        uint32_t frameHeight;                            ///< Height of the tallest track
+        uint32_t fps;                                    ///< Frames per second
+        uint32_t microSecPerFrame;                       ///< Frame duration in microseconds
+        double frameSeconds;                             ///< Frame duration from the stream rate
+        uint32_t totalFrames;                            ///< Frames of the longest track
+        bool ready;                                      ///< True if the file opened and its format is supported
+        
+        Clip() : frameWidth(0), frameHeight(0), fps(0), microSecPerFrame(0),
+                 frameSeconds(0), totalFrames(0), ready(false) {}
+    };
     
-    std::vector<uint32_t> frameOffsets;  ///< File offsets for each frame
-    std::vector<uint32_t> frameSizes;    ///< Size of each frame in bytes
-    std::vector<RGBQuad> palette;        ///< Color palette for 8-bit mode
+    std::unique_ptr<AVIReader> reader;                 ///< Frame reader and index
+    std::vector<int> requestedStreams;                 ///< Video streams to show, -1 for all
+    std::vector<std::unique_ptr<VideoTrack>> tracks;   ///< Displayed video streams
+    size_t cacheBudget;             ///< Converted-frame cache budget shared by all tracks
+    
+    uint32_t frameWidth;            ///< Window width (all tracks side by side)
+    uint32_t frameHeight;           ///< Window height (tallest track)
+    uint32_t fps;                   ///< Frames per second
+    uint32_t microSecPerFrame;      ///< Exact frame duration in microseconds
+    double frameSeconds;            ///< Frame duration from the stream rate, for audio sync
+    uint32_t totalFrames;           ///< Frames of the longest displayed stream
+    int64_t currentFrame;           ///< Index of the next frame to display
+    uint32_t shownFrame;            ///< Index of the frame on screen
     
-    SDL_PixelFormatEnum sdlPixelFormat;  ///< SDL pixel format
     bool isValid;                        ///< True if file loaded successfully
+    
+    bool paused;                         ///< True while playback is paused
+    bool looping;                        ///< True if playback loops
+    bool reverse;                        ///< True if playing backwards
+    double playbackRate;                 ///< Speed relative to the native frame rate
+    bool needsRedraw;                    ///< True if a seek requires a redraw
+    uint32_t loopStart;                  ///< First frame of the loop section
+    uint32_t loopEnd;                    ///< One past the last frame of the loop section
+    
+    std::unique_ptr<AudioOutput> audio;  ///< Audio playback, null without an audio stream
+    bool audioEnabled;                   ///< False if audio was disabled by the user
+    bool audioResync;                    ///< True if audio must restart at the video position
+    
+    std::vector<std::string> playlist;   ///< Files played back to back, the loaded one first
+    size_t nextItem;                     ///< Playlist index of the file being preloaded
+    std::unique_ptr<Clip> nextClip;      ///< Next file, opened by the preload thread
+    std::unique_ptr<Clip> retiredClip;   ///< Previous file, released by the preload thread
+    std::thread preloadThread;           ///< Opens the next file during playback
+    uint64_t retiredBytesRead;           ///< Bytes read for earlier playlist items
+    uint64_t retiredReadCount;           ///< Reads issued for earlier playlist items
 
 public:
     /**
@@ -200,7 +188,9 @@ public:
     /**
      * @brief Initialize SDL subsystem
      * 
-     * Creates SDL window, renderer, and texture based on video dimensions.
+     * Creates a resizable SDL window, shrunk to fit the screen, the
+     * renderer, and one texture per displayed stream based on video
+     * dimensions.
      * Must be called after loadAVI() and before play().
      * 
      * @return true if SDL initialized successfully, false otherwise
@@ -211,129 +201,379 @@ public:
      * @brief Play the loaded video
      * 
      * Starts video playback with proper frame timing. Handles SDL events
-     * for user input (ESC to quit). Blocks until playback completes or
-     * user quits.
+     * for user input (ESC to quit, seeking, pausing and looping). Blocks
+     * until the user quits.
      */
     void play();
+    
+    /**
+     * @brief Set the memory budget of the decoded-frame cache
+     * 
+     * Converted frames are kept in an LRU cache so that seeking back and
+     * looping redisplay them from memory. A budget of zero disables the
+     * cache. With several video streams the budget is split evenly.
+     * Must be called before loadAVI().
+     * 
+     * @param bytes Maximum number of bytes of converted frames to keep
+     */
+    void setCacheBudget(size_t bytes);
+    
+    /**
+     * @brief Choose the video streams to display
+     * 
+     * The selected streams are decoded together and shown side by side in
+     * the order given, all driven by the same frame clock. Must be called
+     * before loadAVI().
+     * 
+     * @param streams Stream numbers; empty for the primary video stream, -1 for all video streams
+     */
+    void setVideoStreams(const std::vector<int>& streams);
+    
+    /**
+     * @brief Enable or disable loop playback
+     * 
+     * When enabled, playback restarts at the beginning of the loop section
+     * (the whole file unless set with the [ and ] keys) instead of stopping.
+     * 
+     * @param enable true to loop
+     */
+    void setLoop(bool enable);
+    
+    /**
+     * @brief Enable or disable reverse playback
+     * 
+     * Reverse playback reads blocks of frames ahead in the backward
+     * direction with large sequential reads and shows them in reverse order.
+     * 
+     * @param enable true to play backwards
+     */
+    void setReverse(bool enable);
+    
+    /**
+     * @brief Set the playback speed
+     * 
+     * Rates above 1 show every n-th frame (n = floor(rate)) and shorten the
+     * display interval to match the exact rate; the skipped frames are never
+     * read from disk. Rates below 1 lengthen the display interval.
+     * 
+     * @param rate Speed relative to the native frame rate, clamped to [0.1, 32]
+     */
+    void setPlaybackRate(double rate);
+    
+    /**
+     * @brief Enable or disable audio playback
+     * 
+     * When enabled and the file has a PCM audio stream, the audio is played
+     * at normal forward speed and the video follows the audio clock.
+     * Must be called before initSDL().
+     * 
+     * @param enable true to play audio
+     */
+    void setAudioEnabled(bool enable);
+    
+    /**
+     * @brief Set the files to play back to back
+     * 
+     * While one file plays, the next is opened, indexed and its first
+     * frames are read on a background thread. At the end of a file the
+     * next one is swapped in on the following frame tick, without closing
+     * the window; textures are recreated only when the format or size
+     * changes. With looping enabled the whole list repeats. The first
+     * file must be loaded with loadAVI(). Files that fail to open are
+     * skipped.
+     * 
+     * @param files Paths of the AVI files, in playing order
+     */
+    void setPlaylist(const std::vector<std::string>& files);
+    
+    /**
+     * @brief Set the number of MJPG decoding threads
+     * 
+     * MJPG frames are decoded ahead of playback, two frames per thread,
+     * and shown in order as they complete. Must be called before
+     * initSDL().
+     * 
+     * @param threads Worker threads, 0 for one per hardware thread
+     */
+    void setDecodeThreads(unsigned threads);
+    
+    /**
+     * @brief Start in fullscreen
+     * 
+     * The F key toggles fullscreen during playback. Must be called before
+     * initSDL().
+     * 
+     * @param enable true to fill the screen
+     */
+    void setFullscreen(bool enable);
+    
+    /**
+     * @brief Upload only the parts of frames that changed
+     * 
+     * Each frame is compared with the one on the texture in bands of 16
+     * rows, and only the changed columns of the bands that differ are
+     * converted and uploaded. Pays off for screen recordings and fixed
+     * cameras, where most of the picture stays still. Applies to RGB,
+     * indexed, RLE and MJPG tracks shown at full size; the others upload
+     * whole frames. Must be called before initSDL().
+     * 
+     * @param enable true to upload dirty regions only
+     */
+    void setDirtyRegions(bool enable);
+    
+    /**
+     * @brief Set the number of streaming textures per track
+     * 
+     * Frames are written to the textures in turn, so the texture being
+     * filled is not the one the GPU may still be drawing, and the driver
+     * need not wait for it. Two textures double buffer, three triple
+     * buffer. The software renderer draws from memory and always uses
+     * one. Must be called before initSDL().
+     * 
+     * @param count Textures per track, from 1 to 3 (default 2)
+     */
+    void setTextureCount(unsigned count);
+    
+    /**
+     * @brief Present frames in step with the display refresh
+     * 
+     * Must be called before initSDL().
+     * 
+     * @param enable true to create the renderer with vsync
+     */
+    void setVSync(bool enable);
+
+    /**
+     * @brief Access the underlying frame reader
+     * 
+     * The reader is thread-safe, so worker threads may fetch frames from
+     * it concurrently while sharing this player's file handle and index.
+     * 
+     * @return Reference to the reader of the loaded file
+     */
+    const AVIReader& getReader() const { return *reader; }
 
 private:
     /**
-     * @brief Determine pixel format from bitmap header
+     * @brief Open a file and set up its tracks
+     * 
+     * Touches no playback state, so it can run on the preload thread.
+     * 
+     * @param filepath Path to the AVI file
+     * @param clip Receives the reader, tracks and timing of the file
+     * @param stride Initial read-ahead stride of the tracks
+     * @return true if the file opened and its format is supported
+     */
+    bool openClip(const std::string& filepath, Clip& clip, int stride) const;
+    
+    /**
+     * @brief Set up a track for a video stream
+     * 
+     * @param clip Clip the track is added to
+     * @param streamNumber Stream number of a video stream
+     * @param stride Initial read-ahead stride
+     * @return true if the stream's format is supported, false otherwise
+     */
+    bool addTrack(Clip& clip, int streamNumber, int stride) const;
+    
+    /**
+     * @brief Make an opened clip the one being played
+     * 
+     * Textures of the previous clip are reused where format and size
+     * match. The previous reader and tracks are kept in retiredClip until
+     * the preload thread releases them.
+     * 
+     * @param clip Clip to play; left empty
+     * @return true if the textures of the clip could be created
+     */
+    bool activateClip(Clip& clip);
+    
+    /**
+     * @brief Create the missing track textures
+     * 
+     * MJPG tracks start decoding ahead on the decode pool.
+     * 
+     * @return true on success, false if a texture could not be created
+     */
+    bool createTextures();
+    
+    /**
+     * @brief Create the textures of a track
      * 
-     * Analyzes the bitmap header to determine the pixel format and
-     * sets up appropriate SDL pixel format and conversion parameters.
+     * A YUV stream whose texture format the renderer rejects is switched
+     * to CPU conversion and gets RGB textures instead. If the renderer
+     * runs out of memory for the rest of the ring, the track makes do
+     * with the textures it got.
      * 
-     * @return true if format is supported, false otherwise
+     * @param track Track without textures
+     * @return true on success, false if no texture could be created
      */
-    bool determinePixelFormat();
+    bool createTexture(VideoTrack& track);
     
     /**
-     * @brief Parse AVI file chunks
+     * @brief Fit the tracks into the window
      * 
-     * Reads through the AVI file structure, parsing headers and
-     * finding the movie data section.
+     * Scales the side-by-side frame to the largest size with its aspect
+     * ratio that fits the renderer output, centered. With scaleOnCPU,
+     * tracks shown smaller than their frames are converted at the shown
+     * size; textures and cached frames of a track whose size changed are
+     * replaced.
      * 
-     * @return true if parsing successful, false otherwise
+     * @return true on success, false if a texture could not be recreated
      */
-    bool parseAVIChunks();
+    bool layoutTracks();
     
     /**
-     * @brief Parse header list chunk
+     * @brief Shrink a window size to the usable area of its display
      * 
-     * Processes the header list containing main header and stream headers.
+     * Keeps the aspect ratio, so that large videos open fully visible.
+     * 
+     * @param width Window width, updated in place
+     * @param height Window height, updated in place
+     */
+    void fitToDisplay(int& width, int& height) const;
+    
+    /**
+     * @brief Open the audio device for the loaded file's audio stream
      * 
-     * @param size Size of the header list
+     * Playback continues without audio if the device cannot be opened.
+     */
+    void openAudio();
+    
+    /**
+     * @brief Start opening the next playlist file in the background
      */
-    void parseHeaderList(uint32_t size);
+    void startPreload();
     
     /**
-     * @brief Parse stream list chunk
+     * @brief Switch to the next playlist file
      * 
-     * Processes individual stream information including format details.
+     * Waits for the preload thread (normally finished long before) and
+     * skips files that could not be opened.
      * 
-     * @param size Size of the stream list
+     * @return true if a new file is loaded, false at the end of the playlist
      */
-    void parseStreamList(uint32_t size);
+    bool advancePlaylist();
     
     /**
-     * @brief Index video frames
+     * @brief Handle a key press during playback
      * 
-     * Scans the movie data section and records the file offset and size
-     * of each video frame for efficient seeking during playback.
+     * @param key Key that was pressed
+     */
+    void handleKey(SDL_Keycode key);
+    
+    /**
+     * @brief Frame step between two displayed frames
      * 
-     * @param movieSize Size of the movie data section
+     * @return Signed stride derived from the playback rate and direction
      */
-    void indexFrames(uint32_t movieSize);
+    int frameStep() const;
+    
+    /**
+     * @brief Pass the current frame step to the prefetchers of all tracks
+     */
+    void updateStrides();
+    
+    /**
+     * @brief Time between two displayed frames
+     * 
+     * @return Display interval for the current playback rate
+     */
+    std::chrono::nanoseconds frameInterval() const;
+    
+    /**
+     * @brief Check whether video should follow the audio clock
+     * 
+     * @return true at normal forward speed while playing with audio
+     */
+    bool audioDrivesClock() const;
+    
+    /**
+     * @brief Start or stop audio to match the playback state
+     * 
+     * Restarts the audio at the next video frame after seeks, loop wraps
+     * and speed or direction changes.
+     */
+    void syncAudio();
+    
+    /**
+     * @brief Move the playback position
+     * 
+     * Clamps the target to the valid frame range and schedules a redraw
+     * and an audio restart.
+     * 
+     * @param frameIndex Frame to display next
+     */
+    void seekTo(int64_t frameIndex);
     
     /**
      * @brief Render a specific frame
      * 
-     * Reads frame data from file, converts pixel format if necessary,
-     * and renders to the SDL texture.
+     * Updates the texture of every track and presents them together.
      * 
      * @param frameIndex Index of the frame to render
      */
     void renderFrame(uint32_t frameIndex);
     
     /**
-     * @brief Convert and copy frame data
+     * @brief Update a track's texture with a frame
      * 
-     * Dispatches to appropriate conversion function based on pixel format.
+     * Takes the converted frame from the cache when present; otherwise
+     * reads frame data from file, converts pixel format if necessary,
+     * and uploads it to the track's texture. Frames past the end of the
+     * stream and dropped frames keep the previous image.
      * 
-     * @param frameData Raw frame data from AVI file
-     * @param pixels Destination pixel buffer
-     * @param pitch Row stride in bytes
+     * @param track Track to update
+     * @param frameIndex Index of the frame within the track's stream
      */
-    void convertAndCopyFrame(const std::vector<uint8_t>& frameData, uint8_t* pixels, int pitch);
+    void updateTrack(VideoTrack& track, uint32_t frameIndex);
     
     /**
-     * @brief Convert 8-bit indexed to RGB24
+     * @brief Upload a frame in display layout to a track's texture
      * 
-     * Converts 8-bit palette indices to 24-bit RGB using color palette.
+     * YUV frames are uploaded plane by plane, so the planes need not be
+     * copied into one block first.
      * 
-     * @param frameData Source indexed pixel data
-     * @param pixels Destination RGB pixel buffer
-     * @param pitch Row stride in bytes
+     * @param track Track to update
+     * @param frame Converted frame, or a raw frame of a pass-through format
      */
-    void convert8BitToRGB24(const std::vector<uint8_t>& frameData, uint8_t* pixels, int pitch);
+    void uploadFrame(VideoTrack& track, const uint8_t* frame);
     
     /**
-     * @brief Convert 16-bit to RGB565
+     * @brief Make the next texture of a track's ring the one to write
      * 
-     * Copies 16-bit RGB565 data with proper byte order handling.
+     * Called once per frame, before the frame is uploaded; afterwards
+     * track.texture is the texture written and shown.
      * 
-     * @param frameData Source 16-bit pixel data
-     * @param pixels Destination pixel buffer
-     * @param pitch Row stride in bytes
+     * @param track Track about to be updated
      */
-    void convert16BitToRGB565(const std::vector<uint8_t>& frameData, uint8_t* pixels, int pitch);
+    void rotateTexture(VideoTrack& track);
     
     /**
-     * @brief Convert 24-bit BGR to RGB
-     * 
-     * Converts AVI's BGR byte order to SDL's RGB byte order.
+     * @brief Destroy all textures of a track
      * 
-     * @param frameData Source BGR pixel data
-     * @param pixels Destination RGB pixel buffer
-     * @param pitch Row stride in bytes
+     * @param track Track whose ring is released
      */
-    void convert24BitBGRToRGB(const std::vector<uint8_t>& frameData, uint8_t* pixels, int pitch);
+    void destroyTextures(VideoTrack& track);
     
     /**
-     * @brief Convert 32-bit BGRA to RGBA
+     * @brief Convert and upload the parts of a frame that changed
      * 
-     * Converts AVI's BGRA byte order to SDL's RGBA byte order.
+     * The first frame after the texture was created or filled from the
+     * cache is uploaded whole, as there is nothing to compare it with.
+     * With several textures, each also receives the regions of the
+     * frames written to the others since it was last updated.
      * 
-     * @param frameData Source BGRA pixel data
-     * @param pixels Destination RGBA pixel buffer
-     * @param pitch Row stride in bytes
+     * @param track Track to update, whose converter can convert changes
+     * @param frameData Raw or decoded frame
      */
-    void convert32BitBGRAToRGBA(const std::vector<uint8_t>& frameData, uint8_t* pixels, int pitch);
+    void uploadChanges(VideoTrack& track, const uint8_t* frameData);
     
     /**
      * @brief Clean up resources
      * 
-     * Destroys SDL objects, closes files, and resets state.
+     * Stops the preload thread, destroys SDL objects, closes files, and
+     * resets state.
      */
     void cleanup();
 };
@@ -0,0 +1,681 @@
+/**
+ * @file avi_reader.cpp
+ * @brief Implementation of the AVIReader class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "avi_reader.h"
+#include <algorithm>
+#include <cerrno>
+#include <iostream>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace {
+    /**
+     * @brief Decode the stream number of a movi chunk ID
+     *
+     * @param fourCC Chunk ID such as "00dc" or "01wb"
+     * @return Stream number, or -1 if the ID does not start with two digits
+     */
+    int chunkStreamNumber(const char* fourCC) {
+        if (fourCC[0] < '0' || fourCC[0] > '9' || fourCC[1] < '0' || fourCC[1] > '9') return -1;
+        return (fourCC[0] - '0') * 10 + (fourCC[1] - '0');
+    }
+
+    /**
+     * @brief Write a buffer at an absolute file offset
+     *
+     * @return true if all bytes were written
+     */
+    bool writeAt(int fd, uint64_t offset, const uint8_t* data, size_t size) {
+        while (size > 0) {
+#ifdef _WIN32
+            if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) return false;
+            int written = _write(fd, data, static_cast<unsigned>(std::min(size, static_cast<size_t>(1u << 30))));
+#else
+            ssize_t written = pwrite(fd, data, size, static_cast<off_t>(offset));
+#endif
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += written;
+            offset += static_cast<uint64_t>(written);
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Largest buffer used when copy_file_range() is not available
+     */
+    const uint64_t kCopyBufferBytes = 8u << 20;
+
+    /**
+     * @brief AVIIF_KEYFRAME flag of idx1 entries
+     */
+    const uint32_t kKeyFrame = 0x10;
+
+    /**
+     * @brief Largest strf chunk accepted
+     *
+     * A BITMAPV5HEADER with a full palette or a WAVEFORMATEXTENSIBLE with
+     * codec data is a few KB; larger sizes come from corrupt headers.
+     */
+    const uint32_t kMaxFormatBytes = 64u << 10;
+
+    /**
+     * @brief biCompression of bitmaps with color masks
+     */
+    const uint32_t kBitFields = 3;
+    const uint32_t kAlphaBitFields = 6;
+}
+
+AVIStream::AVIStream() : totalBytes(0), maxChunkSize(0) {
+    std::memset(chunkId, 0, sizeof(chunkId));
+    std::memset(&header, 0, sizeof(header));
+    std::memset(&bitmapHeader, 0, sizeof(bitmapHeader));
+    std::memset(&colorMasks, 0, sizeof(colorMasks));
+    std::memset(&waveFormat, 0, sizeof(waveFormat));
+}
+
+bool AVIStream::isVideo() const {
+    return strncmp(header.fccType, "vids", 4) == 0 && format.size() >= sizeof(BitmapInfoHeader);
+}
+
+bool AVIStream::isAudio() const {
+    return strncmp(header.fccType, "auds", 4) == 0 && format.size() >= sizeof(WaveFormatEx);
+}
+
+uint32_t AVIStream::findKeyframe(uint32_t chunk) const {
+    std::vector<uint32_t>::const_iterator next = std::upper_bound(keyframes.begin(), keyframes.end(), chunk);
+    return next == keyframes.begin() ? 0 : *(next - 1);
+}
+
+void AVIStream::appendChunk(const char* id, uint64_t offset, uint32_t size, bool keyframe) {
+    if (chunkOffsets.empty()) std::memcpy(chunkId, id, sizeof(chunkId));
+    if (keyframe) keyframes.push_back(static_cast<uint32_t>(chunkOffsets.size()));
+    chunkOffsets.push_back(offset);
+    chunkSizes.push_back(size);
+    chunkStarts.push_back(totalBytes);
+    totalBytes += size;
+    if (size > maxChunkSize) maxChunkSize = size;
+}
+
+void AVIStream::clearChunks() {
+    chunkOffsets.clear();
+    chunkSizes.clear();
+    chunkStarts.clear();
+    keyframes.clear();
+    totalBytes = 0;
+    maxChunkSize = 0;
+    std::memset(chunkId, 0, sizeof(chunkId));
+}
+
+AVIReader::AVIReader()
+#ifdef _WIN32
+    : handle(INVALID_HANDLE_VALUE),
+#else
+    : fd(-1),
+#endif
+      fileSize(0), videoStream(-1), audioStream(-1) {
+    std::memset(&mainHeader, 0, sizeof(mainHeader));
+}
+
+AVIReader::~AVIReader() {
+    close();
+}
+
+bool AVIReader::open(const std::string& filepath) {
+    close();
+
+#ifdef _WIN32
+    handle = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        std::cerr << "Error: Cannot open file " << filepath << std::endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(static_cast<HANDLE>(handle), &size);
+    fileSize = static_cast<uint64_t>(size.QuadPart);
+#else
+    fd = ::open(filepath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Cannot open file " << filepath << std::endl;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+        fileSize = static_cast<uint64_t>(st.st_size);
+    }
+#endif
+
+    // Read RIFF header
+    RIFFHeader riffHeader;
+    if (!readAt(0, &riffHeader, sizeof(RIFFHeader)) ||
+        strncmp(riffHeader.signature, "RIFF", 4) != 0 ||
+        strncmp(riffHeader.format, "AVI ", 4) != 0) {
+        std::cerr << "Error: Not a valid AVI file" << std::endl;
+        close();
+        return false;
+    }
+
+    // Parse AVI chunks
+    if (!parseAVIChunks()) {
+        std::cerr << "Error: Failed to parse AVI structure" << std::endl;
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void AVIReader::close() {
+#ifdef _WIN32
+    if (handle != INVALID_HANDLE_VALUE) {
+        CloseHandle(static_cast<HANDLE>(handle));
+        handle = INVALID_HANDLE_VALUE;
+    }
+#else
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+    fileSize = 0;
+    streams.clear();
+    videoStream = -1;
+    audioStream = -1;
+}
+
+bool AVIReader::isOpen() const {
+#ifdef _WIN32
+    return handle != INVALID_HANDLE_VALUE;
+#else
+    return fd >= 0;
+#endif
+}
+
+bool AVIReader::readAt(uint64_t offset, void* buffer, size_t size) const {
+    uint8_t* dst = static_cast<uint8_t*>(buffer);
+
+    while (size > 0) {
+#ifdef _WIN32
+        OVERLAPPED overlapped;
+        std::memset(&overlapped, 0, sizeof(overlapped));
+        overlapped.Offset = static_cast<DWORD>(offset & 0xFFFFFFFFu);
+        overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+        DWORD request = size > 0x40000000u ? 0x40000000u : static_cast<DWORD>(size);
+        DWORD bytesRead = 0;
+        if (!ReadFile(static_cast<HANDLE>(handle), dst, request, &bytesRead, &overlapped) ||
+            bytesRead == 0) {
+            return false;
+        }
+#else
+        ssize_t bytesRead = pread(fd, dst, size, static_cast<off_t>(offset));
+        if (bytesRead < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        if (bytesRead == 0) {
+            return false; // Unexpected end of file
+        }
+#endif
+        dst += bytesRead;
+        offset += static_cast<uint64_t>(bytesRead);
+        size -= static_cast<size_t>(bytesRead);
+    }
+
+    return true;
+}
+
+bool AVIReader::readFrame(uint32_t frameIndex, std::vector<uint8_t>& buffer) const {
+    const AVIStream& stream = getStream(videoStream);
+    if (frameIndex >= stream.chunkOffsets.size()) return false;
+
+    buffer.resize(stream.chunkSizes[frameIndex]);
+    return readAt(stream.chunkOffsets[frameIndex], buffer.data(), stream.chunkSizes[frameIndex]);
+}
+
+bool AVIReader::readFrame(uint32_t frameIndex, uint8_t* buffer, size_t bufferSize) const {
+    return readChunk(videoStream, frameIndex, buffer, bufferSize);
+}
+
+bool AVIReader::readChunk(int streamNumber, uint32_t chunkIndex, uint8_t* buffer, size_t bufferSize) const {
+    const AVIStream& stream = getStream(streamNumber);
+    if (chunkIndex >= stream.chunkOffsets.size() || bufferSize < stream.chunkSizes[chunkIndex]) return false;
+
+    return readAt(stream.chunkOffsets[chunkIndex], buffer, stream.chunkSizes[chunkIndex]);
+}
+
+bool AVIReader::copyTo(uint64_t offset, uint64_t size, int outputFd, uint64_t outputOffset) const {
+    if (offset + size > fileSize) return false;
+
+#if defined(__linux__) && defined(SYS_copy_file_range)
+    while (size > 0) {
+        int64_t in = static_cast<int64_t>(offset);
+        int64_t out = static_cast<int64_t>(outputOffset);
+        long copied = syscall(SYS_copy_file_range, fd, &in, outputFd, &out, static_cast<size_t>(size), 0u);
+        if (copied < 0) {
+            if (errno == EINTR) continue;
+            // Old kernels, other file systems or a different device:
+            // copy the rest in user space
+            if (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP) break;
+            return false;
+        }
+        if (copied == 0) return false; // Unexpected end of file
+        offset += static_cast<uint64_t>(copied);
+        outputOffset += static_cast<uint64_t>(copied);
+        size -= static_cast<uint64_t>(copied);
+    }
+#endif
+
+    std::vector<uint8_t> buffer(static_cast<size_t>(std::min(size, kCopyBufferBytes)));
+    while (size > 0) {
+        size_t length = static_cast<size_t>(std::min(size, kCopyBufferBytes));
+        if (!readAt(offset, buffer.data(), length) || !writeAt(outputFd, outputOffset, buffer.data(), length)) {
+            return false;
+        }
+        offset += length;
+        outputOffset += length;
+        size -= length;
+    }
+    return true;
+}
+
+const AVIStream& AVIReader::getStream(int streamNumber) const {
+    if (streamNumber < 0 || streamNumber >= static_cast<int>(streams.size())) return noStream;
+    return streams[streamNumber];
+}
+
+std::vector<int> AVIReader::getVideoStreams() const {
+    std::vector<int> numbers;
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (streams[i].isVideo() && !streams[i].chunkOffsets.empty()) {
+            numbers.push_back(static_cast<int>(i));
+        }
+    }
+    return numbers;
+}
+
+size_t AVIReader::readAudio(uint64_t position, uint8_t* buffer, size_t size) const {
+    const AVIStream& audio = getStream(audioStream);
+    if (audio.chunkOffsets.empty() || position >= audio.totalBytes) return 0;
+
+    // Find the chunk containing the start position
+    size_t chunk = std::upper_bound(audio.chunkStarts.begin(), audio.chunkStarts.end(), position) -
+                   audio.chunkStarts.begin() - 1;
+    size_t copied = 0;
+
+    while (copied < size && chunk < audio.chunkOffsets.size()) {
+        uint64_t inChunk = position - audio.chunkStarts[chunk];
+        size_t length = static_cast<size_t>(audio.chunkSizes[chunk] - inChunk);
+        if (length > size - copied) length = size - copied;
+
+        if (!readAt(audio.chunkOffsets[chunk] + inChunk, buffer + copied, length)) break;
+
+        copied += length;
+        position += length;
+        chunk++;
+    }
+
+    return copied;
+}
+
+bool AVIReader::parseAVIChunks() {
+    ChunkHeader chunk;
+    bool foundMainHeader = false;
+    uint64_t movieList = 0;
+    uint32_t movieSize = 0;
+    uint64_t indexOffset = 0;
+    uint32_t indexSize = 0;
+    std::vector<std::pair<uint64_t, uint32_t> > extensionMovies;
+    uint64_t pos = sizeof(RIFFHeader);
+
+    while (readAt(pos, &chunk, sizeof(ChunkHeader))) {
+        pos += sizeof(ChunkHeader);
+
+        if (strncmp(chunk.fourCC, "LIST", 4) == 0) {
+            char listType[4];
+            if (!readAt(pos, listType, 4)) break;
+
+            if (strncmp(listType, "hdrl", 4) == 0) {
+                // Header list - parse headers
+                parseHeaderList(pos + 4, chunk.size - 4);
+                foundMainHeader = true;
+            } else if (strncmp(listType, "movi", 4) == 0) {
+                // Movie data - indexed from the indexes if present, else scanned
+                if (movieList == 0) {
+                    movieList = pos;
+                    movieSize = chunk.size - 4;
+                } else {
+                    extensionMovies.push_back(std::make_pair(pos + 4, chunk.size - 4));
+                }
+            }
+        } else if (strncmp(chunk.fourCC, "idx1", 4) == 0 && movieList != 0 && indexOffset == 0) {
+            indexOffset = pos;
+            indexSize = chunk.size;
+        } else if (strncmp(chunk.fourCC, "RIFF", 4) == 0) {
+            // OpenDML files continue the movie data in 'AVIX' lists
+            char riffType[4];
+            if (readAt(pos, riffType, 4) && strncmp(riffType, "AVIX", 4) == 0) {
+                pos += 4;
+                continue;
+            }
+        }
+
+        // Skip to the next chunk (pad to even boundary)
+        pos += chunk.size + (chunk.size & 1);
+    }
+
+    const char* source = "";
+    if (loadOpenDMLIndex()) {
+        source = "OpenDML";
+    } else {
+        if (indexOffset != 0 && loadIndex(indexOffset, indexSize, movieList, movieSize)) {
+            source = "idx1";
+        } else if (movieList != 0) {
+            indexFrames(movieList + 4, movieSize);
+        }
+        // idx1 covers the first RIFF list only
+        for (size_t i = 0; i < extensionMovies.size(); ++i) {
+            indexFrames(extensionMovies[i].first, extensionMovies[i].second);
+        }
+    }
+    reportIndex(source);
+
+    // The first video stream with frames is the primary one
+    std::vector<int> videoStreams = getVideoStreams();
+    videoStream = videoStreams.empty() ? -1 : videoStreams[0];
+
+    return foundMainHeader && videoStream >= 0;
+}
+
+void AVIReader::parseHeaderList(uint64_t offset, uint32_t size) {
+    uint64_t end = offset + size;
+    uint64_t pos = offset;
+    ChunkHeader chunk;
+
+    while (pos < end && readAt(pos, &chunk, sizeof(ChunkHeader))) {
+        pos += sizeof(ChunkHeader);
+
+        if (strncmp(chunk.fourCC, "avih", 4) == 0) {
+            // Main AVI header
+            readAt(pos, &mainHeader, sizeof(AVIMainHeader));
+        } else if (strncmp(chunk.fourCC, "LIST", 4) == 0) {
+            char listType[4];
+            if (readAt(pos, listType, 4) && strncmp(listType, "strl", 4) == 0) {
+                // Stream list
+                streams.push_back(AVIStream());
+                parseStreamList(pos + 4, chunk.size - 4, streams.back());
+            }
+        }
+
+        pos += chunk.size + (chunk.size & 1);
+    }
+}
+
+void AVIReader::parseStreamList(uint64_t offset, uint32_t size, AVIStream& stream) {
+    uint64_t end = std::min(offset + size, fileSize);
+    uint64_t pos = offset;
+    ChunkHeader chunk;
+    int streamNumber = static_cast<int>(streams.size()) - 1;
+
+    while (pos < end && readAt(pos, &chunk, sizeof(ChunkHeader))) {
+        pos += sizeof(ChunkHeader);
+        uint64_t room = pos < end ? end - pos : 0;
+
+        if (strncmp(chunk.fourCC, "strh", 4) == 0) {
+            // Stream header
+            readAt(pos, &stream.header, sizeof(AVIStreamHeader));
+        } else if (strncmp(chunk.fourCC, "strf", 4) == 0) {
+            // Stream format, kept raw and decoded below for known stream
+            // types; a size beyond the list or the limit is not allocated
+            if (chunk.size <= room && chunk.size <= kMaxFormatBytes) {
+                stream.format.resize(chunk.size);
+                if (!readAt(pos, stream.format.data(), chunk.size)) stream.format.clear();
+            } else {
+                std::cerr << "Warning: Skipping stream format of " << chunk.size
+                          << " bytes in stream " << streamNumber << std::endl;
+            }
+        } else if (strncmp(chunk.fourCC, "indx", 4) == 0 && chunk.size >= sizeof(AVISuperIndexHeader) &&
+                   chunk.size <= room) {
+            // OpenDML super index: where the standard indexes of the stream are
+            AVISuperIndexHeader index;
+            if (readAt(pos, &index, sizeof(index)) && index.longsPerEntry == 4 && index.indexType == 0) {
+                size_t count = std::min(static_cast<size_t>(index.entriesInUse),
+                                        (chunk.size - sizeof(index)) / sizeof(AVISuperIndexEntry));
+                stream.superIndex.resize(count);
+                if (count > 0 && !readAt(pos + sizeof(index), stream.superIndex.data(),
+                                         count * sizeof(AVISuperIndexEntry))) {
+                    stream.superIndex.clear();
+                }
+            }
+        }
+
+        pos += chunk.size + (chunk.size & 1);
+    }
+
+    if (stream.isVideo()) {
+        std::memcpy(&stream.bitmapHeader, stream.format.data(), sizeof(BitmapInfoHeader));
+        std::cout << "  Video stream " << streamNumber << ": " << stream.bitmapHeader.width << "x"
+                  << (stream.bitmapHeader.height < 0 ? -stream.bitmapHeader.height : stream.bitmapHeader.height)
+                  << ", " << stream.bitmapHeader.bitCount << "-bit" << std::endl;
+
+        // Read palette if present (for 8-bit and 4-bit indexed color)
+        size_t remainingBytes = stream.format.size() - sizeof(BitmapInfoHeader);
+        if (remainingBytes > 0 && stream.bitmapHeader.bitCount <= 8) {
+            size_t paletteEntries = remainingBytes / sizeof(RGBQuad);
+            stream.palette.resize(paletteEntries);
+            std::memcpy(stream.palette.data(), stream.format.data() + sizeof(BitmapInfoHeader),
+                        paletteEntries * sizeof(RGBQuad));
+            std::cout << "  Read palette with " << paletteEntries << " entries" << std::endl;
+        }
+
+        // BI_BITFIELDS and BI_ALPHABITFIELDS masks, at the same place after
+        // a plain header and inside V4/V5 headers
+        uint32_t compression = stream.bitmapHeader.compression;
+        if ((compression == kBitFields || compression == kAlphaBitFields) &&
+            remainingBytes >= 3 * sizeof(uint32_t)) {
+            bool alpha = (compression == kAlphaBitFields || stream.bitmapHeader.size >= 56) &&
+                         remainingBytes >= sizeof(BitmapColorMasks);
+            std::memcpy(&stream.colorMasks, stream.format.data() + sizeof(BitmapInfoHeader),
+                        alpha ? sizeof(BitmapColorMasks) : 3 * sizeof(uint32_t));
+        }
+    } else if (stream.isAudio()) {
+        std::memcpy(&stream.waveFormat, stream.format.data(), sizeof(WaveFormatEx));
+        const WaveFormatEx& waveFormat = stream.waveFormat;
+
+        // Only uncompressed PCM and IEEE float audio can be played
+        if ((waveFormat.formatTag == 1 || waveFormat.formatTag == 3) &&
+            waveFormat.blockAlign > 0 && waveFormat.samplesPerSec > 0) {
+            if (audioStream < 0) audioStream = streamNumber;
+            std::cout << "  Audio: " << waveFormat.samplesPerSec << " Hz, "
+                      << waveFormat.channels << " channel(s), "
+                      << waveFormat.bitsPerSample << "-bit" << std::endl;
+        } else {
+            std::cout << "  Skipping unsupported audio format 0x" << std::hex
+                      << waveFormat.formatTag << std::dec << std::endl;
+        }
+    }
+}
+
+void AVIReader::indexFrames(uint64_t offset, uint32_t movieSize) {
+    uint64_t end = offset + movieSize;
+    uint64_t pos = offset;
+    ChunkHeader chunk;
+
+    while (pos < end && readAt(pos, &chunk, sizeof(ChunkHeader))) {
+        pos += sizeof(ChunkHeader);
+
+        if (strncmp(chunk.fourCC, "LIST", 4) == 0) {
+            // Interleaved files group the chunks of one time slice in 'rec '
+            // lists; index their contents in place
+            char listType[4];
+            if (readAt(pos, listType, 4) && strncmp(listType, "rec ", 4) == 0) {
+                pos += 4;
+                continue;
+            }
+        } else {
+            int streamNumber = chunkStreamNumber(chunk.fourCC);
+            const char* type = chunk.fourCC + 2;
+
+            if (streamNumber >= 0 && streamNumber < static_cast<int>(streams.size()) &&
+                (strncmp(type, "dc", 2) == 0 ||   // Compressed or uncompressed video
+                 strncmp(type, "db", 2) == 0 ||   // DIB format
+                 strncmp(type, "wb", 2) == 0)) {  // Audio data
+                AVIStream& stream = streams[streamNumber];
+
+                // Empty audio chunks carry no samples
+                if (chunk.size > 0 || strncmp(type, "wb", 2) != 0) {
+                    stream.appendChunk(chunk.fourCC, pos, chunk.size, false);
+                }
+            }
+        }
+
+        // Skip chunk data (pad to even boundary)
+        pos += chunk.size + (chunk.size & 1);
+    }
+
+}
+
+bool AVIReader::loadIndex(uint64_t offset, uint32_t size, uint64_t movieList, uint32_t movieSize) {
+    size_t count = size / sizeof(AVIIndexEntry);
+    if (count == 0) return false;
+
+    std::vector<AVIIndexEntry> entries(count);
+    if (!readAt(offset, entries.data(), count * sizeof(AVIIndexEntry))) return false;
+
+    // Offsets point at the chunk header, counted from the 'movi' list type
+    // in most files and from the start of the file in some; check which
+    // one finds the first data chunk
+    size_t probe = 0;
+    while (probe < count && chunkStreamNumber(entries[probe].chunkId) < 0) probe++;
+    if (probe == count) return false;
+
+    uint64_t base = 0;
+    ChunkHeader chunk;
+    if (readAt(movieList + entries[probe].offset, &chunk, sizeof(ChunkHeader)) &&
+        memcmp(chunk.fourCC, entries[probe].chunkId, 4) == 0) {
+        base = movieList;
+    } else if (!readAt(entries[probe].offset, &chunk, sizeof(ChunkHeader)) ||
+               memcmp(chunk.fourCC, entries[probe].chunkId, 4) != 0) {
+        return false;
+    }
+
+    uint64_t movieEnd = movieList + 4 + movieSize;
+    for (size_t i = 0; i < count; ++i) {
+        const AVIIndexEntry& entry = entries[i];
+        int streamNumber = chunkStreamNumber(entry.chunkId);
+        const char* type = entry.chunkId + 2;
+        if (streamNumber < 0 || streamNumber >= static_cast<int>(streams.size()) ||
+            (strncmp(type, "dc", 2) != 0 && strncmp(type, "db", 2) != 0 && strncmp(type, "wb", 2) != 0)) {
+            continue;
+        }
+
+        uint64_t payload = base + entry.offset + sizeof(ChunkHeader);
+        if (payload + entry.size > movieEnd) {
+            // Damaged or foreign index: start over with a scan
+            for (size_t s = 0; s < streams.size(); ++s) {
+                streams[s].clearChunks();
+            }
+            return false;
+        }
+
+        // Same rules as the scan: empty audio chunks carry no samples
+        if (entry.size == 0 && strncmp(type, "wb", 2) == 0) continue;
+
+        streams[streamNumber].appendChunk(entry.chunkId, payload, entry.size, (entry.flags & kKeyFrame) != 0);
+    }
+
+    return true;
+}
+
+bool AVIReader::loadOpenDMLIndex() {
+    bool found = false;
+    for (size_t s = 0; s < streams.size(); ++s) {
+        if (!streams[s].superIndex.empty()) {
+            found = true;
+        } else if (streams[s].isVideo() || streams[s].isAudio()) {
+            return false;
+        }
+    }
+    if (!found) return false;
+
+    std::vector<uint8_t> data;
+    for (size_t s = 0; s < streams.size(); ++s) {
+        AVIStream& stream = streams[s];
+        bool audio = stream.isAudio();
+
+        for (size_t i = 0; i < stream.superIndex.size(); ++i) {
+            const AVISuperIndexEntry& location = stream.superIndex[i];
+            const size_t headerSize = sizeof(ChunkHeader) + sizeof(AVIStandardIndexHeader);
+            bool valid = location.size >= headerSize && location.offset + location.size <= fileSize;
+            if (valid) {
+                data.resize(location.size);
+                valid = readAt(location.offset, data.data(), data.size());
+            }
+
+            AVIStandardIndexHeader index;
+            if (valid) {
+                std::memcpy(&index, data.data() + sizeof(ChunkHeader), sizeof(index));
+                valid = index.longsPerEntry == 2 && index.indexType == 1 &&
+                        index.entriesInUse <= (data.size() - headerSize) / sizeof(AVIStandardIndexEntry);
+            }
+
+            for (uint32_t e = 0; valid && e < index.entriesInUse; ++e) {
+                AVIStandardIndexEntry entry;
+                std::memcpy(&entry, data.data() + headerSize + e * sizeof(entry), sizeof(entry));
+                uint32_t size = entry.size & 0x7FFFFFFFu; // Bit 31 marks non-key frames
+                uint64_t payload = index.baseOffset + entry.offset;
+                if (payload + size > fileSize) {
+                    valid = false;
+                } else if (size > 0 || !audio) {
+                    stream.appendChunk(index.chunkId, payload, size, (entry.size & 0x80000000u) == 0);
+                }
+            }
+
+            if (!valid) {
+                // Damaged index: fall back to idx1 or a scan
+                for (size_t t = 0; t < streams.size(); ++t) {
+                    streams[t].clearChunks();
+                }
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void AVIReader::reportIndex(const char* source) const {
+    std::string from = source[0] ? std::string(" (") + source + ")" : std::string();
+
+    std::vector<int> videoStreams = getVideoStreams();
+    if (videoStreams.size() > 1) {
+        for (size_t i = 0; i < videoStreams.size(); ++i) {
+            std::cout << "Indexed " << streams[videoStreams[i]].chunkOffsets.size()
+                      << " frames of stream " << videoStreams[i] << from << std::endl;
+        }
+    } else {
+        std::cout << "Indexed " << (videoStreams.empty() ? 0 : streams[videoStreams[0]].chunkOffsets.size())
+                  << " frames" << from << std::endl;
+    }
+}
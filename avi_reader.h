@@ -0,0 +1,382 @@
+/**
+ * @file avi_reader.h
+ * @brief Thread-safe random-access reader for AVI files
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the AVIReader class, which parses the AVI container,
+ * indexes the chunks of every stream in a single pass and then serves chunk
+ * payloads with positional reads. Because no shared seek position is
+ * involved, any number of threads can read frames from a single open reader
+ * at the same time.
+ */
+
+#ifndef AVI_READER_H
+#define AVI_READER_H
+
+#include "avi_format.h"
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/**
+ * @brief Headers and chunk index of one stream
+ *
+ * Built once by AVIReader::open() for every strl in the header list, in
+ * stream number order. For video streams each chunk is one frame; for audio
+ * streams the chunks form one continuous byte stream.
+ */
+struct AVIStream {
+    AVIStreamHeader header;              ///< Stream header (strh)
+    std::vector<uint8_t> format;         ///< Raw stream format (strf)
+    BitmapInfoHeader bitmapHeader;       ///< Bitmap format, valid for video streams
+    std::vector<RGBQuad> palette;        ///< Palette following the bitmap header, if any
+    BitmapColorMasks colorMasks;         ///< Color masks of BI_BITFIELDS video, zero otherwise
+    WaveFormatEx waveFormat;             ///< Sample format, valid for audio streams
+    std::vector<uint64_t> chunkOffsets;  ///< File offset of each chunk payload
+    std::vector<uint32_t> chunkSizes;    ///< Size of each chunk payload in bytes
+    std::vector<uint64_t> chunkStarts;   ///< Stream byte position of each chunk
+    std::vector<uint32_t> keyframes;     ///< Chunks the index flags as key frames; empty without an index
+    std::vector<AVISuperIndexEntry> superIndex; ///< OpenDML standard index locations (indx), if any
+    char chunkId[4];                     ///< ID of the stream's data chunks (e.g. "00dc"), zero if none
+    uint64_t totalBytes;                 ///< Sum of all chunk sizes
+    uint32_t maxChunkSize;               ///< Largest chunk payload in bytes
+
+    AVIStream();
+
+    /** @brief True for 'vids' streams with a bitmap format */
+    bool isVideo() const;
+
+    /** @brief True for 'auds' streams with a waveform format */
+    bool isAudio() const;
+
+    /** @brief Number of indexed chunks */
+    uint32_t getChunkCount() const { return static_cast<uint32_t>(chunkOffsets.size()); }
+
+    /**
+     * @brief Find the key frame to start decoding from
+     *
+     * @param chunk Chunk to be decoded
+     * @return Last key frame at or before the chunk, 0 if none is known
+     */
+    uint32_t findKeyframe(uint32_t chunk) const;
+
+    /**
+     * @brief Append a chunk to the index
+     *
+     * @param id Chunk ID as found in the file
+     * @param offset File offset of the payload
+     * @param size Payload size in bytes
+     * @param keyframe True if the index flags the chunk as a key frame
+     */
+    void appendChunk(const char* id, uint64_t offset, uint32_t size, bool keyframe);
+
+    /** @brief Discard the chunk index */
+    void clearChunks();
+};
+
+/**
+ * @brief Random-access AVI frame reader
+ *
+ * Opens an AVI file, parses its headers and indexes the chunks of all
+ * streams in one pass over the movie list. The frame accessors refer to the
+ * primary video stream (the first one with frames), while getStream()
+ * exposes every stream so that several video streams can be decoded side by
+ * side. After open() returns, the headers and the index are immutable, and all
+ * const member functions may be called concurrently from any number of
+ * threads. Frame data is fetched with pread() (ReadFile with an explicit
+ * offset on Windows), so reads never interfere with each other.
+ *
+ * Usage example:
+ * @code
+ * AVIReader reader;
+ * if (reader.open("video.avi")) {
+ *     std::vector<uint8_t> frame;
+ *     reader.readFrame(42, frame);   // safe from any thread
+ * }
+ * @endcode
+ */
+class AVIReader {
+private:
+#ifdef _WIN32
+    void* handle;                   ///< Win32 file handle
+#else
+    int fd;                         ///< POSIX file descriptor
+#endif
+    uint64_t fileSize;              ///< Size of the file in bytes
+
+    AVIMainHeader mainHeader;       ///< Main AVI header
+    std::vector<AVIStream> streams; ///< Headers and chunk index of every stream
+    AVIStream noStream;             ///< Empty stream returned for missing streams
+    int videoStream;                ///< Stream number of the primary video stream, -1 if none
+    int audioStream;                ///< Stream number of the playable audio stream, -1 if none
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * Initializes the reader in the closed state.
+     */
+    AVIReader();
+
+    /**
+     * @brief Destructor
+     *
+     * Closes the underlying file handle.
+     */
+    ~AVIReader();
+
+    /**
+     * @brief Open and index an AVI file
+     *
+     * Validates the RIFF header, parses the header list and indexes the
+     * chunks of every stream in the movie list. The OpenDML indexes or the
+     * idx1 index are used when present, so that opening a large file costs
+     * a few reads; files without a usable index are scanned chunk by chunk.
+     * OpenDML files continue their movie data in 'AVIX' lists after the
+     * first RIFF list; those are indexed as well.
+     *
+     * @param filepath Path to the AVI file
+     * @return true if the file was opened and has at least one video frame, false otherwise
+     */
+    bool open(const std::string& filepath);
+
+    /**
+     * @brief Close the file and discard the index
+     */
+    void close();
+
+    /**
+     * @brief Check whether a file is currently open
+     *
+     * @return true if open() succeeded and close() has not been called
+     */
+    bool isOpen() const;
+
+    /**
+     * @brief Read bytes at an absolute file offset
+     *
+     * Performs a positional read that does not touch any shared file
+     * position. Short reads are retried until the request is satisfied.
+     *
+     * @param offset Absolute byte offset in the file
+     * @param buffer Destination buffer of at least @p size bytes
+     * @param size Number of bytes to read
+     * @return true if all bytes were read, false on error or end of file
+     */
+    bool readAt(uint64_t offset, void* buffer, size_t size) const;
+
+    /**
+     * @brief Read a frame payload into a caller-owned vector
+     *
+     * The vector is resized to the frame size. Reusing the same vector
+     * across calls avoids reallocations. Safe to call concurrently as long
+     * as each thread uses its own buffer.
+     *
+     * @param frameIndex Index of the frame to read
+     * @param buffer Destination buffer
+     * @return true on success, false if the index is out of range or the read failed
+     */
+    bool readFrame(uint32_t frameIndex, std::vector<uint8_t>& buffer) const;
+
+    /**
+     * @brief Read a frame payload into a raw buffer
+     *
+     * @param frameIndex Index of the frame to read
+     * @param buffer Destination buffer
+     * @param bufferSize Capacity of @p buffer in bytes; must be at least getFrameSize()
+     * @return true on success, false if the index is out of range, the buffer is too small or the read failed
+     */
+    bool readFrame(uint32_t frameIndex, uint8_t* buffer, size_t bufferSize) const;
+
+    /**
+     * @brief Read a chunk payload of any stream into a raw buffer
+     *
+     * @param streamNumber Stream the chunk belongs to
+     * @param chunkIndex Index of the chunk within the stream
+     * @param buffer Destination buffer
+     * @param bufferSize Capacity of @p buffer in bytes
+     * @return true on success, false if the stream or index is out of range, the buffer is too small or the read failed
+     */
+    bool readChunk(int streamNumber, uint32_t chunkIndex, uint8_t* buffer, size_t bufferSize) const;
+
+    /**
+     * @brief Copy a byte range of the file into another file
+     *
+     * Uses copy_file_range() on Linux, so the data never passes through
+     * user space, and file systems such as XFS and btrfs share the blocks
+     * (reflink) instead of copying them where both ranges are
+     * block-aligned. Elsewhere, or across file systems that do not support
+     * it, falls back to positional reads and writes. Like readAt(), this
+     * does not touch any shared file position.
+     *
+     * @param offset Absolute offset of the range in this file
+     * @param size Number of bytes to copy
+     * @param outputFd File descriptor of the destination, opened for writing
+     * @param outputOffset Offset of the range in the destination
+     * @return true if all bytes were copied
+     */
+    bool copyTo(uint64_t offset, uint64_t size, int outputFd, uint64_t outputOffset) const;
+
+    /** @brief Main AVI header (avih) */
+    const AVIMainHeader& getMainHeader() const { return mainHeader; }
+
+    /** @brief Number of streams declared in the header list */
+    int getStreamCount() const { return static_cast<int>(streams.size()); }
+
+    /**
+     * @brief Headers and index of a stream
+     *
+     * @param streamNumber Stream number (position in the header list)
+     * @return The stream, or an empty stream if the number is out of range
+     */
+    const AVIStream& getStream(int streamNumber) const;
+
+    /** @brief Stream numbers of all video streams, in file order */
+    std::vector<int> getVideoStreams() const;
+
+    /** @brief Stream number of the primary video stream, -1 if none */
+    int getVideoStream() const { return videoStream; }
+
+    /** @brief Header of the primary video stream (strh) */
+    const AVIStreamHeader& getStreamHeader() const { return getStream(videoStream).header; }
+
+    /** @brief Bitmap format of the primary video stream (strf), as stored in the file */
+    const BitmapInfoHeader& getBitmapHeader() const { return getStream(videoStream).bitmapHeader; }
+
+    /** @brief Palette of the primary video stream, empty if none */
+    const std::vector<RGBQuad>& getPalette() const { return getStream(videoStream).palette; }
+
+    /** @brief Color masks of the primary video stream, zero unless BI_BITFIELDS */
+    const BitmapColorMasks& getColorMasks() const { return getStream(videoStream).colorMasks; }
+
+    /** @brief Number of indexed frames of the primary video stream */
+    uint32_t getFrameCount() const { return getStream(videoStream).getChunkCount(); }
+
+    /** @brief File offset of a frame payload (index must be valid) */
+    uint64_t getFrameOffset(uint32_t frameIndex) const { return getStream(videoStream).chunkOffsets[frameIndex]; }
+
+    /** @brief Size in bytes of a frame payload (index must be valid) */
+    uint32_t getFrameSize(uint32_t frameIndex) const { return getStream(videoStream).chunkSizes[frameIndex]; }
+
+    /** @brief Size of the largest frame payload, useful for sizing buffers */
+    uint32_t getMaxFrameSize() const { return getStream(videoStream).maxChunkSize; }
+
+    /** @brief Size of the file in bytes */
+    uint64_t getFileSize() const { return fileSize; }
+
+    /** @brief True if the file has an uncompressed (PCM or float) audio stream */
+    bool hasAudio() const { return audioStream >= 0; }
+
+    /** @brief Stream number of the playable audio stream, -1 if none */
+    int getAudioStream() const { return audioStream; }
+
+    /** @brief Header of the audio stream (strh) */
+    const AVIStreamHeader& getAudioStreamHeader() const { return getStream(audioStream).header; }
+
+    /** @brief Sample format of the audio stream (strf) */
+    const WaveFormatEx& getWaveFormat() const { return getStream(audioStream).waveFormat; }
+
+    /** @brief Total number of bytes of audio in the stream */
+    uint64_t getAudioByteCount() const { return getStream(audioStream).totalBytes; }
+
+    /**
+     * @brief Read a range of the audio stream
+     *
+     * Treats the audio chunks as one continuous byte stream and copies the
+     * requested range, crossing chunk boundaries as needed. Like the frame
+     * reads, this is a positional read and safe to call from any thread.
+     *
+     * @param position Byte position in the audio stream
+     * @param buffer Destination buffer of at least @p size bytes
+     * @param size Number of bytes to read
+     * @return Number of bytes read; less than @p size at the end of the stream or on error
+     */
+    size_t readAudio(uint64_t position, uint8_t* buffer, size_t size) const;
+
+private:
+    AVIReader(const AVIReader&);
+    AVIReader& operator=(const AVIReader&);
+
+    /**
+     * @brief Parse AVI file chunks
+     *
+     * Walks the top-level chunks of the RIFF file, parsing headers and
+     * finding the movie data section.
+     *
+     * @return true if parsing successful, false otherwise
+     */
+    bool parseAVIChunks();
+
+    /**
+     * @brief Parse header list chunk
+     *
+     * Processes the header list containing main header and stream headers.
+     *
+     * @param offset File offset of the first sub-chunk
+     * @param size Size of the header list
+     */
+    void parseHeaderList(uint64_t offset, uint32_t size);
+
+    /**
+     * @brief Parse stream list chunk
+     *
+     * Reads the stream header and format of one stream and decodes the
+     * format for video and audio streams.
+     *
+     * @param offset File offset of the first sub-chunk
+     * @param size Size of the stream list
+     * @param stream Stream to fill in
+     */
+    void parseStreamList(uint64_t offset, uint32_t size, AVIStream& stream);
+
+    /**
+     * @brief Index the chunks of all streams
+     *
+     * Scans the movie data section once, descending into 'rec ' lists, and
+     * appends the file offset and size of each data chunk to the table of
+     * the stream named by its two-digit prefix.
+     *
+     * @param offset File offset of the first chunk in the movie list
+     * @param movieSize Size of the movie data section
+     */
+    void indexFrames(uint64_t offset, uint32_t movieSize);
+
+    /**
+     * @brief Build the chunk tables from the legacy index
+     *
+     * Reads the whole idx1 chunk with one positional read instead of
+     * visiting every chunk header of the movie list. Offsets may be
+     * relative to the movie list or absolute; the first entry decides.
+     * Nothing is indexed if the index does not match the file.
+     *
+     * @param offset File offset of the idx1 data
+     * @param size Size of the idx1 chunk
+     * @param movieList File offset of the 'movi' list type
+     * @param movieSize Size of the movie data section
+     * @return true if the chunk tables were built from the index
+     */
+    bool loadIndex(uint64_t offset, uint32_t size, uint64_t movieList, uint32_t movieSize);
+
+    /**
+     * @brief Build the chunk tables from the OpenDML indexes
+     *
+     * Reads the ix## standard indexes listed by the indx super index of
+     * each stream, one read per index. Used only if every audio and video
+     * stream has a super index; nothing is indexed if an index does not
+     * match the file.
+     *
+     * @return true if the chunk tables were built from the indexes
+     */
+    bool loadOpenDMLIndex();
+
+    /**
+     * @brief Print the number of frames indexed per video stream
+     *
+     * @param source How the index was obtained, e.g. "idx1"; empty for a scan
+     */
+    void reportIndex(const char* source) const;
+};
+
+#endif // AVI_READER_H
@@ -0,0 +1,675 @@
+/**
+ * @file avi_writer.cpp
+ * @brief Implementation of the AVIWriter class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "avi_writer.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    /**
+     * @brief Size of an output buffer
+     *
+     * Large enough that every write is a long sequential transfer.
+     */
+    const size_t kBufferBytes = 16u << 20;
+
+    /**
+     * @brief Number of output buffers
+     *
+     * One is filled while the others wait for or are being written.
+     */
+    const size_t kBufferCount = 4;
+
+    /**
+     * @brief Largest size of a RIFF list
+     *
+     * Players that only know AVI 1.0 read the first gigabyte; the OpenDML
+     * indexes use 32-bit offsets within a list.
+     */
+    const uint64_t kListBytes = 1u << 30;
+
+    /**
+     * @brief Entries reserved in each super index
+     *
+     * One per RIFF list, so files of up to 256 GB can be written.
+     */
+    const size_t kSuperIndexEntries = 256;
+
+    /**
+     * @brief Smallest run that is moved to a block-aligned position
+     */
+    const uint64_t kAlignMinBytes = 64u << 10;
+
+    /**
+     * @brief AVIF_HASINDEX: the file has an idx1 index
+     */
+    const uint32_t kHasIndex = 0x10;
+
+    /**
+     * @brief AVIIF_KEYFRAME: the idx1 flag of chunks that decode on their own
+     */
+    const uint32_t kKeyFrame = 0x10;
+
+    void appendBytes(std::vector<uint8_t>& out, const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        out.insert(out.end(), bytes, bytes + size);
+    }
+
+    void appendU32(std::vector<uint8_t>& out, uint32_t value) {
+        appendBytes(out, &value, sizeof(value));
+    }
+
+    /**
+     * @brief Start a chunk; returns the position of its size field
+     */
+    size_t openChunk(std::vector<uint8_t>& out, const char* fourCC) {
+        appendBytes(out, fourCC, 4);
+        appendU32(out, 0);
+        return out.size() - 4;
+    }
+
+    /**
+     * @brief Start a list; returns the position of its size field
+     */
+    size_t openList(std::vector<uint8_t>& out, const char* listType) {
+        size_t sizeField = openChunk(out, "LIST");
+        appendBytes(out, listType, 4);
+        return sizeField;
+    }
+
+    /**
+     * @brief Fill in the size of a chunk or list and pad it to an even length
+     */
+    void closeChunk(std::vector<uint8_t>& out, size_t sizeField) {
+        uint32_t size = static_cast<uint32_t>(out.size() - sizeField - 4);
+        std::memcpy(out.data() + sizeField, &size, sizeof(size));
+        if (size & 1) out.push_back(0);
+    }
+
+    /**
+     * @brief Stream length in strh units: frames, or samples for fixed-size audio samples
+     */
+    uint32_t streamLength(const AVIStreamHeader& header, uint32_t chunks, uint64_t bytes) {
+        if (strncmp(header.fccType, "vids", 4) != 0 && header.sampleSize > 0) {
+            return static_cast<uint32_t>(bytes / header.sampleSize);
+        }
+        return chunks;
+    }
+}
+
+AVIWriter::AVIWriter()
+    : fd(-1), position(0), listStart(0), movieList(0), listCount(0),
+      firstRiffSize(0), firstMovieSize(0), blockSize(4096), failed(false),
+      current(nullptr), flushing(false), stopping(false), stalls(0) {
+    std::memset(&mainHeader, 0, sizeof(mainHeader));
+}
+
+AVIWriter::~AVIWriter() {
+    close();
+}
+
+void AVIWriter::setMainHeader(const AVIMainHeader& header) {
+    mainHeader = header;
+}
+
+int AVIWriter::addStream(const AVIStreamHeader& header, const std::vector<uint8_t>& format) {
+    int number = static_cast<int>(streams.size());
+    streams.push_back(Stream());
+    Stream& stream = streams.back();
+    stream.header = header;
+    stream.format = format;
+
+    // Uncompressed video is stored in 'db' chunks, everything else by type
+    const char* type = "dc";
+    if (strncmp(header.fccType, "auds", 4) == 0) {
+        type = "wb";
+    } else if (strncmp(header.fccType, "vids", 4) == 0 && format.size() >= sizeof(BitmapInfoHeader)) {
+        BitmapInfoHeader bitmap;
+        std::memcpy(&bitmap, format.data(), sizeof(bitmap));
+        if (bitmap.compression == 0) type = "db";
+    }
+    stream.chunkId[0] = static_cast<char>('0' + number / 10 % 10);
+    stream.chunkId[1] = static_cast<char>('0' + number % 10);
+    std::memcpy(stream.chunkId + 2, type, 2);
+    return number;
+}
+
+bool AVIWriter::open(const std::string& filepath) {
+    close();
+    path = filepath;
+
+#ifdef _WIN32
+    fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+    if (fd < 0) {
+        std::cerr << "Error: Cannot create file " << path << std::endl;
+        return false;
+    }
+
+    blockSize = 4096;
+#ifndef _WIN32
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_blksize >= 512 && info.st_blksize <= (1 << 20) &&
+        (info.st_blksize & (info.st_blksize - 1)) == 0) {
+        blockSize = static_cast<uint32_t>(info.st_blksize);
+    }
+#endif
+
+    for (size_t s = 0; s < streams.size(); ++s) {
+        Stream& stream = streams[s];
+        stream.chunks = 0;
+        stream.firstListChunks = 0;
+        stream.bytes = 0;
+        stream.maxChunkSize = 0;
+        stream.listIndex.clear();
+        stream.listBytes = 0;
+        stream.superIndex.clear();
+    }
+    legacyIndex.clear();
+    extensionLists.clear();
+    failed = false;
+    firstRiffSize = 0;
+    firstMovieSize = 0;
+    stalls = 0;
+
+    // The headers are written on close, into the space reserved here
+    std::vector<uint8_t> headers;
+    buildHeaders(headers);
+    position = headers.size();
+    listStart = 0;
+    movieList = position - 4;
+    listCount = 1;
+
+    stopping = false;
+    flushThread = std::thread(&AVIWriter::flushLoop, this);
+    return true;
+}
+
+uint8_t* AVIWriter::reserveChunk(int streamNumber, uint32_t size) {
+    if (fd < 0 || failed || streamNumber < 0 || streamNumber >= static_cast<int>(streams.size())) {
+        return nullptr;
+    }
+
+    uint64_t length = sizeof(ChunkHeader) + size + (size & 1);
+    if (position > movieList + 4 && position - listStart + length > kListBytes) {
+        endList();
+        beginList();
+    }
+
+    uint8_t* chunk = reserve(static_cast<size_t>(length));
+    ChunkHeader header;
+    std::memcpy(header.fourCC, streams[streamNumber].chunkId, 4);
+    header.size = size;
+    std::memcpy(chunk, &header, sizeof(header));
+    if (size & 1) chunk[sizeof(header) + size] = 0;
+
+    // Written chunks are whole frames or audio blocks
+    addIndexEntry(streamNumber, position - length + sizeof(header), size, true);
+    return chunk + sizeof(header);
+}
+
+bool AVIWriter::writeChunk(int streamNumber, const void* data, uint32_t size) {
+    uint8_t* payload = reserveChunk(streamNumber, size);
+    if (!payload) return false;
+    std::memcpy(payload, data, size);
+    return !failed;
+}
+
+bool AVIWriter::copyChunks(const AVIReader& source, const std::vector<AVIChunkRef>& chunks) {
+    if (fd < 0 || failed) return false;
+
+    // Copied chunks keep the IDs they have in the source
+    for (size_t s = 0; s < streams.size(); ++s) {
+        const AVIStream& from = source.getStream(static_cast<int>(s));
+        if (from.chunkId[0] != 0) std::memcpy(streams[s].chunkId, from.chunkId, 4);
+    }
+
+    size_t first = 0;
+    while (first < chunks.size()) {
+        if (chunks[first].stream < 0 || chunks[first].stream >= static_cast<int>(streams.size())) {
+            std::cerr << "Error: Chunk of unknown stream " << chunks[first].stream << std::endl;
+            return false;
+        }
+
+        uint64_t start = chunks[first].offset - sizeof(ChunkHeader);
+        uint64_t end = chunks[first].offset + chunks[first].size + (chunks[first].size & 1);
+        if (position > movieList + 4 && position - listStart + (end - start) > kListBytes) {
+            endList();
+            beginList();
+        }
+
+        // Extend the run over the chunks that follow each other in the
+        // source, as far as the current RIFF list allows
+        size_t next = first + 1;
+        while (next < chunks.size()) {
+            const AVIChunkRef& chunk = chunks[next];
+            uint64_t chunkEnd = chunk.offset + chunk.size + (chunk.size & 1);
+            if (chunk.offset - sizeof(ChunkHeader) != end ||
+                chunk.stream < 0 || chunk.stream >= static_cast<int>(streams.size()) ||
+                position - listStart + (chunkEnd - start) > kListBytes) {
+                break;
+            }
+            end = chunkEnd;
+            next++;
+        }
+        uint64_t length = end - start;
+
+        if (length >= kAlignMinBytes) {
+            // A JUNK chunk moves the run to the same offset within a block
+            // as in the source, so whole blocks line up on both sides
+            uint64_t junk = (start - position - sizeof(ChunkHeader)) & (blockSize - 1);
+            ChunkHeader header;
+            std::memcpy(header.fourCC, "JUNK", 4);
+            header.size = static_cast<uint32_t>(junk);
+            append(&header, sizeof(header));
+            position += junk;
+        }
+
+        // Copied past the buffered data, so the flush thread and the copy
+        // never touch the same bytes
+
+        // The block-aligned middle can be shared; the ends are copied. A
+        // pad byte missing at the end of a truncated source is left zero.
+        uint64_t available = std::min(end, source.getFileSize()) - start;
+        uint64_t head = std::min(available, (blockSize - start % blockSize) % blockSize);
+        uint64_t middle = (available - head) / blockSize * blockSize;
+        uint64_t tail = available - head - middle;
+        if (!source.copyTo(start, head, fd, position) ||
+            !source.copyTo(start + head, middle, fd, position + head) ||
+            !source.copyTo(start + head + middle, tail, fd, position + head + middle)) {
+            std::cerr << "Error: Failed to copy chunks to " << path << std::endl;
+            failed = true;
+            return false;
+        }
+
+        for (size_t i = first; i < next; ++i) {
+            addIndexEntry(chunks[i].stream, position + (chunks[i].offset - start), chunks[i].size, chunks[i].keyframe);
+        }
+        position += length;
+        first = next;
+    }
+
+    return !failed;
+}
+
+bool AVIWriter::close() {
+    if (fd < 0) return true;
+
+    endList();
+    drain();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work.notify_all();
+    flushThread.join();
+
+    // The list sizes of the 'AVIX' lists are known only now
+    for (size_t i = 0; i < extensionLists.size(); ++i) {
+        uint8_t header[24];
+        std::memcpy(header, "RIFF", 4);
+        std::memcpy(header + 4, &extensionLists[i].riffSize, 4);
+        std::memcpy(header + 8, "AVIXLIST", 8);
+        std::memcpy(header + 16, &extensionLists[i].movieSize, 4);
+        std::memcpy(header + 20, "movi", 4);
+        writeAt(extensionLists[i].offset, header, sizeof(header));
+    }
+
+    // One write back to the start puts the final headers in place
+    std::vector<uint8_t> headers;
+    buildHeaders(headers);
+    writeAt(0, headers.data(), headers.size());
+
+    bool success = !failed;
+#ifdef _WIN32
+    if (_close(fd) != 0) success = false;
+#else
+    if (::close(fd) != 0) success = false;
+#endif
+    fd = -1;
+
+    current = nullptr;
+    pending.clear();
+    spare.clear();
+    buffers.clear();
+
+    if (!success) {
+        std::cerr << "Error: Failed to write " << path << std::endl;
+    }
+    return success;
+}
+
+void AVIWriter::beginList() {
+    // 'RIFF' size 'AVIX' 'LIST' size 'movi'; the sizes are filled in by endList()
+    listStart = position;
+    movieList = position + 20;
+    std::memset(reserve(24), 0, 24);
+    listCount++;
+}
+
+void AVIWriter::endList() {
+    for (size_t s = 0; s < streams.size(); ++s) {
+        Stream& stream = streams[s];
+        if (stream.listIndex.empty()) continue;
+        if (stream.superIndex.size() >= kSuperIndexEntries) {
+            std::cerr << "Error: " << path << " is larger than the OpenDML index can describe" << std::endl;
+            failed = true;
+            return;
+        }
+
+        std::vector<uint8_t> chunk;
+        char name[4] = { 'i', 'x', static_cast<char>('0' + s / 10 % 10), static_cast<char>('0' + s % 10) };
+        size_t sizeField = openChunk(chunk, name);
+
+        AVIStandardIndexHeader index;
+        std::memset(&index, 0, sizeof(index));
+        index.longsPerEntry = 2;
+        index.indexType = 1;
+        index.entriesInUse = static_cast<uint32_t>(stream.listIndex.size());
+        std::memcpy(index.chunkId, stream.chunkId, 4);
+        index.baseOffset = listStart;
+        appendBytes(chunk, &index, sizeof(index));
+        appendBytes(chunk, stream.listIndex.data(), stream.listIndex.size() * sizeof(AVIStandardIndexEntry));
+        closeChunk(chunk, sizeField);
+
+        AVISuperIndexEntry entry;
+        entry.offset = position;
+        entry.size = static_cast<uint32_t>(chunk.size());
+        entry.duration = streamLength(stream.header, index.entriesInUse, stream.listBytes);
+        stream.superIndex.push_back(entry);
+
+        append(chunk.data(), chunk.size());
+        stream.listIndex.clear();
+        stream.listBytes = 0;
+    }
+
+    uint32_t movieSize = static_cast<uint32_t>(position - movieList);
+    if (listCount == 1) {
+        // The legacy index follows the first movie list
+        firstMovieSize = movieSize;
+        ChunkHeader header;
+        std::memcpy(header.fourCC, "idx1", 4);
+        header.size = static_cast<uint32_t>(legacyIndex.size() * sizeof(AVIIndexEntry));
+        append(&header, sizeof(header));
+        append(legacyIndex.data(), header.size);
+        firstRiffSize = static_cast<uint32_t>(position - 8);
+        std::vector<AVIIndexEntry>().swap(legacyIndex);
+    } else {
+        ListHeader header;
+        header.offset = listStart;
+        header.riffSize = static_cast<uint32_t>(position - listStart - 8);
+        header.movieSize = movieSize;
+        extensionLists.push_back(header);
+    }
+}
+
+void AVIWriter::addIndexEntry(int streamNumber, uint64_t payload, uint32_t size, bool keyframe) {
+    Stream& stream = streams[streamNumber];
+
+    if (listCount == 1) {
+        AVIIndexEntry entry;
+        std::memcpy(entry.chunkId, stream.chunkId, 4);
+        entry.flags = keyframe ? kKeyFrame : 0;
+        entry.offset = static_cast<uint32_t>(payload - sizeof(ChunkHeader) - movieList);
+        entry.size = size;
+        legacyIndex.push_back(entry);
+        stream.firstListChunks++;
+    }
+
+    // Bit 31 of an ix## size marks a delta frame
+    AVIStandardIndexEntry entry;
+    entry.offset = static_cast<uint32_t>(payload - listStart);
+    entry.size = keyframe ? size : size | 0x80000000u;
+    stream.listIndex.push_back(entry);
+    stream.listBytes += size;
+
+    stream.chunks++;
+    stream.bytes += size;
+    if (size > stream.maxChunkSize) stream.maxChunkSize = size;
+}
+
+uint8_t* AVIWriter::reserve(size_t size) {
+    // Data copied directly into the file leaves a gap; continue after it
+    if (current && current->offset + current->used != position) submit();
+
+    if (!current || current->used + size > current->capacity) {
+        // The next buffer starts at the block boundary below the current
+        // end and takes over the partial block, so that every write covers
+        // whole blocks except at the very end of the file
+        Buffer* previous = current;
+        size_t carry = 0;
+        if (previous) {
+            carry = static_cast<size_t>((previous->offset + previous->used) % blockSize);
+            if (carry >= previous->used) carry = 0;
+        }
+
+        Buffer* next = acquireBuffer(carry + size);
+        next->offset = position - carry;
+        if (carry > 0) std::memcpy(next->data, previous->data + previous->used - carry, carry);
+        next->used = carry;
+        submit();
+        current = next;
+    }
+
+    uint8_t* space = current->data + current->used;
+    current->used += size;
+    position += size;
+    return space;
+}
+
+void AVIWriter::append(const void* data, size_t size) {
+    if (size > 0) std::memcpy(reserve(size), data, size);
+}
+
+AVIWriter::Buffer* AVIWriter::acquireBuffer(size_t size) {
+    Buffer* buffer = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (spare.empty() && buffers.size() >= kBufferCount) {
+            // Every buffer is queued: the disk is slower than the caller
+            stalls++;
+            done.wait(lock, [this] { return !spare.empty(); });
+        }
+        if (!spare.empty()) {
+            buffer = spare.back();
+            spare.pop_back();
+        }
+    }
+
+    if (!buffer) {
+        buffers.push_back(std::unique_ptr<Buffer>(new Buffer()));
+        buffer = buffers.back().get();
+        buffer->data = nullptr;
+        buffer->capacity = 0;
+    }
+    if (buffer->capacity < size) {
+        size_t capacity = std::max(kBufferBytes, (size + blockSize - 1) / blockSize * blockSize);
+        std::vector<uint8_t>(capacity + blockSize).swap(buffer->storage);
+        uintptr_t address = reinterpret_cast<uintptr_t>(buffer->storage.data());
+        buffer->data = buffer->storage.data() + (blockSize - address % blockSize) % blockSize;
+        buffer->capacity = capacity;
+    }
+    buffer->used = 0;
+    return buffer;
+}
+
+void AVIWriter::submit() {
+    if (!current) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (current->used > 0) {
+            pending.push_back(current);
+        } else {
+            spare.push_back(current);
+        }
+    }
+    work.notify_one();
+    current = nullptr;
+}
+
+void AVIWriter::drain() {
+    submit();
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending.empty() && !flushing; });
+}
+
+void AVIWriter::flushLoop() {
+    uint64_t previousOffset = 0;
+    uint64_t previousSize = 0;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        work.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (pending.empty()) break;
+        Buffer* buffer = pending.front();
+        pending.pop_front();
+        flushing = true;
+        lock.unlock();
+
+        if (!failed) writeAt(buffer->offset, buffer->data, buffer->used);
+
+#ifdef __linux__
+        // Start writeback of this buffer now, then wait for the previous
+        // one and drop its pages: the page cache never holds more than two
+        // buffers of dirty data, so the kernel has no backlog to flush in
+        // one long stall, and the written file does not push out the
+        // pages of the files being read
+        sync_file_range(fd, static_cast<off_t>(buffer->offset), static_cast<off_t>(buffer->used),
+                        SYNC_FILE_RANGE_WRITE);
+        if (previousSize > 0) {
+            sync_file_range(fd, static_cast<off_t>(previousOffset), static_cast<off_t>(previousSize),
+                            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+            posix_fadvise(fd, static_cast<off_t>(previousOffset), static_cast<off_t>(previousSize),
+                          POSIX_FADV_DONTNEED);
+        }
+#endif
+        previousOffset = buffer->offset;
+        previousSize = buffer->used;
+
+        lock.lock();
+        buffer->used = 0;
+        spare.push_back(buffer);
+        flushing = false;
+        done.notify_all();
+    }
+}
+
+void AVIWriter::buildHeaders(std::vector<uint8_t>& out) const {
+    out.clear();
+    appendBytes(out, "RIFF", 4);
+    appendU32(out, firstRiffSize);
+    appendBytes(out, "AVI ", 4);
+
+    // Frame counts come from the first video stream
+    const Stream* video = nullptr;
+    uint32_t largestChunk = 0;
+    for (size_t s = 0; s < streams.size(); ++s) {
+        if (!video && strncmp(streams[s].header.fccType, "vids", 4) == 0) video = &streams[s];
+        largestChunk = std::max(largestChunk, streams[s].maxChunkSize);
+    }
+
+    size_t headerList = openList(out, "hdrl");
+
+    AVIMainHeader main = mainHeader;
+    main.flags |= kHasIndex;
+    main.totalFrames = video ? video->firstListChunks : 0;
+    main.streams = static_cast<uint32_t>(streams.size());
+    main.suggestedBufferSize = largestChunk;
+    size_t chunk = openChunk(out, "avih");
+    appendBytes(out, &main, sizeof(main));
+    closeChunk(out, chunk);
+
+    for (size_t s = 0; s < streams.size(); ++s) {
+        const Stream& stream = streams[s];
+        size_t streamList = openList(out, "strl");
+
+        AVIStreamHeader header = stream.header;
+        header.length = streamLength(header, stream.chunks, stream.bytes);
+        header.suggestedBufferSize = stream.maxChunkSize;
+        chunk = openChunk(out, "strh");
+        appendBytes(out, &header, sizeof(header));
+        closeChunk(out, chunk);
+
+        chunk = openChunk(out, "strf");
+        appendBytes(out, stream.format.data(), stream.format.size());
+        closeChunk(out, chunk);
+
+        // Super index with room for every RIFF list the file may get
+        AVISuperIndexHeader index;
+        std::memset(&index, 0, sizeof(index));
+        index.longsPerEntry = 4;
+        index.entriesInUse = static_cast<uint32_t>(stream.superIndex.size());
+        std::memcpy(index.chunkId, stream.chunkId, 4);
+        chunk = openChunk(out, "indx");
+        appendBytes(out, &index, sizeof(index));
+        appendBytes(out, stream.superIndex.data(), stream.superIndex.size() * sizeof(AVISuperIndexEntry));
+        out.resize(out.size() + (kSuperIndexEntries - stream.superIndex.size()) * sizeof(AVISuperIndexEntry), 0);
+        closeChunk(out, chunk);
+
+        closeChunk(out, streamList);
+    }
+
+    size_t extendedList = openList(out, "odml");
+    AVIExtendedHeader extended;
+    std::memset(&extended, 0, sizeof(extended));
+    extended.totalFrames = video ? video->chunks : 0;
+    chunk = openChunk(out, "dmlh");
+    appendBytes(out, &extended, sizeof(extended));
+    closeChunk(out, chunk);
+    closeChunk(out, extendedList);
+
+    closeChunk(out, headerList);
+
+    // Pad so that the movie data starts on a block boundary
+    size_t used = out.size() + sizeof(ChunkHeader) + 12;
+    size_t junk = (blockSize - used % blockSize) % blockSize;
+    chunk = openChunk(out, "JUNK");
+    out.resize(out.size() + junk, 0);
+    closeChunk(out, chunk);
+
+    appendBytes(out, "LIST", 4);
+    appendU32(out, firstMovieSize);
+    appendBytes(out, "movi", 4);
+}
+
+bool AVIWriter::writeAt(uint64_t offset, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+#ifdef _WIN32
+        if (_lseeki64(fd, static_cast<__int64>(offset), SEEK_SET) < 0) {
+            failed = true;
+            return false;
+        }
+        int written = _write(fd, bytes, static_cast<unsigned>(std::min(size, static_cast<size_t>(1u << 30))));
+#else
+        ssize_t written = pwrite(fd, bytes, size, static_cast<off_t>(offset));
+#endif
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            failed = true;
+            return false;
+        }
+        bytes += written;
+        offset += static_cast<uint64_t>(written);
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
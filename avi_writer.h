@@ -0,0 +1,310 @@
+/**
+ * @file avi_writer.h
+ * @brief AVI file writer with idx1 and OpenDML indexes
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the AVIWriter class, which lays out an AVI file
+ * (headers, movie lists and indexes) and fills it with chunks written by
+ * the caller or copied from an existing file.
+ */
+
+#ifndef AVI_WRITER_H
+#define AVI_WRITER_H
+
+#include "avi_format.h"
+#include "avi_reader.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A chunk of a source file to be copied into the output
+ */
+struct AVIChunkRef {
+    int stream;                     ///< Stream number, the same in the source and the output
+    uint64_t offset;                ///< File offset of the payload in the source
+    uint32_t size;                  ///< Payload size in bytes
+    bool keyframe;                  ///< True if the chunk is indexed as a key frame
+};
+
+/**
+ * @brief AVI file writer
+ *
+ * Writes AVI files that play in any player: the first RIFF list carries
+ * the headers and an idx1 index, and data past 1 GB continues in OpenDML
+ * 'AVIX' lists. Every RIFF list ends its movie list with an ix## standard
+ * index per stream, and the indx super index in each stream header lists
+ * them. Index entries are collected while chunks are added; the headers
+ * are written once, when the file is closed, into space reserved at the
+ * start of the file.
+ *
+ * Written chunks are assembled in a few large, block-aligned buffers. A
+ * full buffer is handed to a background thread that writes it with one
+ * positional write at a block-aligned offset, while the caller fills the
+ * next one; only the partial block at the end of a buffer is carried over.
+ * The caller waits only when every buffer is queued, i.e. when the disk
+ * cannot keep up. On Linux the flush thread starts writeback of each buffer
+ * right away and drops the pages of the previous one once they are on
+ * disk, so dirty pages never pile up into a long stall.
+ *
+ * Chunks can also be copied from a source file with AVIReader::copyTo(),
+ * chunk headers included, so they keep their IDs and stream numbers: the
+ * output must then declare the same streams as the source. Chunks that
+ * follow each other in the source are copied as one run, shifted to the
+ * same offset within a file system block as in the source so that XFS and
+ * btrfs can share the blocks instead of copying them.
+ *
+ * Usage example:
+ * @code
+ * AVIWriter writer;
+ * writer.setMainHeader(mainHeader);
+ * int video = writer.addStream(videoHeader, bitmapFormat);
+ * if (writer.open("out.avi")) {
+ *     for (...) {
+ *         uint8_t* frame = writer.reserveChunk(video, frameSize);
+ *         render(frame);               // fill in place, no extra copy
+ *     }
+ *     writer.close();
+ * }
+ * @endcode
+ */
+class AVIWriter {
+private:
+    /**
+     * @brief Headers and index of one output stream
+     */
+    struct Stream {
+        AVIStreamHeader header;                             ///< Stream header, length filled in on close
+        std::vector<uint8_t> format;                        ///< Stream format (strf)
+        char chunkId[4];                                    ///< ID of the stream's data chunks
+        uint32_t chunks;                                    ///< Chunks written
+        uint32_t firstListChunks;                           ///< Chunks in the first RIFF list
+        uint64_t bytes;                                     ///< Payload bytes written
+        uint32_t maxChunkSize;                              ///< Largest payload
+        std::vector<AVIStandardIndexEntry> listIndex;       ///< Entries of the current RIFF list (ix##)
+        uint64_t listBytes;                                 ///< Payload bytes in the current RIFF list
+        std::vector<AVISuperIndexEntry> superIndex;         ///< Standard indexes written so far (indx)
+    };
+
+    /**
+     * @brief Output buffer, written by the flush thread
+     */
+    struct Buffer {
+        std::vector<uint8_t> storage;    ///< Backing memory, over-allocated for alignment
+        uint8_t* data;                   ///< Block-aligned start of the buffer
+        size_t capacity;                 ///< Usable bytes at data
+        size_t used;                     ///< Bytes filled
+        uint64_t offset;                 ///< File offset of the first byte
+    };
+
+    /**
+     * @brief Header of an 'AVIX' RIFF list, written on close
+     */
+    struct ListHeader {
+        uint64_t offset;                 ///< File offset of the list
+        uint32_t riffSize;               ///< Size of the RIFF list
+        uint32_t movieSize;              ///< Size of its movie list
+    };
+
+    int fd;                              ///< Output file descriptor, -1 if closed
+    std::string path;                    ///< Output path
+    AVIMainHeader mainHeader;            ///< Main header, counts filled in on close
+    std::vector<Stream> streams;         ///< Output streams
+    std::vector<AVIIndexEntry> legacyIndex; ///< idx1 entries of the first RIFF list
+    uint64_t position;                   ///< End of the data written so far
+    uint64_t listStart;                  ///< File offset of the current RIFF list
+    uint64_t movieList;                  ///< File offset of the current 'movi' list type
+    uint32_t listCount;                  ///< RIFF lists started
+    uint32_t firstRiffSize;              ///< Size of the first RIFF list, once closed
+    uint32_t firstMovieSize;             ///< Size of the first movie list, once closed
+    uint32_t blockSize;                  ///< File system block size of the output
+    std::vector<ListHeader> extensionLists; ///< Headers of the 'AVIX' lists written so far
+    std::atomic<bool> failed;            ///< Set when a write fails
+
+    std::vector<std::unique_ptr<Buffer> > buffers; ///< All buffers, allocated on demand
+    Buffer* current;                     ///< Buffer being filled, nullptr if none
+    std::deque<Buffer*> pending;         ///< Filled buffers waiting to be written
+    std::vector<Buffer*> spare;          ///< Buffers ready to be filled
+    bool flushing;                       ///< True while the flush thread writes a buffer
+    bool stopping;                       ///< Tells the flush thread to exit
+    uint32_t stalls;                     ///< Times the caller waited for a free buffer
+    std::thread flushThread;             ///< Writes filled buffers
+    std::mutex mutex;                    ///< Guards pending, spare, flushing and stopping
+    std::condition_variable work;        ///< Signals a filled buffer or shutdown
+    std::condition_variable done;        ///< Signals a written buffer
+
+public:
+    /**
+     * @brief Constructor
+     */
+    AVIWriter();
+
+    /**
+     * @brief Destructor
+     *
+     * Closes the file if it is still open.
+     */
+    ~AVIWriter();
+
+    /**
+     * @brief Set the main header
+     *
+     * Frame count, stream count and buffer size are filled in on close.
+     *
+     * @param header Main header, usually taken from the source file
+     */
+    void setMainHeader(const AVIMainHeader& header);
+
+    /**
+     * @brief Declare a stream
+     *
+     * Must be called before open(). The length and the suggested buffer
+     * size of the stream header are filled in on close.
+     *
+     * @param header Stream header
+     * @param format Stream format (strf), e.g. a BitmapInfoHeader and palette
+     * @return Stream number
+     */
+    int addStream(const AVIStreamHeader& header, const std::vector<uint8_t>& format);
+
+    /**
+     * @brief Create the output file
+     *
+     * @param filepath Output path; an existing file is replaced
+     * @return true on success
+     */
+    bool open(const std::string& filepath);
+
+    /**
+     * @brief Append a chunk and return space for its payload
+     *
+     * The chunk is indexed right away. The space lies in an output buffer
+     * and stays valid until the next call on the writer, so the payload can
+     * be produced in place instead of being copied in.
+     *
+     * @param streamNumber Stream of the chunk
+     * @param size Payload size in bytes
+     * @return Space for the payload, or nullptr if the stream is unknown, the file is not open or a write failed
+     */
+    uint8_t* reserveChunk(int streamNumber, uint32_t size);
+
+    /**
+     * @brief Append a chunk
+     *
+     * @param streamNumber Stream of the chunk
+     * @param data Payload
+     * @param size Payload size in bytes
+     * @return true unless the file is not open or an earlier write failed
+     */
+    bool writeChunk(int streamNumber, const void* data, uint32_t size);
+
+    /**
+     * @brief Copy chunks of a source file to the end of the output
+     *
+     * @param source Open source file with the same streams as the output
+     * @param chunks Chunks to copy, in file order
+     * @return true on success
+     */
+    bool copyChunks(const AVIReader& source, const std::vector<AVIChunkRef>& chunks);
+
+    /**
+     * @brief Write the indexes and headers and close the file
+     *
+     * @return true if the file is complete
+     */
+    bool close();
+
+    /** @brief Size of the output so far in bytes */
+    uint64_t getFileSize() const { return position; }
+
+    /** @brief Times a caller had to wait for the disk */
+    uint32_t getStallCount() const { return stalls; }
+
+private:
+    AVIWriter(const AVIWriter&);
+    AVIWriter& operator=(const AVIWriter&);
+
+    /**
+     * @brief Start a new RIFF list with an empty movie list
+     */
+    void beginList();
+
+    /**
+     * @brief Finish the current RIFF list
+     *
+     * Writes the ix## index of each stream at the end of the movie list,
+     * and idx1 after the first one.
+     */
+    void endList();
+
+    /**
+     * @brief Record a chunk in the indexes
+     *
+     * @param streamNumber Stream of the chunk
+     * @param payload File offset of the payload in the output
+     * @param size Payload size in bytes
+     * @param keyframe True to flag the chunk as a key frame
+     */
+    void addIndexEntry(int streamNumber, uint64_t payload, uint32_t size, bool keyframe);
+
+    /**
+     * @brief Get contiguous space at the end of the output
+     *
+     * @param size Bytes needed
+     * @return Space in the current buffer
+     */
+    uint8_t* reserve(size_t size);
+
+    /**
+     * @brief Append bytes to the output
+     */
+    void append(const void* data, size_t size);
+
+    /**
+     * @brief Take a free buffer, allocating or waiting for one
+     *
+     * @param size Bytes the buffer must hold
+     */
+    Buffer* acquireBuffer(size_t size);
+
+    /**
+     * @brief Queue the current buffer for writing
+     */
+    void submit();
+
+    /**
+     * @brief Queue the current buffer and wait until all buffers are written
+     */
+    void drain();
+
+    /**
+     * @brief Flush thread main loop
+     */
+    void flushLoop();
+
+    /**
+     * @brief Serialize the header lists
+     *
+     * Always the same size for the same streams, so the space reserved by
+     * open() fits the final headers.
+     *
+     * @param out Receives the headers, up to and including the first 'movi' list type
+     */
+    void buildHeaders(std::vector<uint8_t>& out) const;
+
+    /**
+     * @brief Write a buffer at an absolute file offset
+     *
+     * @return true if all bytes were written
+     */
+    bool writeAt(uint64_t offset, const void* data, size_t size);
+};
+
+#endif // AVI_WRITER_H
@@ -0,0 +1,175 @@
+/**
+ * @file contact_sheet.cpp
+ * @brief Implementation of the ContactSheet class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "contact_sheet.h"
+#include "mjpeg_decoder.h"
+#include "rle_decoder.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+namespace {
+    /**
+     * @brief Space between and around the thumbnails in pixels
+     */
+    const uint32_t kGap = 4;
+
+    /**
+     * @brief Gray level of the background
+     */
+    const uint8_t kBackground = 32;
+
+    /**
+     * @brief Store a little-endian value in a byte buffer
+     */
+    void putLE(uint8_t* out, uint32_t value, int bytes) {
+        for (int i = 0; i < bytes; ++i) {
+            out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+}
+
+ContactSheet::ContactSheet(const AVIReader& reader, int streamNumber, unsigned threads)
+    : reader(reader), streamNumber(streamNumber), pool(threads), columns(4), rows(4), thumbWidth(320),
+      factor(1), tileWidth(0), tileHeight(0), sheetWidth(0), sheetHeight(0), failed(false) {
+}
+
+void ContactSheet::setLayout(uint32_t columnCount, uint32_t rowCount, uint32_t width) {
+    columns = columnCount > 0 ? columnCount : 1;
+    rows = rowCount > 0 ? rowCount : 1;
+    thumbWidth = width > 0 ? width : 1;
+}
+
+bool ContactSheet::generate() {
+    const AVIStream& stream = reader.getStream(streamNumber);
+    if (!stream.isVideo() || stream.chunkOffsets.empty()) {
+        std::cerr << "Error: Stream " << streamNumber << " is not a video stream" << std::endl;
+        return false;
+    }
+    if (!converter.configure(stream.bitmapHeader, stream.palette, stream.colorMasks)) {
+        std::cerr << "Error: Unsupported pixel format" << std::endl;
+        return false;
+    }
+
+    factor = (converter.getWidth() + thumbWidth - 1) / thumbWidth;
+    if (factor == 0) factor = 1;
+    if (factor > 256) factor = 256;
+    tileWidth = converter.getWidth() / factor;
+    tileHeight = converter.getHeight() / factor;
+    sheetWidth = columns * (tileWidth + kGap) + kGap;
+    sheetHeight = rows * (tileHeight + kGap) + kGap;
+    image.assign(static_cast<size_t>(sheetWidth) * sheetHeight * 3, kBackground);
+
+    // The middle frame of each equal share of the stream, moved forward
+    // past dropped frames
+    uint32_t count = stream.getChunkCount();
+    uint32_t tiles = columns * rows;
+    frames.clear();
+    for (uint32_t i = 0; i < tiles; ++i) {
+        uint32_t frameIndex = static_cast<uint32_t>((static_cast<uint64_t>(2 * i + 1) * count) / (2 * tiles));
+        while (frameIndex + 1 < count && stream.chunkSizes[frameIndex] < converter.getSourceFrameSize()) {
+            frameIndex++;
+        }
+        frames.push_back(frameIndex);
+    }
+
+    failed = false;
+    for (size_t tile = 0; tile < frames.size(); ++tile) {
+        pool.submit([this, tile] { renderTile(tile); });
+    }
+    pool.waitIdle();
+
+    if (failed) {
+        std::cerr << "Error: Failed to read frame data" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ContactSheet::renderTile(size_t tile) {
+    const AVIStream& stream = reader.getStream(streamNumber);
+    uint32_t frameIndex = frames[tile];
+
+    // Dropped frames at the very end leave their tile empty
+    if (stream.chunkSizes[frameIndex] < converter.getSourceFrameSize()) return;
+
+    std::vector<uint8_t> frame;
+    std::unique_ptr<RLEDecoder> decoder;
+    std::unique_ptr<MJPEGDecoder> jpegDecoder;
+    const uint8_t* frameData = nullptr;
+    if (converter.isRunLength()) {
+        // Each tile decodes from the key frame before it
+        decoder.reset(new RLEDecoder(reader, streamNumber, converter));
+        frameData = decoder->decode(frameIndex, nullptr);
+    } else if (converter.isMotionJPEG()) {
+        jpegDecoder.reset(new MJPEGDecoder(reader, streamNumber, converter));
+        frameData = jpegDecoder->decode(frameIndex, nullptr);
+    } else {
+        frame.resize(stream.chunkSizes[frameIndex]);
+        if (reader.readChunk(streamNumber, frameIndex, frame.data(), frame.size())) frameData = frame.data();
+    }
+    if (!frameData) {
+        failed = true;
+        return;
+    }
+
+    uint32_t x = kGap + static_cast<uint32_t>(tile % columns) * (tileWidth + kGap);
+    uint32_t y = kGap + static_cast<uint32_t>(tile / columns) * (tileHeight + kGap);
+    uint8_t* origin = image.data() + (static_cast<size_t>(y) * sheetWidth + x) * 3;
+    converter.convertToRGB24Box(frameData, origin, static_cast<int>(sheetWidth * 3), factor);
+}
+
+bool ContactSheet::write(const std::string& path) const {
+    std::ofstream file(path.c_str(), std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Cannot create file " << path << std::endl;
+        return false;
+    }
+
+    bool ppm = path.size() >= 4 && path.compare(path.size() - 4, 4, ".ppm") == 0;
+    if (ppm) {
+        char header[64];
+        std::snprintf(header, sizeof(header), "P6\n%u %u\n255\n", sheetWidth, sheetHeight);
+        file << header;
+        file.write(reinterpret_cast<const char*>(image.data()), image.size());
+        return file.good();
+    }
+
+    // 24-bit BMP: bottom-up BGR rows padded to four bytes
+    uint32_t rowBytes = (sheetWidth * 3 + 3) & ~3u;
+    uint32_t dataOffset = 14 + sizeof(BitmapInfoHeader);
+    uint8_t fileHeader[14] = { 'B', 'M' };
+    putLE(fileHeader + 2, dataOffset + rowBytes * sheetHeight, 4);
+    putLE(fileHeader + 10, dataOffset, 4);
+
+    BitmapInfoHeader info;
+    std::memset(&info, 0, sizeof(info));
+    info.size = sizeof(BitmapInfoHeader);
+    info.width = static_cast<int32_t>(sheetWidth);
+    info.height = static_cast<int32_t>(sheetHeight);
+    info.planes = 1;
+    info.bitCount = 24;
+    info.sizeImage = rowBytes * sheetHeight;
+
+    file.write(reinterpret_cast<const char*>(fileHeader), sizeof(fileHeader));
+    file.write(reinterpret_cast<const char*>(&info), sizeof(info));
+
+    std::vector<uint8_t> row(rowBytes, 0);
+    for (uint32_t y = sheetHeight; y-- > 0;) {
+        const uint8_t* src = image.data() + static_cast<size_t>(y) * sheetWidth * 3;
+        for (uint32_t x = 0; x < sheetWidth; ++x) {
+            row[x * 3 + 0] = src[x * 3 + 2];
+            row[x * 3 + 1] = src[x * 3 + 1];
+            row[x * 3 + 2] = src[x * 3 + 0];
+        }
+        file.write(reinterpret_cast<const char*>(row.data()), row.size());
+    }
+    return file.good();
+}
@@ -0,0 +1,116 @@
+/**
+ * @file contact_sheet.h
+ * @brief Thumbnail contact sheets of AVI files
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the ContactSheet class, which renders evenly spaced
+ * frames of a video stream as a grid of thumbnails in one image.
+ */
+
+#ifndef CONTACT_SHEET_H
+#define CONTACT_SHEET_H
+
+#include "avi_reader.h"
+#include "frame_converter.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Contact sheet generator for one video stream
+ *
+ * Only the frames shown on the sheet are read, located through the index,
+ * and each is read and box-filtered straight into its tile on a pool
+ * worker. A single thumbnail is a sheet of one column and one row.
+ *
+ * Usage example:
+ * @code
+ * ContactSheet sheet(reader, reader.getVideoStream(), 0);
+ * sheet.setLayout(4, 4, 320);
+ * if (sheet.generate()) {
+ *     sheet.write("sheet.bmp");
+ * }
+ * @endcode
+ */
+class ContactSheet {
+private:
+    const AVIReader& reader;         ///< Source of frame data
+    int streamNumber;                ///< Video stream to render
+    FrameConverter converter;        ///< Conversion and downscaling to RGB24
+    ThreadPool pool;                 ///< Workers for reads and downscaling
+    uint32_t columns;                ///< Thumbnails per row
+    uint32_t rows;                   ///< Rows of thumbnails
+    uint32_t thumbWidth;             ///< Requested thumbnail width
+    uint32_t factor;                 ///< Box filter size
+    uint32_t tileWidth;              ///< Thumbnail width in pixels
+    uint32_t tileHeight;             ///< Thumbnail height in pixels
+    uint32_t sheetWidth;             ///< Image width in pixels
+    uint32_t sheetHeight;            ///< Image height in pixels
+    std::vector<uint8_t> image;      ///< Top-down RGB24 sheet
+    std::vector<uint32_t> frames;    ///< Frame shown in each tile
+    std::atomic<bool> failed;        ///< Set when a read fails
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param reader Open reader; must outlive this object
+     * @param streamNumber Video stream to render
+     * @param threads Worker threads; 0 uses one per hardware thread
+     */
+    ContactSheet(const AVIReader& reader, int streamNumber, unsigned threads);
+
+    /**
+     * @brief Set the grid and the thumbnail size
+     *
+     * Thumbnails are reduced by the integer factor that brings them
+     * closest to the requested width without exceeding it.
+     *
+     * @param columnCount Thumbnails per row (default 4)
+     * @param rowCount Rows of thumbnails (default 4)
+     * @param width Largest thumbnail width in pixels (default 320)
+     */
+    void setLayout(uint32_t columnCount, uint32_t rowCount, uint32_t width);
+
+    /**
+     * @brief Read the frames and render the sheet
+     *
+     * @return true on success, false if the format is unsupported or a read failed
+     */
+    bool generate();
+
+    /**
+     * @brief Save the sheet
+     *
+     * @param path Output file; written as PPM if it ends in .ppm, as BMP otherwise
+     * @return true on success
+     */
+    bool write(const std::string& path) const;
+
+    /** @brief Frame shown in each tile, row by row */
+    const std::vector<uint32_t>& getFrames() const { return frames; }
+
+    /** @brief Image width in pixels */
+    uint32_t getWidth() const { return sheetWidth; }
+
+    /** @brief Image height in pixels */
+    uint32_t getHeight() const { return sheetHeight; }
+
+private:
+    ContactSheet(const ContactSheet&);
+    ContactSheet& operator=(const ContactSheet&);
+
+    /**
+     * @brief Read a frame and downscale it into its tile
+     *
+     * Runs on a pool worker; tiles do not overlap.
+     *
+     * @param tile Index of the tile
+     */
+    void renderTile(size_t tile);
+};
+
+#endif // CONTACT_SHEET_H
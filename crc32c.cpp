@@ -0,0 +1,160 @@
+/**
+ * @file crc32c.cpp
+ * @brief Implementation of the CRC-32C checksum
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "crc32c.h"
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CRC32C_X86 1
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define CRC32C_ARM 1
+#include <arm_acle.h>
+#endif
+
+namespace {
+    /**
+     * @brief Reflected CRC-32C polynomial
+     */
+    const uint32_t kPolynomial = 0x82F63B78u;
+
+    /**
+     * @brief Lookup tables for processing eight bytes per step
+     */
+    struct Tables {
+        uint32_t entries[8][256];
+
+        Tables() {
+            for (uint32_t i = 0; i < 256; ++i) {
+                uint32_t crc = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    crc = (crc >> 1) ^ (kPolynomial & (0u - (crc & 1u)));
+                }
+                entries[0][i] = crc;
+            }
+            for (uint32_t i = 0; i < 256; ++i) {
+                for (int t = 1; t < 8; ++t) {
+                    uint32_t previous = entries[t - 1][i];
+                    entries[t][i] = (previous >> 8) ^ entries[0][previous & 0xFF];
+                }
+            }
+        }
+    };
+
+    const Tables tables;
+
+    /**
+     * @brief Table-driven CRC-32C (slicing-by-8)
+     */
+    uint32_t crc32cSoftware(uint32_t crc, const uint8_t* data, size_t size) {
+        const uint32_t (*t)[256] = tables.entries;
+
+        while (size >= 8) {
+            uint32_t low, high;
+            std::memcpy(&low, data, 4);
+            std::memcpy(&high, data + 4, 4);
+            low ^= crc;  // Little-endian load, as on all supported platforms
+            crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^
+                  t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+                  t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^
+                  t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+            data += 8;
+            size -= 8;
+        }
+        while (size-- > 0) {
+            crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+        }
+        return crc;
+    }
+
+#if defined(CRC32C_X86)
+    /**
+     * @brief CRC-32C with the SSE4.2 crc32 instruction
+     *
+     * Compiled for SSE4.2 regardless of the build flags and only called
+     * after the CPU has been checked.
+     */
+    __attribute__((target("sse4.2")))
+    uint32_t crc32cHardware(uint32_t crc, const uint8_t* data, size_t size) {
+#if defined(__x86_64__)
+        uint64_t crc64 = crc;
+        while (size >= 8) {
+            uint64_t word;
+            std::memcpy(&word, data, 8);
+            crc64 = _mm_crc32_u64(crc64, word);
+            data += 8;
+            size -= 8;
+        }
+        crc = static_cast<uint32_t>(crc64);
+#endif
+        while (size >= 4) {
+            uint32_t word;
+            std::memcpy(&word, data, 4);
+            crc = _mm_crc32_u32(crc, word);
+            data += 4;
+            size -= 4;
+        }
+        while (size-- > 0) {
+            crc = _mm_crc32_u8(crc, *data++);
+        }
+        return crc;
+    }
+
+    /**
+     * @brief Check the CPU for SSE4.2
+     *
+     * Runs during static initialization, before the CPU model is
+     * otherwise initialized.
+     */
+    bool detectHardware() {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("sse4.2");
+    }
+
+    const bool hasHardware = detectHardware();
+#elif defined(CRC32C_ARM)
+    /**
+     * @brief CRC-32C with the ARMv8 CRC32 instructions
+     */
+    uint32_t crc32cHardware(uint32_t crc, const uint8_t* data, size_t size) {
+        while (size >= 8) {
+            uint64_t word;
+            std::memcpy(&word, data, 8);
+            crc = __crc32cd(crc, word);
+            data += 8;
+            size -= 8;
+        }
+        while (size-- > 0) {
+            crc = __crc32cb(crc, *data++);
+        }
+        return crc;
+    }
+
+    const bool hasHardware = true;
+#endif
+}
+
+uint32_t crc32c(uint32_t crc, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    crc = ~crc;
+#if defined(CRC32C_X86) || defined(CRC32C_ARM)
+    if (hasHardware) {
+        return ~crc32cHardware(crc, bytes, size);
+    }
+#endif
+    return ~crc32cSoftware(crc, bytes, size);
+}
+
+const char* crc32cImplementation() {
+#if defined(CRC32C_X86)
+    if (hasHardware) return "sse4.2";
+#elif defined(CRC32C_ARM)
+    return "armv8";
+#endif
+    return "software";
+}
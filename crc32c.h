@@ -0,0 +1,40 @@
+/**
+ * @file crc32c.h
+ * @brief CRC-32C (Castagnoli) checksum
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header declares the CRC-32C function used to fingerprint frame
+ * payloads. The checksum is computed with the CRC32 instructions of SSE4.2
+ * or ARMv8 when the CPU has them, and with a table-driven routine
+ * otherwise; all paths produce the same value.
+ */
+
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Extend a CRC-32C checksum over a buffer
+ *
+ * Start with a crc of 0; pass the previous result to continue over
+ * further data, e.g. crc32c(crc32c(0, a, n), b, m).
+ *
+ * @param crc Checksum of the data before @p data
+ * @param data Bytes to checksum
+ * @param size Number of bytes
+ * @return Checksum of all data so far
+ */
+uint32_t crc32c(uint32_t crc, const void* data, size_t size);
+
+/**
+ * @brief Name of the implementation crc32c() uses on this CPU
+ *
+ * @return "sse4.2", "armv8" or "software"
+ */
+const char* crc32cImplementation();
+
+#endif // CRC32C_H
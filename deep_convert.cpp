@@ -0,0 +1,698 @@
+/**
+ * @file deep_convert.cpp
+ * @brief Implementation of the high-bit-depth row kernels
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "deep_convert.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define DEEP_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    /**
+     * @brief 8x8 Bayer matrix, thresholds 0 to 63
+     */
+    const uint8_t kBayer[8][8] = {
+        { 0, 32,  8, 40,  2, 34, 10, 42},
+        {48, 16, 56, 24, 50, 18, 58, 26},
+        {12, 44,  4, 36, 14, 46,  6, 38},
+        {60, 28, 52, 20, 62, 30, 54, 22},
+        { 3, 35, 11, 43,  1, 33,  9, 41},
+        {51, 19, 59, 27, 49, 17, 57, 25},
+        {15, 47,  7, 39, 13, 45,  5, 37},
+        {63, 31, 55, 23, 61, 29, 53, 21}
+    };
+
+    /**
+     * @brief Placement of the samples of 16-bit RGB sources
+     */
+    struct SampleLayout {
+        int offsets[4];     ///< Byte offset of red, green, blue and alpha in a pixel, -1 if absent
+        uint32_t bytes;     ///< Bytes per pixel
+        bool bigEndian;     ///< True if samples are stored most significant byte first
+    };
+
+    const SampleLayout kBGR48 = {{4, 2, 0, -1}, 6, false};
+    const SampleLayout kBGRA64 = {{4, 2, 0, 6}, 8, false};
+    const SampleLayout kB48R = {{0, 2, 4, -1}, 6, true};
+    const SampleLayout kB64A = {{2, 4, 6, 0}, 8, true};
+
+    const SampleLayout& sampleLayout(DeepSource source) {
+        switch (source) {
+            case DEEP_SOURCE_BGRA64: return kBGRA64;
+            case DEEP_SOURCE_B48R: return kB48R;
+            case DEEP_SOURCE_B64A: return kB64A;
+            default: return kBGR48;
+        }
+    }
+
+    /**
+     * @brief Samples per plane of the scratch buffer
+     *
+     * Whole groups of six v210 pixels, plus room for the SIMD stores that
+     * run past the last group.
+     */
+    size_t planeStride(uint32_t width) {
+        return ((static_cast<size_t>(width) + 47) / 48) * 48 + 16;
+    }
+
+    inline uint16_t clampSample(int32_t value) {
+        return static_cast<uint16_t>(value < 0 ? 0 : (value > 65535 ? 65535 : value));
+    }
+
+    /**
+     * @brief Unpack v210 groups into Y, U and V planes
+     *
+     * Chroma is repeated for both pixels of a pair, so the three planes
+     * line up.
+     *
+     * @param group First group of six pixels to unpack
+     */
+    void unpackV210Software(const uint8_t* src, uint16_t* const planes[4], uint32_t group, uint32_t groups) {
+        for (; group < groups; ++group) {
+            uint32_t words[4];
+            std::memcpy(words, src + group * 16, sizeof(words));
+            uint16_t s[12];
+            for (int i = 0; i < 4; ++i) {
+                s[i * 3 + 0] = static_cast<uint16_t>(words[i] & 0x3FF);
+                s[i * 3 + 1] = static_cast<uint16_t>((words[i] >> 10) & 0x3FF);
+                s[i * 3 + 2] = static_cast<uint16_t>((words[i] >> 20) & 0x3FF);
+            }
+
+            // U0 Y0 V0 Y1 U2 Y2 V2 Y3 U4 Y4 V4 Y5
+            uint16_t* y = planes[0] + group * 6;
+            uint16_t* u = planes[1] + group * 6;
+            uint16_t* v = planes[2] + group * 6;
+            for (int i = 0; i < 6; ++i) {
+                y[i] = s[i * 2 + 1];
+                u[i] = s[(i / 2) * 4];
+                v[i] = s[(i / 2) * 4 + 2];
+            }
+        }
+    }
+
+    /**
+     * @brief Convert Y, U and V planes to R, G and B in place
+     *
+     * @param x First pixel to convert
+     */
+    void convertYUVSoftware(uint16_t* const planes[4], uint32_t x, uint32_t width, const DeepCoefficients& c) {
+        for (; x < width; ++x) {
+            int32_t luma = (planes[0][x] - c.yOffset) * c.yScale + 4096;
+            int32_t cb = planes[1][x] - 512;
+            int32_t cr = planes[2][x] - 512;
+            planes[0][x] = clampSample((luma + cr * c.redV) >> 13);
+            planes[1][x] = clampSample((luma - (cb * c.greenU + cr * c.greenV)) >> 13);
+            planes[2][x] = clampSample((luma + cb * c.blueU) >> 13);
+        }
+    }
+
+    /**
+     * @brief Split 16-bit RGB pixels into planes
+     *
+     * Absent channels are left alone.
+     *
+     * @param x First pixel to unpack
+     */
+    void unpackSamplesSoftware(const SampleLayout& layout, const uint8_t* src, uint16_t* const planes[4],
+                               uint32_t x, uint32_t width) {
+        for (; x < width; ++x) {
+            const uint8_t* pixel = src + static_cast<size_t>(x) * layout.bytes;
+            for (int i = 0; i < 4; ++i) {
+                if (layout.offsets[i] < 0) continue;
+                const uint8_t* sample = pixel + layout.offsets[i];
+                planes[i][x] = static_cast<uint16_t>(layout.bigEndian ? (sample[0] << 8) | sample[1]
+                                                                      : (sample[1] << 8) | sample[0]);
+            }
+        }
+    }
+
+    /**
+     * @brief Narrow a 16-bit sample to 8 bits
+     *
+     * v - v / 256 maps 0-65535 onto 0-65280, 255 steps of 256, so any
+     * threshold below 256 keeps the result within a byte.
+     */
+    inline uint8_t narrowTo8(uint32_t value, uint32_t threshold) {
+        return static_cast<uint8_t>((value - (value >> 8) + threshold) >> 8);
+    }
+
+    /**
+     * @brief Narrow a 16-bit sample to 10 bits, with a threshold below 64
+     */
+    inline uint32_t narrowTo10(uint32_t value, uint32_t threshold) {
+        return (value - (value >> 10) + threshold) >> 6;
+    }
+
+    /**
+     * @brief Portable packing, also used for the tails of the SIMD rows
+     *
+     * @param x First pixel to pack
+     */
+    template <DeepLayout layout>
+    void packRowSoftware(uint16_t* const planes[4], uint8_t* dst, uint32_t x, uint32_t width, uint32_t row) {
+        const uint8_t* bayer = kBayer[row & 7];
+        for (; x < width; ++x) {
+            uint32_t red = planes[0][x];
+            uint32_t green = planes[1][x];
+            uint32_t blue = planes[2][x];
+            uint32_t alpha = planes[3][x];
+            if (layout == DEEP_LAYOUT_BGRA32) {
+                uint32_t threshold = bayer[x & 7] * 4u + 2;
+                uint8_t* out = dst + x * 4;
+                out[0] = narrowTo8(blue, threshold);
+                out[1] = narrowTo8(green, threshold);
+                out[2] = narrowTo8(red, threshold);
+                out[3] = narrowTo8(alpha, 128);
+            } else if (layout == DEEP_LAYOUT_ARGB2101010) {
+                uint32_t threshold = bayer[x & 7];
+                uint32_t value = (alpha >> 14) << 30 | narrowTo10(red, threshold) << 20 |
+                                 narrowTo10(green, threshold) << 10 | narrowTo10(blue, threshold);
+                std::memcpy(dst + x * 4, &value, sizeof(value));
+            } else if (layout == DEEP_LAYOUT_RGB24) {
+                uint8_t* out = dst + x * 3;
+                out[0] = narrowTo8(red, 128);
+                out[1] = narrowTo8(green, 128);
+                out[2] = narrowTo8(blue, 128);
+            } else {
+                uint16_t rgb[3] = {static_cast<uint16_t>(red), static_cast<uint16_t>(green), static_cast<uint16_t>(blue)};
+                std::memcpy(dst + x * 6, rgb, sizeof(rgb));
+            }
+        }
+    }
+
+#if defined(DEEP_X86)
+    /**
+     * @brief pshufb masks that gather each channel of eight 16-bit RGB pixels
+     *
+     * For each channel and each 16-byte load of the pixels, the mask picks
+     * the channel's bytes that fall into that load, swapped to little-endian
+     * order, and zeroes the rest; the loads' results are then ORed.
+     */
+    struct ShuffleMasks {
+        uint8_t bytes[4][4][16];    ///< [channel][load][byte]
+    };
+
+    ShuffleMasks makeShuffleMasks(const SampleLayout& layout) {
+        ShuffleMasks masks;
+        std::memset(masks.bytes, 0x80, sizeof(masks.bytes));
+        for (int channel = 0; channel < 4; ++channel) {
+            if (layout.offsets[channel] < 0) continue;
+            for (uint32_t i = 0; i < 8; ++i) {
+                uint32_t offset = i * layout.bytes + layout.offsets[channel];
+                uint32_t low = layout.bigEndian ? offset + 1 : offset;
+                uint32_t high = layout.bigEndian ? offset : offset + 1;
+                masks.bytes[channel][low / 16][i * 2] = static_cast<uint8_t>(low % 16);
+                masks.bytes[channel][high / 16][i * 2 + 1] = static_cast<uint8_t>(high % 16);
+            }
+        }
+        return masks;
+    }
+
+    const ShuffleMasks kMasksBGR48 = makeShuffleMasks(kBGR48);
+    const ShuffleMasks kMasksBGRA64 = makeShuffleMasks(kBGRA64);
+    const ShuffleMasks kMasksB48R = makeShuffleMasks(kB48R);
+    const ShuffleMasks kMasksB64A = makeShuffleMasks(kB64A);
+
+    const ShuffleMasks& shuffleMasks(DeepSource source) {
+        switch (source) {
+            case DEEP_SOURCE_BGRA64: return kMasksBGRA64;
+            case DEEP_SOURCE_B48R: return kMasksB48R;
+            case DEEP_SOURCE_B64A: return kMasksB64A;
+            default: return kMasksBGR48;
+        }
+    }
+
+    /**
+     * @brief Split 16-bit RGB pixels into planes with SSE4.1, 8 pixels per step
+     *
+     * Samples sit at even offsets, so none straddles two loads.
+     *
+     * Compiled for SSE4.1 regardless of the build flags and only called
+     * after the CPU has been checked.
+     *
+     * @tparam Bytes Bytes per pixel, 6 or 8
+     */
+    template <uint32_t Bytes>
+    __attribute__((target("sse4.1")))
+    void unpackSamplesSSE41(const SampleLayout& layout, const ShuffleMasks& masks, const uint8_t* src,
+                            uint16_t* const planes[4], uint32_t width) {
+        const uint32_t loads = Bytes / 2;
+        const int channels = Bytes == 8 ? 4 : 3;
+        __m128i shuffles[4][loads];
+        for (int channel = 0; channel < channels; ++channel) {
+            for (uint32_t k = 0; k < loads; ++k) {
+                shuffles[channel][k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(masks.bytes[channel][k]));
+            }
+        }
+
+        uint32_t x = 0;
+        for (; x + 8 <= width; x += 8) {
+            const uint8_t* pixels = src + static_cast<size_t>(x) * Bytes;
+            __m128i in[loads];
+            for (uint32_t k = 0; k < loads; ++k) {
+                in[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + k * 16));
+            }
+            for (int channel = 0; channel < channels; ++channel) {
+                __m128i samples = _mm_shuffle_epi8(in[0], shuffles[channel][0]);
+                for (uint32_t k = 1; k < loads; ++k) {
+                    samples = _mm_or_si128(samples, _mm_shuffle_epi8(in[k], shuffles[channel][k]));
+                }
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[channel] + x), samples);
+            }
+        }
+        unpackSamplesSoftware(layout, src, planes, x, width);
+    }
+
+    /**
+     * @brief Y, U and V of one v210 group, as 16-bit lanes 0 to 5
+     *
+     * Each 32-bit word holds three samples; after splitting them, pshufb
+     * puts each sample in its pixel's lane, with chroma repeated for both
+     * pixels of a pair. The shuffles work within 128-bit lanes, so the
+     * AVX2 variant handles one group per lane.
+     */
+    const uint8_t kV210Masks[6][16] = {
+        // Y from (a, b) and from c
+        {8, 9, 2, 3, 0x80, 0x80, 12, 13, 6, 7, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+        {0x80, 0x80, 0x80, 0x80, 2, 3, 0x80, 0x80, 0x80, 0x80, 6, 7, 0x80, 0x80, 0x80, 0x80},
+        // U
+        {0, 1, 0, 1, 10, 11, 10, 11, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+        {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 4, 5, 4, 5, 0x80, 0x80, 0x80, 0x80},
+        // V
+        {0x80, 0x80, 0x80, 0x80, 4, 5, 4, 5, 14, 15, 14, 15, 0x80, 0x80, 0x80, 0x80},
+        {0, 1, 0, 1, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80}
+    };
+
+    /**
+     * @brief Unpack v210 with SSE4.1, one group of six pixels per step
+     *
+     * Each store writes eight lanes; the two past the group are
+     * overwritten by the next group or land in the scratch padding.
+     */
+    __attribute__((target("sse4.1")))
+    void unpackV210SSE41(const uint8_t* src, uint16_t* const planes[4], uint32_t group, uint32_t groups) {
+        const __m128i sampleMask = _mm_set1_epi32(0x3FF);
+        __m128i masks[6];
+        for (int i = 0; i < 6; ++i) masks[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kV210Masks[i]));
+
+        for (; group < groups; ++group) {
+            __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + group * 16));
+            __m128i a = _mm_and_si128(words, sampleMask);
+            __m128i b = _mm_and_si128(_mm_srli_epi32(words, 10), sampleMask);
+            __m128i c = _mm_and_si128(_mm_srli_epi32(words, 20), sampleMask);
+            __m128i ab = _mm_packus_epi32(a, b);
+            __m128i cc = _mm_packus_epi32(c, c);
+            for (int plane = 0; plane < 3; ++plane) {
+                __m128i samples = _mm_or_si128(_mm_shuffle_epi8(ab, masks[plane * 2]),
+                                               _mm_shuffle_epi8(cc, masks[plane * 2 + 1]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[plane] + group * 6), samples);
+            }
+        }
+    }
+
+    /**
+     * @brief Unpack v210 with AVX2, two groups per step
+     */
+    __attribute__((target("avx2")))
+    void unpackV210AVX2(const uint8_t* src, uint16_t* const planes[4], uint32_t groups) {
+        const __m256i sampleMask = _mm256_set1_epi32(0x3FF);
+        __m256i masks[6];
+        for (int i = 0; i < 6; ++i) {
+            masks[i] = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(kV210Masks[i])));
+        }
+
+        uint32_t group = 0;
+        for (; group + 2 <= groups; group += 2) {
+            __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + group * 16));
+            __m256i a = _mm256_and_si256(words, sampleMask);
+            __m256i b = _mm256_and_si256(_mm256_srli_epi32(words, 10), sampleMask);
+            __m256i c = _mm256_and_si256(_mm256_srli_epi32(words, 20), sampleMask);
+            __m256i ab = _mm256_packus_epi32(a, b);
+            __m256i cc = _mm256_packus_epi32(c, c);
+            for (int plane = 0; plane < 3; ++plane) {
+                __m256i samples = _mm256_or_si256(_mm256_shuffle_epi8(ab, masks[plane * 2]),
+                                                  _mm256_shuffle_epi8(cc, masks[plane * 2 + 1]));
+                uint16_t* out = planes[plane] + group * 6;
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(samples));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 6), _mm256_extracti128_si256(samples, 1));
+            }
+        }
+        unpackV210SSE41(src, planes, group, groups);
+    }
+
+    /**
+     * @brief Convert Y, U and V planes with SSE4.1, 8 pixels per step
+     *
+     * 32-bit lanes hold the products; packus clamps to 0-65535.
+     */
+    __attribute__((target("sse4.1")))
+    void convertYUVSSE41(uint16_t* const planes[4], uint32_t width, const DeepCoefficients& c) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i yOffset = _mm_set1_epi32(c.yOffset);
+        const __m128i chromaOffset = _mm_set1_epi32(512);
+        const __m128i rounding = _mm_set1_epi32(4096);
+        const __m128i yScale = _mm_set1_epi32(c.yScale);
+        const __m128i redV = _mm_set1_epi32(c.redV);
+        const __m128i greenU = _mm_set1_epi32(c.greenU);
+        const __m128i greenV = _mm_set1_epi32(c.greenV);
+        const __m128i blueU = _mm_set1_epi32(c.blueU);
+
+        uint32_t x = 0;
+        for (; x + 8 <= width; x += 8) {
+            __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[0] + x));
+            __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[1] + x));
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[2] + x));
+            __m128i halves[2][3];
+            for (int h = 0; h < 2; ++h) {
+                __m128i luma = h == 0 ? _mm_cvtepu16_epi32(y) : _mm_unpackhi_epi16(y, zero);
+                __m128i cb = h == 0 ? _mm_cvtepu16_epi32(u) : _mm_unpackhi_epi16(u, zero);
+                __m128i cr = h == 0 ? _mm_cvtepu16_epi32(v) : _mm_unpackhi_epi16(v, zero);
+                luma = _mm_add_epi32(_mm_mullo_epi32(_mm_sub_epi32(luma, yOffset), yScale), rounding);
+                cb = _mm_sub_epi32(cb, chromaOffset);
+                cr = _mm_sub_epi32(cr, chromaOffset);
+                halves[h][0] = _mm_srai_epi32(_mm_add_epi32(luma, _mm_mullo_epi32(cr, redV)), 13);
+                halves[h][1] = _mm_srai_epi32(_mm_sub_epi32(luma, _mm_add_epi32(_mm_mullo_epi32(cb, greenU),
+                                                                                _mm_mullo_epi32(cr, greenV))), 13);
+                halves[h][2] = _mm_srai_epi32(_mm_add_epi32(luma, _mm_mullo_epi32(cb, blueU)), 13);
+            }
+            for (int plane = 0; plane < 3; ++plane) {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(planes[plane] + x),
+                                 _mm_packus_epi32(halves[0][plane], halves[1][plane]));
+            }
+        }
+        convertYUVSoftware(planes, x, width, c);
+    }
+
+    /**
+     * @brief Convert Y, U and V planes with AVX2, 16 pixels per step
+     *
+     * The 32-bit halves are widened in order, so only the lane-wise pack
+     * needs fixing up before the store.
+     */
+    __attribute__((target("avx2")))
+    void convertYUVAVX2(uint16_t* const planes[4], uint32_t width, const DeepCoefficients& c) {
+        const __m256i yOffset = _mm256_set1_epi32(c.yOffset);
+        const __m256i chromaOffset = _mm256_set1_epi32(512);
+        const __m256i rounding = _mm256_set1_epi32(4096);
+        const __m256i yScale = _mm256_set1_epi32(c.yScale);
+        const __m256i redV = _mm256_set1_epi32(c.redV);
+        const __m256i greenU = _mm256_set1_epi32(c.greenU);
+        const __m256i greenV = _mm256_set1_epi32(c.greenV);
+        const __m256i blueU = _mm256_set1_epi32(c.blueU);
+
+        uint32_t x = 0;
+        for (; x + 16 <= width; x += 16) {
+            __m256i halves[2][3];
+            for (int h = 0; h < 2; ++h) {
+                uint32_t at = x + h * 8;
+                __m256i luma = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[0] + at)));
+                __m256i cb = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[1] + at)));
+                __m256i cr = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[2] + at)));
+                luma = _mm256_add_epi32(_mm256_mullo_epi32(_mm256_sub_epi32(luma, yOffset), yScale), rounding);
+                cb = _mm256_sub_epi32(cb, chromaOffset);
+                cr = _mm256_sub_epi32(cr, chromaOffset);
+                halves[h][0] = _mm256_srai_epi32(_mm256_add_epi32(luma, _mm256_mullo_epi32(cr, redV)), 13);
+                halves[h][1] = _mm256_srai_epi32(_mm256_sub_epi32(luma, _mm256_add_epi32(_mm256_mullo_epi32(cb, greenU),
+                                                                                         _mm256_mullo_epi32(cr, greenV))), 13);
+                halves[h][2] = _mm256_srai_epi32(_mm256_add_epi32(luma, _mm256_mullo_epi32(cb, blueU)), 13);
+            }
+            for (int plane = 0; plane < 3; ++plane) {
+                __m256i packed = _mm256_packus_epi32(halves[0][plane], halves[1][plane]);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(planes[plane] + x), _mm256_permute4x64_epi64(packed, 0xD8));
+            }
+        }
+        convertYUVSoftware(planes, x, width, c);
+    }
+
+    /**
+     * @brief Dither eight 16-bit samples to bytes, one per 16-bit lane
+     */
+    __attribute__((target("sse4.1")))
+    inline __m128i narrowTo8SSE41(__m128i samples, __m128i thresholds) {
+        return _mm_srli_epi16(_mm_add_epi16(_mm_sub_epi16(samples, _mm_srli_epi16(samples, 8)), thresholds), 8);
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i narrowTo8AVX2(__m256i samples, __m256i thresholds) {
+        return _mm256_srli_epi16(_mm256_add_epi16(_mm256_sub_epi16(samples, _mm256_srli_epi16(samples, 8)), thresholds), 8);
+    }
+
+    /**
+     * @brief Thresholds of one row of the Bayer matrix, scaled to 8 bits
+     */
+    __attribute__((target("sse4.1")))
+    inline __m128i ditherRow8(uint32_t row) {
+        const uint8_t* bayer = kBayer[row & 7];
+        return _mm_add_epi16(_mm_slli_epi16(_mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(bayer))), 2),
+                             _mm_set1_epi16(2));
+    }
+
+    /**
+     * @brief Pack to dithered BGRA32 with SSE4.1, 8 pixels per step
+     */
+    __attribute__((target("sse4.1")))
+    void packBGRASSE41(uint16_t* const planes[4], uint8_t* dst, uint32_t width, uint32_t row) {
+        const __m128i thresholds = ditherRow8(row);
+        const __m128i half = _mm_set1_epi16(128);
+
+        uint32_t x = 0;
+        for (; x + 8 <= width; x += 8) {
+            __m128i red = narrowTo8SSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[0] + x)), thresholds);
+            __m128i green = narrowTo8SSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[1] + x)), thresholds);
+            __m128i blue = narrowTo8SSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[2] + x)), thresholds);
+            __m128i alpha = narrowTo8SSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[3] + x)), half);
+            __m128i blueGreen = _mm_or_si128(blue, _mm_slli_epi16(green, 8));
+            __m128i redAlpha = _mm_or_si128(red, _mm_slli_epi16(alpha, 8));
+            __m128i* out = reinterpret_cast<__m128i*>(dst + x * 4);
+            _mm_storeu_si128(out, _mm_unpacklo_epi16(blueGreen, redAlpha));
+            _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(blueGreen, redAlpha));
+        }
+        packRowSoftware<DEEP_LAYOUT_BGRA32>(planes, dst, x, width, row);
+    }
+
+    /**
+     * @brief Pack to dithered BGRA32 with AVX2, 16 pixels per step
+     */
+    __attribute__((target("avx2")))
+    void packBGRAAVX2(uint16_t* const planes[4], uint8_t* dst, uint32_t width, uint32_t row) {
+        const __m256i thresholds = _mm256_broadcastsi128_si256(ditherRow8(row));
+        const __m256i half = _mm256_set1_epi16(128);
+
+        uint32_t x = 0;
+        for (; x + 16 <= width; x += 16) {
+            __m256i red = narrowTo8AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(planes[0] + x)), thresholds);
+            __m256i green = narrowTo8AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(planes[1] + x)), thresholds);
+            __m256i blue = narrowTo8AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(planes[2] + x)), thresholds);
+            __m256i alpha = narrowTo8AVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(planes[3] + x)), half);
+            __m256i blueGreen = _mm256_or_si256(blue, _mm256_slli_epi16(green, 8));
+            __m256i redAlpha = _mm256_or_si256(red, _mm256_slli_epi16(alpha, 8));
+            __m256i low = _mm256_unpacklo_epi16(blueGreen, redAlpha);     // 0-3, 8-11
+            __m256i high = _mm256_unpackhi_epi16(blueGreen, redAlpha);    // 4-7, 12-15
+            __m256i* out = reinterpret_cast<__m256i*>(dst + x * 4);
+            _mm256_storeu_si256(out, _mm256_permute2x128_si256(low, high, 0x20));
+            _mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(low, high, 0x31));
+        }
+        packRowSoftware<DEEP_LAYOUT_BGRA32>(planes, dst, x, width, row);
+    }
+
+    /**
+     * @brief Pack to dithered ARGB2101010 with SSE4.1, 8 pixels per step
+     */
+    __attribute__((target("sse4.1")))
+    void packARGB2101010SSE41(uint16_t* const planes[4], uint8_t* dst, uint32_t width, uint32_t row) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i thresholds = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(kBayer[row & 7])));
+
+        uint32_t x = 0;
+        for (; x + 8 <= width; x += 8) {
+            __m128i channels[4];
+            for (int i = 0; i < 3; ++i) {
+                __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[i] + x));
+                channels[i] = _mm_srli_epi16(_mm_add_epi16(_mm_sub_epi16(samples, _mm_srli_epi16(samples, 10)), thresholds), 6);
+            }
+            channels[3] = _mm_srli_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[3] + x)), 14);
+            for (int h = 0; h < 2; ++h) {
+                __m128i wide[4];
+                for (int i = 0; i < 4; ++i) {
+                    wide[i] = h == 0 ? _mm_cvtepu16_epi32(channels[i]) : _mm_unpackhi_epi16(channels[i], zero);
+                }
+                __m128i value = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(wide[3], 30), _mm_slli_epi32(wide[0], 20)),
+                                             _mm_or_si128(_mm_slli_epi32(wide[1], 10), wide[2]));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (x + h * 4) * 4), value);
+            }
+        }
+        packRowSoftware<DEEP_LAYOUT_ARGB2101010>(planes, dst, x, width, row);
+    }
+
+    /**
+     * @brief Pack to rounded RGB24 with SSE4.1, 8 pixels per step
+     *
+     * Stored as two overlapping 16-byte writes, so a step must leave two
+     * pixels behind it.
+     */
+    __attribute__((target("sse4.1")))
+    void packRGBSSE41(uint16_t* const planes[4], uint8_t* dst, uint32_t width, uint32_t row) {
+        const __m128i half = _mm_set1_epi16(128);
+        const __m128i dropPad = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+        uint32_t end = width > 2 ? width - 2 : 0;
+        uint32_t x = 0;
+        for (; x + 8 <= end; x += 8) {
+            __m128i red = narrowTo8SSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[0] + x)), half);
+            __m128i green = narrowTo8SSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[1] + x)), half);
+            __m128i blue = narrowTo8SSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(planes[2] + x)), half);
+            __m128i redGreen = _mm_or_si128(red, _mm_slli_epi16(green, 8));
+            uint8_t* out = dst + x * 3;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_shuffle_epi8(_mm_unpacklo_epi16(redGreen, blue), dropPad));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12), _mm_shuffle_epi8(_mm_unpackhi_epi16(redGreen, blue), dropPad));
+        }
+        packRowSoftware<DEEP_LAYOUT_RGB24>(planes, dst, x, width, row);
+    }
+
+    enum Implementation {
+        IMPLEMENTATION_SOFTWARE,
+        IMPLEMENTATION_SSE41,
+        IMPLEMENTATION_AVX2
+    };
+
+    /**
+     * @brief Pick the widest kernels the CPU supports
+     */
+    Implementation detectImplementation() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return IMPLEMENTATION_AVX2;
+        if (__builtin_cpu_supports("sse4.1")) return IMPLEMENTATION_SSE41;
+        return IMPLEMENTATION_SOFTWARE;
+    }
+
+    const Implementation implementation = detectImplementation();
+#endif
+
+    void unpackV210(const uint8_t* src, uint16_t* const planes[4], uint32_t width, const DeepCoefficients& c) {
+        uint32_t groups = (width + 5) / 6;
+#if defined(DEEP_X86)
+        if (implementation == IMPLEMENTATION_AVX2) {
+            unpackV210AVX2(src, planes, groups);
+            convertYUVAVX2(planes, width, c);
+            return;
+        }
+        if (implementation == IMPLEMENTATION_SSE41) {
+            unpackV210SSE41(src, planes, 0, groups);
+            convertYUVSSE41(planes, width, c);
+            return;
+        }
+#endif
+        unpackV210Software(src, planes, 0, groups);
+        convertYUVSoftware(planes, 0, width, c);
+    }
+
+    void unpackSamples(DeepSource source, const uint8_t* src, uint16_t* const planes[4], uint32_t width) {
+        const SampleLayout& layout = sampleLayout(source);
+#if defined(DEEP_X86)
+        // Byte shuffles gain nothing from 256-bit lanes
+        if (implementation != IMPLEMENTATION_SOFTWARE) {
+            if (layout.bytes == 8) {
+                unpackSamplesSSE41<8>(layout, shuffleMasks(source), src, planes, width);
+            } else {
+                unpackSamplesSSE41<6>(layout, shuffleMasks(source), src, planes, width);
+            }
+            return;
+        }
+#endif
+        unpackSamplesSoftware(layout, src, planes, 0, width);
+    }
+
+    void packRow(uint16_t* const planes[4], uint8_t* dst, DeepLayout layout, uint32_t width, uint32_t row) {
+        switch (layout) {
+            case DEEP_LAYOUT_BGRA32:
+#if defined(DEEP_X86)
+                if (implementation == IMPLEMENTATION_AVX2) {
+                    packBGRAAVX2(planes, dst, width, row);
+                    return;
+                }
+                if (implementation == IMPLEMENTATION_SSE41) {
+                    packBGRASSE41(planes, dst, width, row);
+                    return;
+                }
+#endif
+                packRowSoftware<DEEP_LAYOUT_BGRA32>(planes, dst, 0, width, row);
+                break;
+            case DEEP_LAYOUT_ARGB2101010:
+#if defined(DEEP_X86)
+                if (implementation != IMPLEMENTATION_SOFTWARE) {
+                    packARGB2101010SSE41(planes, dst, width, row);
+                    return;
+                }
+#endif
+                packRowSoftware<DEEP_LAYOUT_ARGB2101010>(planes, dst, 0, width, row);
+                break;
+            case DEEP_LAYOUT_RGB24:
+#if defined(DEEP_X86)
+                if (implementation != IMPLEMENTATION_SOFTWARE) {
+                    packRGBSSE41(planes, dst, width, row);
+                    return;
+                }
+#endif
+                packRowSoftware<DEEP_LAYOUT_RGB24>(planes, dst, 0, width, row);
+                break;
+            case DEEP_LAYOUT_RGB48:
+                // Export only, where the disk is the bottleneck
+                packRowSoftware<DEEP_LAYOUT_RGB48>(planes, dst, 0, width, row);
+                break;
+        }
+    }
+}
+
+DeepCoefficients makeDeepCoefficients(YUVMatrix matrix, bool fullRange) {
+    double kr = matrix == YUV_MATRIX_BT709 ? 0.2126 : 0.299;
+    double kb = matrix == YUV_MATRIX_BT709 ? 0.0722 : 0.114;
+    double kg = 1.0 - kr - kb;
+    double lumaGain = 65535.0 / (fullRange ? 1023.0 : 876.0);
+    double chromaGain = 65535.0 / (fullRange ? 1023.0 : 896.0);
+
+    DeepCoefficients c;
+    c.yOffset = fullRange ? 0 : 64;
+    c.yScale = static_cast<int32_t>(std::floor(lumaGain * 8192.0 + 0.5));
+    c.redV = static_cast<int32_t>(std::floor(2.0 * (1.0 - kr) * chromaGain * 8192.0 + 0.5));
+    c.greenU = static_cast<int32_t>(std::floor(2.0 * (1.0 - kb) * kb / kg * chromaGain * 8192.0 + 0.5));
+    c.greenV = static_cast<int32_t>(std::floor(2.0 * (1.0 - kr) * kr / kg * chromaGain * 8192.0 + 0.5));
+    c.blueU = static_cast<int32_t>(std::floor(2.0 * (1.0 - kb) * chromaGain * 8192.0 + 0.5));
+    return c;
+}
+
+size_t deepScratchSize(uint32_t width) {
+    return planeStride(width) * 4;
+}
+
+void convertDeepRow(DeepSource source, const uint8_t* src, uint8_t* dst, DeepLayout layout,
+                    uint32_t width, uint32_t row, const DeepCoefficients& coefficients, uint16_t* scratch) {
+    size_t stride = planeStride(width);
+    uint16_t* planes[4] = {scratch, scratch + stride, scratch + stride * 2, scratch + stride * 3};
+
+    if (source == DEEP_SOURCE_V210) {
+        unpackV210(src, planes, width, coefficients);
+    } else {
+        unpackSamples(source, src, planes, width);
+    }
+    if (source != DEEP_SOURCE_BGRA64 && source != DEEP_SOURCE_B64A) {
+        std::fill(planes[3], planes[3] + width, static_cast<uint16_t>(0xFFFF));
+    }
+    packRow(planes, dst, layout, width, row);
+}
+
+const char* deepConvertImplementation() {
+#if defined(DEEP_X86)
+    if (implementation == IMPLEMENTATION_AVX2) return "avx2";
+    if (implementation == IMPLEMENTATION_SSE41) return "sse4.1";
+#endif
+    return "software";
+}
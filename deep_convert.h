@@ -0,0 +1,100 @@
+/**
+ * @file deep_convert.h
+ * @brief Conversion of high-bit-depth rows
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header declares the row kernels for 10-bit v210 and 16-bit per
+ * channel RGB frames. Rows are unpacked to 16-bit red, green, blue and
+ * alpha samples, then packed to an 8-bit display format with ordered
+ * dithering, to 10-bit ARGB2101010, or to RGB24 and RGB48 for export.
+ * The kernels use AVX2 or SSE4.1 when the CPU has them and a scalar
+ * routine otherwise; all paths produce the same bytes. Rows depend on
+ * nothing but their source row, so a frame can be split into bands that
+ * are converted on separate threads.
+ */
+
+#ifndef DEEP_CONVERT_H
+#define DEEP_CONVERT_H
+
+#include "yuv_convert.h"
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Layout of high-bit-depth source rows
+ */
+enum DeepSource {
+    DEEP_SOURCE_V210,   ///< 10-bit 4:2:2, six pixels in four little-endian words (v210)
+    DEEP_SOURCE_BGR48,  ///< Little-endian 16-bit B, G, R (48-bit BI_RGB)
+    DEEP_SOURCE_BGRA64, ///< Little-endian 16-bit B, G, R, A (64-bit BI_RGB)
+    DEEP_SOURCE_B48R,   ///< Big-endian 16-bit R, G, B (b48r)
+    DEEP_SOURCE_B64A    ///< Big-endian 16-bit A, R, G, B (b64a)
+};
+
+/**
+ * @brief Layout of converted high-bit-depth pixels
+ */
+enum DeepLayout {
+    DEEP_LAYOUT_BGRA32,         ///< B, G, R, A bytes with ordered dithering (SDL_PIXELFORMAT_ARGB8888)
+    DEEP_LAYOUT_ARGB2101010,    ///< 2-bit alpha and 10-bit channels in 32 bits, dithered (SDL_PIXELFORMAT_ARGB2101010)
+    DEEP_LAYOUT_RGB24,          ///< R, G, B bytes, rounded
+    DEEP_LAYOUT_RGB48           ///< Native-endian 16-bit R, G, B
+};
+
+/**
+ * @brief Fixed-point coefficients of 10-bit YUV to 16-bit RGB
+ *
+ * Gains are scaled by 8192; products of 10-bit samples stay well within
+ * 32 bits.
+ */
+struct DeepCoefficients {
+    int32_t yOffset;    ///< Black level of Y (64 for limited range)
+    int32_t yScale;     ///< Gain of Y to 16 bits
+    int32_t redV;       ///< Gain of V for red
+    int32_t greenU;     ///< Gain of U for green (subtracted)
+    int32_t greenV;     ///< Gain of V for green (subtracted)
+    int32_t blueU;      ///< Gain of U for blue
+};
+
+/**
+ * @brief Compute the coefficients of a 10-bit color space
+ *
+ * @param matrix Conversion matrix
+ * @param fullRange true for 0-1023 samples, false for limited (64-940/960) range
+ * @return Coefficients for convertDeepRow()
+ */
+DeepCoefficients makeDeepCoefficients(YUVMatrix matrix, bool fullRange);
+
+/**
+ * @brief Size of the scratch buffer of convertDeepRow()
+ *
+ * @param width Pixels in a row
+ * @return Number of 16-bit samples
+ */
+size_t deepScratchSize(uint32_t width);
+
+/**
+ * @brief Convert one row of high-bit-depth pixels
+ *
+ * @param source Layout of the source row
+ * @param src Source row; v210 rows must hold whole groups of six pixels
+ * @param dst Destination row
+ * @param layout Layout of the destination
+ * @param width Pixels in the row
+ * @param row Row of the destination in the frame, which selects the dither pattern
+ * @param coefficients Color space of v210 sources
+ * @param scratch Buffer of deepScratchSize() samples, not shared with other threads
+ */
+void convertDeepRow(DeepSource source, const uint8_t* src, uint8_t* dst, DeepLayout layout,
+                    uint32_t width, uint32_t row, const DeepCoefficients& coefficients, uint16_t* scratch);
+
+/**
+ * @brief Name of the implementation convertDeepRow() uses on this CPU
+ *
+ * @return "avx2", "sse4.1" or "software"
+ */
+const char* deepConvertImplementation();
+
+#endif // DEEP_CONVERT_H
@@ -0,0 +1,254 @@
+/**
+ * @file frame_analyzer.cpp
+ * @brief Implementation of the FrameAnalyzer class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "frame_analyzer.h"
+#include "mjpeg_decoder.h"
+#include "rle_decoder.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define ANALYZER_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define ANALYZER_NEON 1
+#endif
+
+namespace {
+    /**
+     * @brief Largest width of the luma images
+     */
+    const uint32_t kLumaWidth = 480;
+
+    /**
+     * @brief Frames per pool task
+     */
+    const uint32_t kRunFrames = 32;
+
+    /**
+     * @brief Sum of absolute differences of two byte arrays
+     *
+     * Uses psadbw on x86 (16 bytes per instruction) and vabd/vpadal on ARM.
+     */
+    uint64_t sumAbsDiff(const uint8_t* a, const uint8_t* b, size_t size) {
+        uint64_t sum = 0;
+        size_t i = 0;
+#if defined(ANALYZER_SSE2)
+        __m128i total = _mm_setzero_si128();
+        for (; i + 16 <= size; i += 16) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+            // Two 64-bit partial sums; cannot overflow for any frame size
+            total = _mm_add_epi64(total, _mm_sad_epu8(va, vb));
+        }
+        uint64_t lanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), total);
+        sum = lanes[0] + lanes[1];
+#elif defined(ANALYZER_NEON)
+        uint64x2_t total = vdupq_n_u64(0);
+        while (i + 16 <= size) {
+            // Each 16-bit lane gains at most 2 * 255 per block, so widen every 128 blocks
+            uint16x8_t partial = vdupq_n_u16(0);
+            for (int block = 0; block < 128 && i + 16 <= size; ++block, i += 16) {
+                partial = vpadalq_u8(partial, vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+            }
+            total = vpadalq_u32(total, vpaddlq_u16(partial));
+        }
+        sum = vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1);
+#endif
+        for (; i < size; ++i) {
+            sum += static_cast<uint64_t>(std::abs(static_cast<int>(a[i]) - static_cast<int>(b[i])));
+        }
+        return sum;
+    }
+}
+
+FrameAnalyzer::FrameAnalyzer(const AVIReader& reader, int streamNumber, unsigned threads)
+    : reader(reader), streamNumber(streamNumber), step(1), pool(threads), failed(false),
+      cutThreshold(30.0), freezeThreshold(0.5), frameSeconds(0) {
+}
+
+void FrameAnalyzer::setThresholds(double cut, double freeze) {
+    cutThreshold = cut;
+    freezeThreshold = freeze;
+}
+
+bool FrameAnalyzer::run() {
+    const AVIStream& stream = reader.getStream(streamNumber);
+    if (!stream.isVideo() || stream.chunkOffsets.empty()) {
+        std::cerr << "Error: Stream " << streamNumber << " is not a video stream" << std::endl;
+        return false;
+    }
+    if (!converter.configure(stream.bitmapHeader, stream.palette, stream.colorMasks)) {
+        std::cerr << "Error: Unsupported pixel format" << std::endl;
+        return false;
+    }
+
+    if (stream.header.rate > 0 && stream.header.scale > 0) {
+        frameSeconds = static_cast<double>(stream.header.scale) / stream.header.rate;
+    } else {
+        frameSeconds = reader.getMainHeader().microSecPerFrame / 1e6;
+    }
+
+    // Differences of whole-frame averages barely change with resolution,
+    // so large frames are decimated to keep the work per frame small
+    step = (converter.getWidth() + kLumaWidth - 1) / kLumaWidth;
+    if (step == 0) step = 1;
+
+    uint32_t count = stream.getChunkCount();
+    differences.assign(count, 0.0f);
+    failed = false;
+
+    for (uint32_t first = 0; first < count; first += kRunFrames) {
+        uint32_t runCount = std::min(kRunFrames, count - first);
+        pool.submit([this, first, runCount] { analyzeRun(first, runCount); });
+    }
+    pool.waitIdle();
+
+    if (failed) {
+        std::cerr << "Error: Failed to read frame data" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void FrameAnalyzer::analyzeRun(uint32_t first, uint32_t count) {
+    // Buffers per worker, reused across runs
+    static thread_local std::vector<uint8_t> frame;
+    static thread_local std::vector<uint8_t> rgb;
+    static thread_local std::vector<uint8_t> previous;
+    static thread_local std::vector<uint8_t> current;
+
+    const AVIStream& stream = reader.getStream(streamNumber);
+    uint32_t frameSize = converter.getSourceFrameSize();
+    if (frame.size() < stream.maxChunkSize) frame.resize(stream.maxChunkSize);
+
+    // RLE runs decode from the key frame before them
+    std::unique_ptr<RLEDecoder> decoder;
+    if (converter.isRunLength()) decoder.reset(new RLEDecoder(reader, streamNumber, converter));
+    std::unique_ptr<MJPEGDecoder> jpegDecoder;
+    if (converter.isMotionJPEG()) jpegDecoder.reset(new MJPEGDecoder(reader, streamNumber, converter));
+    auto load = [&](uint32_t index) -> const uint8_t* {
+        if (decoder) return decoder->decode(index, nullptr);
+        if (jpegDecoder) return jpegDecoder->decode(index, nullptr);
+        return reader.readChunk(streamNumber, index, frame.data(), frame.size()) ? frame.data() : nullptr;
+    };
+
+    // Start from the last complete frame before the run
+    previous.clear();
+    for (int64_t i = static_cast<int64_t>(first) - 1; i >= 0; --i) {
+        if (stream.chunkSizes[i] < frameSize) continue;
+        const uint8_t* frameData = load(static_cast<uint32_t>(i));
+        if (!frameData) {
+            failed = true;
+            return;
+        }
+        computeLuma(frameData, rgb, previous);
+        break;
+    }
+
+    for (uint32_t i = first; i < first + count; ++i) {
+        // Dropped frames repeat the previous image on screen
+        if (stream.chunkSizes[i] < frameSize) continue;
+
+        const uint8_t* frameData = load(i);
+        if (!frameData) {
+            failed = true;
+            return;
+        }
+        computeLuma(frameData, rgb, current);
+
+        if (!previous.empty()) {
+            differences[i] = static_cast<float>(
+                static_cast<double>(sumAbsDiff(previous.data(), current.data(), current.size())) / current.size());
+        }
+        previous.swap(current);
+    }
+}
+
+void FrameAnalyzer::computeLuma(const uint8_t* frameData, std::vector<uint8_t>& rgb, std::vector<uint8_t>& luma) const {
+    uint32_t width = converter.getWidth() / step;
+    uint32_t height = converter.getHeight() / step;
+    size_t pixels = static_cast<size_t>(width) * height;
+
+    rgb.resize(pixels * 3);
+    luma.resize(pixels);
+    converter.convertToRGB24(frameData, rgb.data(), static_cast<int>(width * 3), step);
+
+    // BT.601 luma weights in 8-bit fixed point
+    for (size_t i = 0; i < pixels; ++i) {
+        luma[i] = static_cast<uint8_t>((77 * rgb[i * 3 + 0] + 150 * rgb[i * 3 + 1] + 29 * rgb[i * 3 + 2]) >> 8);
+    }
+}
+
+std::vector<bool> FrameAnalyzer::findFrozen() const {
+    std::vector<bool> frozen(differences.size(), false);
+    uint32_t minimum = frameSeconds > 0 ? static_cast<uint32_t>(1.0 / frameSeconds + 0.5) : 1;
+    if (minimum < 2) minimum = 2;
+
+    // A stretch starts at the frame that the following still frames repeat
+    size_t start = 0;
+    for (size_t i = 1; i <= differences.size(); ++i) {
+        bool still = i < differences.size() && differences[i] <= freezeThreshold;
+        if (still) continue;
+        if (i - start >= minimum) {
+            std::fill(frozen.begin() + start, frozen.begin() + i, true);
+        }
+        start = i;
+    }
+    return frozen;
+}
+
+void FrameAnalyzer::writeTimeSeries(std::ostream& out) const {
+    std::vector<bool> frozen = findFrozen();
+
+    out << "frame,time,difference,event" << std::endl;
+    char line[96];
+    for (size_t i = 0; i < differences.size(); ++i) {
+        const char* event = "";
+        if (i > 0 && differences[i] >= cutThreshold) {
+            event = "cut";
+        } else if (frozen[i]) {
+            event = "frozen";
+        }
+        std::snprintf(line, sizeof(line), "%u,%.3f,%.3f,%s\n", static_cast<unsigned>(i),
+                      i * frameSeconds, differences[i], event);
+        out << line;
+    }
+    out.flush();
+}
+
+void FrameAnalyzer::printSummary(std::ostream& out) const {
+    std::vector<bool> frozen = findFrozen();
+    uint32_t cuts = 0;
+    uint32_t freezes = 0;
+
+    size_t i = 0;
+    while (i < differences.size()) {
+        if (i > 0 && differences[i] >= cutThreshold) {
+            out << "  Cut at frame " << i << " (" << (i * frameSeconds) << "s)" << std::endl;
+            cuts++;
+        }
+        if (frozen[i]) {
+            size_t end = i;
+            while (end < frozen.size() && frozen[end]) end++;
+            out << "  Frozen: frames " << i << "-" << (end - 1) << " ("
+                << (i * frameSeconds) << "s, " << ((end - i) * frameSeconds) << "s long)" << std::endl;
+            freezes++;
+            i = end;
+            continue;
+        }
+        i++;
+    }
+
+    out << "Scene cuts: " << cuts << ", frozen stretches: " << freezes << std::endl;
+}
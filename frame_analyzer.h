@@ -0,0 +1,138 @@
+/**
+ * @file frame_analyzer.h
+ * @brief Scene-cut and frozen-frame detection
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the FrameAnalyzer class, which measures how much the
+ * picture changes from one frame to the next and marks scene cuts and
+ * frozen stretches of a recording.
+ */
+
+#ifndef FRAME_ANALYZER_H
+#define FRAME_ANALYZER_H
+
+#include "avi_reader.h"
+#include "frame_converter.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief Frame difference analysis of a video stream
+ *
+ * Every frame is reduced to a luma image of at most 480 pixels across, and
+ * the difference between consecutive frames is the mean absolute luma
+ * difference (0 to 255), summed with SIMD instructions. Frames are
+ * processed in runs of consecutive frames on a thread pool; each run also
+ * reads the frame before it, so runs are independent.
+ *
+ * A frame whose difference reaches the cut threshold starts a new scene. A
+ * stretch of at least one second in which every difference stays at or
+ * below the freeze threshold is reported as frozen.
+ *
+ * Usage example:
+ * @code
+ * FrameAnalyzer analyzer(reader, reader.getVideoStream(), 0);
+ * if (analyzer.run()) {
+ *     analyzer.writeTimeSeries(std::cout);
+ * }
+ * @endcode
+ */
+class FrameAnalyzer {
+private:
+    const AVIReader& reader;         ///< Source of frame data
+    int streamNumber;                ///< Video stream to analyze
+    FrameConverter converter;        ///< Conversion of raw frames to RGB24
+    uint32_t step;                   ///< Decimation factor of the luma images
+    ThreadPool pool;                 ///< Workers for reads and differences
+    std::vector<float> differences;  ///< Mean absolute luma difference to the previous frame
+    std::atomic<bool> failed;        ///< Set when a read fails
+    double cutThreshold;             ///< Difference at which a cut is reported
+    double freezeThreshold;          ///< Difference at or below which frames count as frozen
+    double frameSeconds;             ///< Frame duration
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param reader Open reader; must outlive this object
+     * @param streamNumber Video stream to analyze
+     * @param threads Worker threads; 0 uses one per hardware thread
+     */
+    FrameAnalyzer(const AVIReader& reader, int streamNumber, unsigned threads);
+
+    /**
+     * @brief Set the detection thresholds
+     *
+     * @param cut Mean luma difference that marks a scene cut (default 30)
+     * @param freeze Mean luma difference at or below which a frame is frozen (default 0.5)
+     */
+    void setThresholds(double cut, double freeze);
+
+    /**
+     * @brief Compute the differences of all frames
+     *
+     * @return true on success, false if the format is unsupported or a read failed
+     */
+    bool run();
+
+    /**
+     * @brief Write the per-frame time series as CSV
+     *
+     * Columns: frame, time in seconds, difference, and "cut" or "frozen".
+     *
+     * @param out Destination stream
+     */
+    void writeTimeSeries(std::ostream& out) const;
+
+    /**
+     * @brief Print the detected cuts and frozen stretches
+     *
+     * @param out Destination stream
+     */
+    void printSummary(std::ostream& out) const;
+
+    /** @brief Difference of each frame to the previous one */
+    const std::vector<float>& getDifferences() const { return differences; }
+
+    /** @brief Frame duration in seconds */
+    double getFrameSeconds() const { return frameSeconds; }
+
+    /** @brief Worker threads used by run() */
+    unsigned getThreadCount() const { return pool.getThreadCount(); }
+
+private:
+    FrameAnalyzer(const FrameAnalyzer&);
+    FrameAnalyzer& operator=(const FrameAnalyzer&);
+
+    /**
+     * @brief Compute the differences of a run of consecutive frames
+     *
+     * Runs on a pool worker.
+     *
+     * @param first First frame of the run
+     * @param count Number of frames
+     */
+    void analyzeRun(uint32_t first, uint32_t count);
+
+    /**
+     * @brief Reduce a raw frame to a luma image
+     *
+     * @param frameData Raw frame data
+     * @param rgb Scratch buffer for the decimated RGB24 image
+     * @param luma Receives the luma image
+     */
+    void computeLuma(const uint8_t* frameData, std::vector<uint8_t>& rgb, std::vector<uint8_t>& luma) const;
+
+    /**
+     * @brief Mark the frames of frozen stretches
+     *
+     * @return Per frame, true if it belongs to a frozen stretch
+     */
+    std::vector<bool> findFrozen() const;
+};
+
+#endif // FRAME_ANALYZER_H
@@ -0,0 +1,78 @@
+/**
+ * @file frame_cache.cpp
+ * @brief Implementation of the FrameCache class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "frame_cache.h"
+
+FrameCache::FrameCache(size_t budgetBytes)
+    : budgetBytes(budgetBytes), usedBytes(0), hits(0), misses(0) {
+}
+
+void FrameCache::setBudget(size_t bytes) {
+    budgetBytes = bytes;
+    makeRoom(0);
+    if (budgetBytes == 0) {
+        std::vector<uint8_t>().swap(spare);
+    }
+}
+
+const uint8_t* FrameCache::find(uint32_t frameIndex) {
+    if (budgetBytes == 0) return nullptr;
+
+    auto it = lookup.find(frameIndex);
+    if (it == lookup.end()) {
+        misses++;
+        return nullptr;
+    }
+
+    // Move to the front of the LRU list
+    entries.splice(entries.begin(), entries, it->second);
+    hits++;
+    return it->second->data.data();
+}
+
+uint8_t* FrameCache::insert(uint32_t frameIndex, size_t size) {
+    if (size == 0 || size > budgetBytes) return nullptr;
+
+    // Replace an existing entry for the same frame
+    auto it = lookup.find(frameIndex);
+    if (it != lookup.end()) {
+        usedBytes -= it->second->data.size();
+        spare.swap(it->second->data);
+        entries.erase(it->second);
+        lookup.erase(it);
+    }
+
+    makeRoom(size);
+
+    entries.push_front(Entry());
+    Entry& entry = entries.front();
+    entry.frameIndex = frameIndex;
+    entry.data.swap(spare);   // Reuse storage of the last evicted frame
+    entry.data.resize(size);
+
+    lookup[frameIndex] = entries.begin();
+    usedBytes += size;
+
+    return entry.data.data();
+}
+
+void FrameCache::clear() {
+    entries.clear();
+    lookup.clear();
+    usedBytes = 0;
+}
+
+void FrameCache::makeRoom(size_t size) {
+    while (!entries.empty() && usedBytes + size > budgetBytes) {
+        Entry& victim = entries.back();
+        usedBytes -= victim.data.size();
+        lookup.erase(victim.frameIndex);
+        spare.swap(victim.data);
+        entries.pop_back();
+    }
+}
@@ -0,0 +1,129 @@
+/**
+ * @file frame_cache.h
+ * @brief Byte-budgeted LRU cache of display-ready frames
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the FrameCache class, which keeps recently converted
+ * frames in memory so that scrubbing and loop playback can redisplay them
+ * without touching the disk or running the pixel conversion again.
+ */
+
+#ifndef FRAME_CACHE_H
+#define FRAME_CACHE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief LRU cache of converted frames keyed by frame index
+ *
+ * Entries hold frames in the texture's pixel format with a tight row pitch.
+ * The total size of all entries never exceeds the byte budget; inserting a
+ * frame evicts the least recently used entries as needed and recycles their
+ * storage, so a warm cache performs no allocations.
+ *
+ * A budget of zero disables the cache: lookups return nullptr and inserts
+ * are refused. The cache is not thread-safe and is meant to be owned by the
+ * playback loop.
+ */
+class FrameCache {
+private:
+    /**
+     * @brief Cached frame
+     */
+    struct Entry {
+        uint32_t frameIndex;        ///< Frame index used as key
+        std::vector<uint8_t> data;  ///< Converted pixel data
+    };
+
+    std::list<Entry> entries;       ///< Entries, most recently used first
+    std::unordered_map<uint32_t, std::list<Entry>::iterator> lookup; ///< Index into entries
+    std::vector<uint8_t> spare;     ///< Storage recycled from the last eviction
+
+    size_t budgetBytes;             ///< Maximum number of cached bytes
+    size_t usedBytes;               ///< Bytes currently held by entries
+    uint64_t hits;                  ///< Number of successful lookups
+    uint64_t misses;                ///< Number of failed lookups
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param budgetBytes Maximum number of bytes to cache (0 disables the cache)
+     */
+    explicit FrameCache(size_t budgetBytes = 0);
+
+    /**
+     * @brief Change the byte budget
+     *
+     * Shrinking the budget evicts entries immediately.
+     *
+     * @param bytes New maximum number of cached bytes
+     */
+    void setBudget(size_t bytes);
+
+    /**
+     * @brief Look up a frame
+     *
+     * On a hit the entry becomes the most recently used one. The returned
+     * pointer stays valid until the next call to insert(), setBudget() or
+     * clear().
+     *
+     * @param frameIndex Frame to look up
+     * @return Pointer to the cached pixels, or nullptr on a miss
+     */
+    const uint8_t* find(uint32_t frameIndex);
+
+    /**
+     * @brief Reserve an entry for a frame
+     *
+     * Evicts least recently used entries until @p size bytes fit in the
+     * budget and returns storage for the caller to fill. Any existing entry
+     * for the same frame is replaced.
+     *
+     * @param frameIndex Frame being inserted
+     * @param size Size of the converted frame in bytes
+     * @return Pointer to @p size writable bytes, or nullptr if the frame does not fit the budget
+     */
+    uint8_t* insert(uint32_t frameIndex, size_t size);
+
+    /**
+     * @brief Drop all entries
+     *
+     * The hit and miss counters are kept.
+     */
+    void clear();
+
+    /** @brief True if the cache has a non-zero budget */
+    bool isEnabled() const { return budgetBytes > 0; }
+
+    /** @brief Maximum number of cached bytes */
+    size_t getBudget() const { return budgetBytes; }
+
+    /** @brief Bytes currently held by entries */
+    size_t getUsedBytes() const { return usedBytes; }
+
+    /** @brief Number of cached frames */
+    size_t getEntryCount() const { return entries.size(); }
+
+    /** @brief Number of lookups that found a frame */
+    uint64_t getHits() const { return hits; }
+
+    /** @brief Number of lookups that missed */
+    uint64_t getMisses() const { return misses; }
+
+private:
+    /**
+     * @brief Evict least recently used entries until @p size more bytes fit
+     *
+     * @param size Number of bytes that must fit in the budget
+     */
+    void makeRoom(size_t size);
+};
+
+#endif // FRAME_CACHE_H
@@ -0,0 +1,1152 @@
+/**
+ * @file frame_converter.cpp
+ * @brief Implementation of the FrameConverter class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "frame_converter.h"
+#include "mjpeg_decoder.h"
+#include "thread_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define CONVERTER_SSE2 1
+#endif
+
+namespace {
+    /**
+     * @brief Fewest rows of a band of a high-bit-depth frame
+     */
+    const uint32_t kBandRows = 32;
+
+    /**
+     * @brief Rows compared and converted together by convertChanges()
+     */
+    const uint32_t kChangeBandRows = 16;
+
+    /**
+     * @brief Build a FourCC code as stored in biCompression
+     */
+    uint32_t makeFourCC(char a, char b, char c, char d) {
+        return static_cast<uint32_t>(static_cast<uint8_t>(a)) |
+               (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8) |
+               (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) |
+               (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+    }
+
+    /**
+     * @brief Copy rows between buffers of different strides
+     */
+    void copyPlane(const uint8_t* src, size_t srcPitch, uint8_t* dst, size_t dstPitch, size_t rowBytes, uint32_t rows) {
+        for (uint32_t y = 0; y < rows; ++y) {
+            std::memcpy(dst + y * dstPitch, src + y * srcPitch, rowBytes);
+        }
+    }
+
+    /**
+     * @brief Widen a channel level to 8 bits by repeating its bits
+     *
+     * @param level Level of the channel
+     * @param bits Width of the channel, 1 to 8
+     */
+    uint8_t widenLevel(uint32_t level, uint32_t bits) {
+        uint32_t value = 0;
+        for (int shift = 8 - static_cast<int>(bits); ; shift -= static_cast<int>(bits)) {
+            value |= shift >= 0 ? level << shift : level >> -shift;
+            if (shift <= 0) break;
+        }
+        return static_cast<uint8_t>(value);
+    }
+
+    /**
+     * @brief Widen a channel of 4 to 8 bits, as widenLevel() for a constant width
+     */
+    template <uint32_t Bits>
+    inline uint32_t widen(uint32_t level) {
+        return (level << (8 - Bits)) | (level >> (2 * Bits - 8));
+    }
+
+    /**
+     * @brief Load a little-endian pixel of any alignment
+     */
+    template <typename Pixel>
+    inline uint32_t loadPixel(const uint8_t* p) {
+        Pixel pixel;
+        std::memcpy(&pixel, p, sizeof(Pixel));
+        return pixel;
+    }
+
+    // Source formats: read() returns one pixel as R, G, B, A
+
+    /** @brief 8-bit palette index */
+    struct SourceIndexed8 {
+        enum { bytes = 1 };
+        static inline void read(const PixelTables& tables, const uint8_t* p, uint8_t rgba[4]) {
+            const uint8_t* color = tables.colors + p[0] * 3;
+            rgba[0] = color[0];
+            rgba[1] = color[1];
+            rgba[2] = color[2];
+            rgba[3] = 255;
+        }
+    };
+
+    /** @brief B, G, R bytes, the 24-bit DIB layout */
+    struct SourceBGR24 {
+        enum { bytes = 3 };
+        static inline void read(const PixelTables&, const uint8_t* p, uint8_t rgba[4]) {
+            rgba[0] = p[2];
+            rgba[1] = p[1];
+            rgba[2] = p[0];
+            rgba[3] = 255;
+        }
+    };
+
+    /** @brief R, G, B bytes of decoded RLE images */
+    struct SourceRGB24 {
+        enum { bytes = 3 };
+        static inline void read(const PixelTables&, const uint8_t* p, uint8_t rgba[4]) {
+            rgba[0] = p[0];
+            rgba[1] = p[1];
+            rgba[2] = p[2];
+            rgba[3] = 255;
+        }
+    };
+
+    /** @brief B, G, R, X or A bytes, XRGB8888 and ARGB8888 */
+    struct SourceBGRA32 {
+        enum { bytes = 4 };
+        static inline void read(const PixelTables&, const uint8_t* p, uint8_t rgba[4]) {
+            rgba[0] = p[2];
+            rgba[1] = p[1];
+            rgba[2] = p[0];
+            rgba[3] = p[3];
+        }
+    };
+
+    /** @brief 16-bit pixels with channel positions known at compile time */
+    template <uint32_t RedShift, uint32_t RedBits, uint32_t GreenShift, uint32_t GreenBits,
+              uint32_t BlueShift, uint32_t BlueBits>
+    struct SourcePacked16 {
+        enum { bytes = 2 };
+        static inline void read(const PixelTables&, const uint8_t* p, uint8_t rgba[4]) {
+            uint32_t value = loadPixel<uint16_t>(p);
+            rgba[0] = static_cast<uint8_t>(widen<RedBits>((value >> RedShift) & ((1u << RedBits) - 1)));
+            rgba[1] = static_cast<uint8_t>(widen<GreenBits>((value >> GreenShift) & ((1u << GreenBits) - 1)));
+            rgba[2] = static_cast<uint8_t>(widen<BlueBits>((value >> BlueShift) & ((1u << BlueBits) - 1)));
+            rgba[3] = 255;
+        }
+    };
+
+    /** @brief 16- or 32-bit pixels with any masks, through the channel tables */
+    template <typename Pixel>
+    struct SourceMasked {
+        enum { bytes = sizeof(Pixel) };
+        static inline void read(const PixelTables& tables, const uint8_t* p, uint8_t rgba[4]) {
+            uint32_t value = loadPixel<Pixel>(p);
+            for (int i = 0; i < 4; ++i) {
+                const ColorChannel& channel = tables.channels[i];
+                rgba[i] = channel.levels[(value >> channel.shift) & channel.mask];
+            }
+        }
+    };
+
+    // Destination formats: write() stores R, G, B, A
+
+    /** @brief R, G, B bytes, SDL_PIXELFORMAT_RGB24 */
+    struct DestinationRGB24 {
+        enum { bytes = 3 };
+        static inline void write(uint8_t* p, const uint8_t rgba[4]) {
+            p[0] = rgba[0];
+            p[1] = rgba[1];
+            p[2] = rgba[2];
+        }
+    };
+
+    /** @brief B, G, R, A bytes, SDL_PIXELFORMAT_ARGB8888 on little-endian */
+    struct DestinationBGRA32 {
+        enum { bytes = 4 };
+        static inline void write(uint8_t* p, const uint8_t rgba[4]) {
+            p[0] = rgba[2];
+            p[1] = rgba[1];
+            p[2] = rgba[0];
+            p[3] = rgba[3];
+        }
+    };
+
+    /**
+     * @brief Convert every step-th pixel of a row
+     *
+     * A RowKernel, and the inner loop of the frame kernels.
+     */
+    template <class Source, class Destination>
+    void convertRow(const PixelTables& tables, const uint8_t* src, uint8_t* dst, uint32_t count, uint32_t step) {
+        uint8_t rgba[4];
+        for (uint32_t x = 0; x < count; ++x) {
+            Source::read(tables, src + static_cast<size_t>(x) * step * Source::bytes, rgba);
+            Destination::write(dst + static_cast<size_t>(x) * Destination::bytes, rgba);
+        }
+    }
+
+    /**
+     * @brief Convert a frame, a FrameKernel
+     *
+     * @tparam TopDown True if the first row of the source is the top one
+     * @tparam Contiguous True if source rows are not padded, so that a
+     *         top-down frame written without padding is a single row
+     */
+    template <class Source, class Destination, bool TopDown, bool Contiguous>
+    void convertFrame(const PixelTables& tables, const uint8_t* frameData, size_t sourceStride,
+                      uint8_t* pixels, int pitch, uint32_t width, uint32_t height) {
+        if (Contiguous && TopDown && static_cast<size_t>(pitch) == static_cast<size_t>(width) * Destination::bytes) {
+            convertRow<Source, Destination>(tables, frameData, pixels, width * height, 1);
+            return;
+        }
+        for (uint32_t y = 0; y < height; ++y) {
+            uint32_t srcY = TopDown ? y : height - 1 - y;
+            convertRow<Source, Destination>(tables, frameData + srcY * sourceStride, pixels + y * pitch, width, 1);
+        }
+    }
+
+    /**
+     * @brief Copy a frame whose pixels SDL takes as they are, a FrameKernel
+     *
+     * Only the row order and the padding change.
+     */
+    template <uint32_t Bytes, bool TopDown, bool Contiguous>
+    void copyFrame(const PixelTables&, const uint8_t* frameData, size_t sourceStride,
+                   uint8_t* pixels, int pitch, uint32_t width, uint32_t height) {
+        size_t rowBytes = static_cast<size_t>(width) * Bytes;
+        if (Contiguous && TopDown && static_cast<size_t>(pitch) == rowBytes) {
+            std::memcpy(pixels, frameData, rowBytes * height);
+            return;
+        }
+        for (uint32_t y = 0; y < height; ++y) {
+            uint32_t srcY = TopDown ? y : height - 1 - y;
+            std::memcpy(pixels + y * pitch, frameData + srcY * sourceStride, rowBytes);
+        }
+    }
+
+    /**
+     * @brief Instantiation of convertFrame() for a row order and stride class
+     */
+    template <class Source, class Destination>
+    FrameKernel selectConversion(bool topDown, bool contiguous) {
+        if (topDown) {
+            return contiguous ? convertFrame<Source, Destination, true, true> : convertFrame<Source, Destination, true, false>;
+        }
+        return contiguous ? convertFrame<Source, Destination, false, true> : convertFrame<Source, Destination, false, false>;
+    }
+
+    /**
+     * @brief Instantiation of copyFrame() for a row order and stride class
+     */
+    template <uint32_t Bytes>
+    FrameKernel selectCopy(bool topDown, bool contiguous) {
+        if (topDown) {
+            return contiguous ? copyFrame<Bytes, true, true> : copyFrame<Bytes, true, false>;
+        }
+        return contiguous ? copyFrame<Bytes, false, true> : copyFrame<Bytes, false, false>;
+    }
+
+    /**
+     * @brief Add a row of bytes to 16-bit column sums
+     *
+     * @param sums Running sums, one per byte of the row
+     * @param row Source row
+     * @param size Number of bytes in the row
+     */
+    void accumulateRow(uint16_t* sums, const uint8_t* row, size_t size) {
+        size_t i = 0;
+#if defined(CONVERTER_SSE2)
+        const __m128i zero = _mm_setzero_si128();
+        for (; i + 16 <= size; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            __m128i* low = reinterpret_cast<__m128i*>(sums + i);
+            __m128i* high = reinterpret_cast<__m128i*>(sums + i + 8);
+            _mm_storeu_si128(low, _mm_add_epi16(_mm_loadu_si128(low), _mm_unpacklo_epi8(bytes, zero)));
+            _mm_storeu_si128(high, _mm_add_epi16(_mm_loadu_si128(high), _mm_unpackhi_epi8(bytes, zero)));
+        }
+#endif
+        for (; i < size; ++i) {
+            sums[i] = static_cast<uint16_t>(sums[i] + row[i]);
+        }
+    }
+
+    /**
+     * @brief Find the first byte where two buffers differ
+     *
+     * @return Index of that byte, or size if they are equal
+     */
+    size_t firstDifference(const uint8_t* a, const uint8_t* b, size_t size) {
+        size_t i = 0;
+#if defined(CONVERTER_SSE2)
+        for (; i + 16 <= size; i += 16) {
+            __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+            if (_mm_movemask_epi8(equal) != 0xFFFF) break;
+        }
+#endif
+        while (i < size && a[i] == b[i]) ++i;
+        return i;
+    }
+
+    /**
+     * @brief Find the end of the last difference between two buffers
+     *
+     * @return One past the last byte that differs, or 0 if they are equal
+     */
+    size_t lastDifference(const uint8_t* a, const uint8_t* b, size_t size) {
+        size_t i = size;
+#if defined(CONVERTER_SSE2)
+        for (; i >= 16; i -= 16) {
+            __m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i - 16)),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i - 16)));
+            if (_mm_movemask_epi8(equal) != 0xFFFF) break;
+        }
+#endif
+        while (i > 0 && a[i - 1] == b[i - 1]) --i;
+        return i;
+    }
+
+    /**
+     * @brief Widen a range of changed bytes to cover a row's changes
+     *
+     * Bytes already inside [first, last) are not compared again.
+     *
+     * @param a Row of the new frame
+     * @param b Same row of the previous frame
+     * @param size Bytes in the row
+     * @param first First changed byte so far, size if none
+     * @param last One past the last changed byte so far
+     */
+    void widenChange(const uint8_t* a, const uint8_t* b, size_t size, size_t& first, size_t& last) {
+        first = firstDifference(a, b, first);
+        if (first >= size) return;
+        size_t from = std::max(first, last);
+        size_t end = lastDifference(a + from, b + from, size - from);
+        if (end != 0) last = from + end;
+    }
+}
+
+FrameConverter::FrameConverter()
+    : width(0), height(0), bitsPerPixel(0), bytesPerPixel(0), topDown(false),
+      yuvLayout(YUV_NONE), chromaWidth(0), chromaHeight(0), runLengthBits(0), motionJPEG(false), maskLayout(MASKS_NONE),
+      frameKernel(nullptr), rowKernel(nullptr), bgraRowKernel(nullptr),
+      yuvCoefficients(makeYUVCoefficients(YUV_MATRIX_BT601, false)), rgbOutput(false),
+      highDepth(false), deepSource(DEEP_SOURCE_V210), deepCoefficients(makeDeepCoefficients(YUV_MATRIX_BT601, false)),
+      tenBitOutput(false), bandPool(nullptr),
+      pixelFormat(SDL_PIXELFORMAT_UNKNOWN), displayPitch(0), displayFrameSize(0), scaled(false),
+      sourceStride(0), sourceFrameSize(0) {
+    std::memset(&tables, 0, sizeof(tables));
+}
+
+bool FrameConverter::configure(const BitmapInfoHeader& bitmapHeader, const std::vector<RGBQuad>& streamPalette,
+                               const BitmapColorMasks& colorMasks) {
+    width = bitmapHeader.width > 0 ? static_cast<uint32_t>(bitmapHeader.width) : 0;
+    bitsPerPixel = bitmapHeader.bitCount;
+    bytesPerPixel = (bitsPerPixel + 7) / 8;
+    runLengthBits = 0;
+    motionJPEG = false;
+    maskLayout = MASKS_NONE;
+    frameKernel = nullptr;
+    rowKernel = nullptr;
+    bgraRowKernel = nullptr;
+    scaled = false;
+
+    std::memset(tables.colors, 0, sizeof(tables.colors));
+    for (size_t i = 0; i < streamPalette.size() && i < 256; ++i) {
+        tables.colors[i * 3 + 0] = streamPalette[i].red;
+        tables.colors[i * 3 + 1] = streamPalette[i].green;
+        tables.colors[i * 3 + 2] = streamPalette[i].blue;
+    }
+
+    // Uncompressed YUV is identified by its FourCC
+    uint32_t compression = bitmapHeader.compression;
+    yuvLayout = YUV_NONE;
+    if (compression == makeFourCC('Y', 'U', 'Y', '2') || compression == makeFourCC('Y', 'U', 'Y', 'V')) {
+        yuvLayout = YUV_YUY2;
+    } else if (compression == makeFourCC('U', 'Y', 'V', 'Y')) {
+        yuvLayout = YUV_UYVY;
+    } else if (compression == makeFourCC('I', '4', '2', '0') || compression == makeFourCC('I', 'Y', 'U', 'V')) {
+        yuvLayout = YUV_I420;
+    } else if (compression == makeFourCC('Y', 'V', '1', '2')) {
+        yuvLayout = YUV_YV12;
+    } else if (compression == makeFourCC('N', 'V', '1', '2')) {
+        yuvLayout = YUV_NV12;
+    }
+
+    // So are v210 and the QuickTime 16-bit RGB formats; DIBs of 48 and 64
+    // bits are plain BI_RGB
+    highDepth = true;
+    if (compression == makeFourCC('v', '2', '1', '0')) {
+        deepSource = DEEP_SOURCE_V210;
+    } else if (compression == makeFourCC('b', '4', '8', 'r')) {
+        deepSource = DEEP_SOURCE_B48R;
+    } else if (compression == makeFourCC('b', '6', '4', 'a')) {
+        deepSource = DEEP_SOURCE_B64A;
+    } else if (compression == 0 && bitsPerPixel == 48) {
+        deepSource = DEEP_SOURCE_BGR48;
+    } else if (compression == 0 && bitsPerPixel == 64) {
+        deepSource = DEEP_SOURCE_BGRA64;
+    } else {
+        highDepth = false;
+    }
+    bool fourCC = highDepth && compression != 0;
+    bool jpeg = compression == makeFourCC('M', 'J', 'P', 'G') || compression == makeFourCC('m', 'j', 'p', 'g');
+
+    // Handle negative height (indicates top-down bitmap); YUV and FourCC
+    // frames are top-down whatever the sign
+    if (bitmapHeader.height < 0 || yuvLayout != YUV_NONE || fourCC || jpeg) {
+        topDown = true;
+        height = static_cast<uint32_t>(bitmapHeader.height < 0 ? -bitmapHeader.height : bitmapHeader.height);
+        std::cout << "  Image orientation: Top-down" << std::endl;
+    } else {
+        topDown = false;
+        height = static_cast<uint32_t>(bitmapHeader.height);
+        std::cout << "  Image orientation: Bottom-up" << std::endl;
+    }
+
+    if (yuvLayout != YUV_NONE) {
+        // Handed to a YUV texture as stored unless converted for display
+        chromaWidth = (width + 1) / 2;
+        chromaHeight = (height + 1) / 2;
+        if (yuvLayout == YUV_YUY2 || yuvLayout == YUV_UYVY) {
+            sourceFrameSize = chromaWidth * 4 * height;
+            std::cout << "  Format: " << (yuvLayout == YUV_YUY2 ? "YUY2" : "UYVY") << " 4:2:2" << std::endl;
+        } else {
+            sourceFrameSize = width * height + chromaWidth * chromaHeight * 2;
+            std::cout << "  Format: " << (yuvLayout == YUV_I420 ? "I420" : yuvLayout == YUV_YV12 ? "YV12" : "NV12")
+                      << " 4:2:0" << std::endl;
+        }
+
+        // SDL's choice for YUV textures, so that every path shows the same colors
+        yuvCoefficients = makeYUVCoefficients(height > 576 ? YUV_MATRIX_BT709 : YUV_MATRIX_BT601, false);
+        updateDisplayFormat();
+        return true;
+    }
+
+    if (highDepth) {
+        if (deepSource == DEEP_SOURCE_V210) {
+            // Groups of six pixels in 16 bytes, rows padded to 48 pixels
+            sourceStride = ((width + 47) / 48) * 128;
+            deepCoefficients = makeDeepCoefficients(height > 576 ? YUV_MATRIX_BT709 : YUV_MATRIX_BT601, false);
+            std::cout << "  Format: v210 10-bit 4:2:2" << std::endl;
+        } else {
+            bool alpha = deepSource == DEEP_SOURCE_BGRA64 || deepSource == DEEP_SOURCE_B64A;
+            uint32_t unpadded = width * (alpha ? 8 : 6);
+            sourceStride = unpadded;
+            if (!fourCC && bitmapHeader.sizeImage != unpadded * height) {
+                sourceStride = (unpadded + 3) & ~3u;
+            }
+            std::cout << "  Format: " << (alpha ? "64-bit RGBA" : "48-bit RGB")
+                      << (fourCC ? (alpha ? " (b64a)" : " (b48r)") : "") << std::endl;
+        }
+        sourceFrameSize = sourceStride * height;
+        updateDisplayFormat();
+        return true;
+    }
+
+    // Motion-JPEG is decoded to a top-down ARGB8888 image
+    if (jpeg) {
+        if (!MJPEGDecoder::isAvailable()) {
+            std::cerr << "Error: MJPG support not compiled in (build with libjpeg-turbo)" << std::endl;
+            return false;
+        }
+        motionJPEG = true;
+        bytesPerPixel = 4;
+        pixelFormat = SDL_PIXELFORMAT_ARGB8888;
+        displayPitch = width * 4;
+        displayFrameSize = displayPitch * height;
+        // An empty chunk is a dropped frame, any other one a whole image
+        sourceStride = displayPitch;
+        sourceFrameSize = 1;
+        std::cout << "  Format: Motion-JPEG" << std::endl;
+        selectKernels();
+        return true;
+    }
+
+    // BI_RLE8 and BI_RLE4 are decoded to a top-down RGB24 image
+    if ((compression == 1 && bitsPerPixel == 8) || (compression == 2 && bitsPerPixel == 4)) {
+        runLengthBits = bitsPerPixel;
+        topDown = true;
+        bytesPerPixel = 3;
+        pixelFormat = SDL_PIXELFORMAT_RGB24;
+        displayPitch = width * 3;
+        displayFrameSize = displayPitch * height;
+        // Any chunk is a valid frame; an empty one repeats the previous image
+        sourceStride = displayPitch;
+        sourceFrameSize = 0;
+        std::cout << "  Format: " << bitsPerPixel << "-bit RLE" << std::endl;
+        selectKernels();
+        return true;
+    }
+
+    // Only support uncompressed formats; BI_BITFIELDS and
+    // BI_ALPHABITFIELDS only describe 16- and 32-bit pixels
+    bool bitFields = compression == 3 || compression == 6;
+    if (compression != 0 && !(bitFields && (bitsPerPixel == 16 || bitsPerPixel == 32))) {
+        std::cerr << "Error: Compressed formats not supported (compression = "
+                  << bitmapHeader.compression << ")" << std::endl;
+        return false;
+    }
+
+    switch (bitsPerPixel) {
+        case 8:
+            // 8-bit indexed color
+            pixelFormat = SDL_PIXELFORMAT_RGB24; // We'll convert to RGB24
+            displayPitch = width * 3;
+            std::cout << "  Format: 8-bit indexed color" << std::endl;
+            break;
+        case 16:
+        case 32: {
+            // Masks of BI_BITFIELDS, or the BI_RGB defaults of RGB555 and XRGB8888
+            BitmapColorMasks masks = colorMasks;
+            if (!bitFields) {
+                masks.red = bitsPerPixel == 16 ? 0x7C00 : 0x00FF0000;
+                masks.green = bitsPerPixel == 16 ? 0x03E0 : 0x0000FF00;
+                masks.blue = bitsPerPixel == 16 ? 0x001F : 0x000000FF;
+                masks.alpha = 0;
+            }
+            if (!configureMasks(masks)) return false;
+            break;
+        }
+        case 24:
+            // 24-bit RGB (stored as BGR in AVI)
+            pixelFormat = SDL_PIXELFORMAT_RGB24;
+            displayPitch = width * 3;
+            std::cout << "  Format: 24-bit RGB" << std::endl;
+            break;
+        default:
+            std::cerr << "Error: Unsupported bit depth: " << bitsPerPixel << std::endl;
+            return false;
+    }
+
+    // DIB rows are padded to four bytes; tolerate writers that leave the
+    // padding out but say so in biSizeImage
+    sourceStride = ((width * bitsPerPixel + 31) / 32) * 4;
+    uint32_t unpadded = width * bytesPerPixel;
+    if (sourceStride != unpadded && bitmapHeader.sizeImage == unpadded * height) {
+        sourceStride = unpadded;
+    }
+    sourceFrameSize = sourceStride * height;
+    displayFrameSize = displayPitch * height;
+
+    selectKernels();
+    return true;
+}
+
+void FrameConverter::selectKernels() {
+    bool contiguous = sourceStride == width * bytesPerPixel;
+
+    if (runLengthBits != 0) {
+        frameKernel = selectCopy<3>(true, true);
+        rowKernel = convertRow<SourceRGB24, DestinationRGB24>;
+        bgraRowKernel = convertRow<SourceRGB24, DestinationBGRA32>;
+        return;
+    }
+    if (motionJPEG) {
+        frameKernel = selectCopy<4>(true, true);
+        rowKernel = convertRow<SourceBGRA32, DestinationRGB24>;
+        bgraRowKernel = convertRow<SourceBGRA32, DestinationBGRA32>;
+        return;
+    }
+
+    switch (bitsPerPixel) {
+        case 8:
+            frameKernel = selectConversion<SourceIndexed8, DestinationRGB24>(topDown, contiguous);
+            rowKernel = convertRow<SourceIndexed8, DestinationRGB24>;
+            bgraRowKernel = convertRow<SourceIndexed8, DestinationBGRA32>;
+            return;
+        case 24:
+            frameKernel = selectConversion<SourceBGR24, DestinationRGB24>(topDown, contiguous);
+            rowKernel = convertRow<SourceBGR24, DestinationRGB24>;
+            bgraRowKernel = convertRow<SourceBGR24, DestinationBGRA32>;
+            return;
+    }
+
+    switch (maskLayout) {
+        case MASKS_RGB555:
+            frameKernel = selectCopy<2>(topDown, contiguous);
+            rowKernel = convertRow<SourcePacked16<10, 5, 5, 5, 0, 5>, DestinationRGB24>;
+            bgraRowKernel = convertRow<SourcePacked16<10, 5, 5, 5, 0, 5>, DestinationBGRA32>;
+            break;
+        case MASKS_RGB565:
+            frameKernel = selectCopy<2>(topDown, contiguous);
+            rowKernel = convertRow<SourcePacked16<11, 5, 5, 6, 0, 5>, DestinationRGB24>;
+            bgraRowKernel = convertRow<SourcePacked16<11, 5, 5, 6, 0, 5>, DestinationBGRA32>;
+            break;
+        case MASKS_XRGB8888:
+        case MASKS_ARGB8888:
+            frameKernel = selectCopy<4>(topDown, contiguous);
+            rowKernel = convertRow<SourceBGRA32, DestinationRGB24>;
+            bgraRowKernel = convertRow<SourceBGRA32, DestinationBGRA32>;
+            break;
+        case MASKS_GENERIC:
+            if (bitsPerPixel == 16) {
+                frameKernel = selectConversion<SourceMasked<uint16_t>, DestinationBGRA32>(topDown, contiguous);
+                rowKernel = convertRow<SourceMasked<uint16_t>, DestinationRGB24>;
+                bgraRowKernel = convertRow<SourceMasked<uint16_t>, DestinationBGRA32>;
+            } else {
+                frameKernel = selectConversion<SourceMasked<uint32_t>, DestinationBGRA32>(topDown, contiguous);
+                rowKernel = convertRow<SourceMasked<uint32_t>, DestinationRGB24>;
+                bgraRowKernel = convertRow<SourceMasked<uint32_t>, DestinationBGRA32>;
+            }
+            break;
+        case MASKS_NONE:
+            break;
+    }
+}
+
+bool FrameConverter::configureMasks(const BitmapColorMasks& colorMasks) {
+    uint32_t masks[4] = { colorMasks.red, colorMasks.green, colorMasks.blue, colorMasks.alpha };
+    uint32_t pixelMask = bitsPerPixel == 16 ? 0xFFFFu : 0xFFFFFFFFu;
+
+    for (int i = 0; i < 4; ++i) {
+        ColorChannel& channel = tables.channels[i];
+        uint32_t mask = masks[i];
+        uint32_t shift = 0;
+        uint32_t bits = 0;
+        while (mask != 0 && (mask & 1) == 0) {
+            mask >>= 1;
+            shift++;
+        }
+        while (mask & 1) {
+            mask >>= 1;
+            bits++;
+        }
+
+        // Each channel is one run of bits inside the pixel; only alpha may be missing
+        if ((bits == 0 && i < 3) || mask != 0 || (masks[i] & ~pixelMask) != 0) {
+            std::cerr << "Error: Invalid color masks " << std::hex << colorMasks.red << "/" << colorMasks.green
+                      << "/" << colorMasks.blue << "/" << colorMasks.alpha << std::dec << std::endl;
+            return false;
+        }
+
+        // Wide channels keep their highest 8 bits
+        uint32_t kept = std::min(bits, 8u);
+        channel.shift = shift + bits - kept;
+        channel.mask = bits > 0 ? (1u << kept) - 1 : 0;
+        if (bits == 0) {
+            // Missing alpha is opaque
+            channel.levels[0] = 255;
+            continue;
+        }
+        for (uint32_t level = 0; level <= channel.mask; ++level) {
+            channel.levels[level] = widenLevel(level, kept);
+        }
+    }
+
+    bool xrgb = colorMasks.red == 0x00FF0000 && colorMasks.green == 0x0000FF00 && colorMasks.blue == 0x000000FF;
+    if (bitsPerPixel == 16 && colorMasks.red == 0x7C00 && colorMasks.green == 0x03E0 &&
+        colorMasks.blue == 0x001F && colorMasks.alpha == 0) {
+        maskLayout = MASKS_RGB555;
+        pixelFormat = SDL_PIXELFORMAT_RGB555;
+        std::cout << "  Format: 16-bit RGB555" << std::endl;
+    } else if (bitsPerPixel == 16 && colorMasks.red == 0xF800 && colorMasks.green == 0x07E0 &&
+               colorMasks.blue == 0x001F && colorMasks.alpha == 0) {
+        maskLayout = MASKS_RGB565;
+        pixelFormat = SDL_PIXELFORMAT_RGB565;
+        std::cout << "  Format: 16-bit RGB565" << std::endl;
+    } else if (bitsPerPixel == 32 && xrgb && colorMasks.alpha == 0) {
+        maskLayout = MASKS_XRGB8888;
+        pixelFormat = SDL_PIXELFORMAT_RGB888;
+        std::cout << "  Format: 32-bit XRGB8888" << std::endl;
+    } else if (bitsPerPixel == 32 && xrgb && colorMasks.alpha == 0xFF000000) {
+        maskLayout = MASKS_ARGB8888;
+        pixelFormat = SDL_PIXELFORMAT_ARGB8888;
+        std::cout << "  Format: 32-bit ARGB8888" << std::endl;
+    } else {
+        maskLayout = MASKS_GENERIC;
+        pixelFormat = SDL_PIXELFORMAT_ARGB8888;
+        std::cout << "  Format: " << bitsPerPixel << "-bit masks " << std::hex << colorMasks.red << "/"
+                  << colorMasks.green << "/" << colorMasks.blue << "/" << colorMasks.alpha << std::dec
+                  << ", converted to ARGB8888" << std::endl;
+    }
+
+    displayPitch = maskLayout == MASKS_GENERIC ? width * 4 : width * bytesPerPixel;
+    return true;
+}
+
+void FrameConverter::setRGBOutput(bool enable) {
+    rgbOutput = enable;
+    updateDisplayFormat();
+}
+
+void FrameConverter::setTenBitOutput(bool enable) {
+    tenBitOutput = enable;
+    updateDisplayFormat();
+}
+
+void FrameConverter::setOutputSize(uint32_t outputWidth, uint32_t outputHeight) {
+    scaled = outputWidth < width || outputHeight < height;
+    if (scaled) {
+        resampler.configure(width, height, outputWidth, outputHeight);
+    }
+}
+
+void FrameConverter::updateDisplayFormat() {
+    if (highDepth) {
+        pixelFormat = tenBitOutput ? SDL_PIXELFORMAT_ARGB2101010 : SDL_PIXELFORMAT_ARGB8888;
+        displayPitch = width * 4;
+        displayFrameSize = displayPitch * height;
+        return;
+    }
+
+    switch (yuvLayout) {
+        case YUV_NONE:
+            return;
+        case YUV_YUY2:
+        case YUV_UYVY:
+            pixelFormat = yuvLayout == YUV_YUY2 ? SDL_PIXELFORMAT_YUY2 : SDL_PIXELFORMAT_UYVY;
+            displayPitch = chromaWidth * 4;
+            displayFrameSize = displayPitch * height;
+            break;
+        default:
+            pixelFormat = yuvLayout == YUV_I420 ? SDL_PIXELFORMAT_IYUV :
+                          yuvLayout == YUV_YV12 ? SDL_PIXELFORMAT_YV12 : SDL_PIXELFORMAT_NV12;
+            displayPitch = width;
+            displayFrameSize = width * height + chromaWidth * chromaHeight * 2;
+            break;
+    }
+
+    if (rgbOutput) {
+        // B, G, R, A in memory, the native layout of software renderers
+        pixelFormat = SDL_PIXELFORMAT_ARGB8888;
+        displayPitch = width * 4;
+        displayFrameSize = displayPitch * height;
+    }
+}
+
+void FrameConverter::getPlanes(const uint8_t* frame, const uint8_t* planes[3], int pitches[3]) const {
+    if (isPassThrough()) {
+        getSourcePlanes(frame, planes, pitches);
+        return;
+    }
+    planes[0] = frame;
+    pitches[0] = static_cast<int>(getDisplayPitch());
+    planes[1] = planes[2] = nullptr;
+    pitches[1] = pitches[2] = 0;
+}
+
+void FrameConverter::getSourcePlanes(const uint8_t* frame, const uint8_t* planes[3], int pitches[3]) const {
+    bool packed = yuvLayout == YUV_YUY2 || yuvLayout == YUV_UYVY;
+    planes[0] = frame;
+    pitches[0] = static_cast<int>(packed ? chromaWidth * 4 : width);
+    planes[1] = planes[2] = nullptr;
+    pitches[1] = pitches[2] = 0;
+
+    const uint8_t* chroma = frame + static_cast<size_t>(width) * height;
+    if (yuvLayout == YUV_I420 || yuvLayout == YUV_YV12) {
+        size_t planeSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+        planes[1] = yuvLayout == YUV_I420 ? chroma : chroma + planeSize;
+        planes[2] = yuvLayout == YUV_I420 ? chroma + planeSize : chroma;
+        pitches[1] = pitches[2] = static_cast<int>(chromaWidth);
+    } else if (yuvLayout == YUV_NV12) {
+        planes[1] = planes[2] = chroma;
+        pitches[1] = pitches[2] = static_cast<int>(chromaWidth * 2);
+    }
+}
+
+void FrameConverter::convert(const uint8_t* frameData, uint8_t* pixels, int pitch) const {
+    if (scaled) {
+        // Each row is converted into a scratch row and filtered away
+        // before the next, so it stays in the cache
+        std::vector<uint16_t> scratch(highDepth ? deepScratchSize(width) : 0);
+        resampler.resample([this, frameData, &scratch](uint32_t y, uint8_t* row) {
+            convertRowBGRA(frameData, y, row, scratch.data());
+        }, pixels, pitch);
+        return;
+    }
+    if (yuvLayout != YUV_NONE) {
+        if (rgbOutput) {
+            convertYUV(frameData, pixels, pitch, RGB_LAYOUT_BGRA32);
+        } else {
+            copyYUV(frameData, pixels, pitch);
+        }
+        return;
+    }
+    if (highDepth) {
+        convertHighDepth(frameData, pixels, pitch, tenBitOutput ? DEEP_LAYOUT_ARGB2101010 : DEEP_LAYOUT_BGRA32);
+        return;
+    }
+
+    frameKernel(tables, frameData, sourceStride, pixels, pitch, width, height);
+}
+
+void FrameConverter::convertChanges(const uint8_t* frameData, uint8_t* reference, uint8_t* pixels, int pitch,
+                                    std::vector<SDL_Rect>& regions) const {
+    regions.clear();
+    size_t rowBytes = static_cast<size_t>(width) * bytesPerPixel;
+    uint32_t displayBytes = displayPitch / width;
+    bool adjacent = false;
+
+    for (uint32_t y = 0; y < height; y += kChangeBandRows) {
+        uint32_t rows = std::min(kChangeBandRows, height - y);
+        uint32_t firstRow = topDown ? y : height - (y + rows);
+        size_t first = rowBytes;
+        size_t last = 0;
+        for (uint32_t r = 0; r < rows; ++r) {
+            size_t offset = static_cast<size_t>(firstRow + r) * sourceStride;
+            widenChange(frameData + offset, reference + offset, rowBytes, first, last);
+        }
+        if (first >= rowBytes) {
+            adjacent = false;
+            continue;
+        }
+
+        // Convert the changed columns of the band and remember them
+        uint32_t x0 = static_cast<uint32_t>(first / bytesPerPixel);
+        uint32_t x1 = static_cast<uint32_t>((last + bytesPerPixel - 1) / bytesPerPixel);
+        const uint8_t* src = frameData + static_cast<size_t>(firstRow) * sourceStride + static_cast<size_t>(x0) * bytesPerPixel;
+        uint8_t* dst = pixels + static_cast<size_t>(y) * pitch + static_cast<size_t>(x0) * displayBytes;
+        frameKernel(tables, src, sourceStride, dst, pitch, x1 - x0, rows);
+        for (uint32_t r = 0; r < rows; ++r) {
+            size_t offset = static_cast<size_t>(firstRow + r) * sourceStride + first;
+            std::memcpy(reference + offset, frameData + offset, last - first);
+        }
+
+        // Bands that touch are uploaded together
+        SDL_Rect band = { static_cast<int>(x0), static_cast<int>(y), static_cast<int>(x1 - x0), static_cast<int>(rows) };
+        if (adjacent) {
+            SDL_Rect& region = regions.back();
+            int right = std::max(region.x + region.w, band.x + band.w);
+            region.x = std::min(region.x, band.x);
+            region.w = right - region.x;
+            region.h += band.h;
+        } else {
+            regions.push_back(band);
+        }
+        adjacent = true;
+    }
+}
+
+void FrameConverter::convertToRGB24(const uint8_t* frameData, uint8_t* pixels, int pitch, uint32_t step) const {
+    if (step == 0) step = 1;
+    uint32_t outWidth = width / step;
+    uint32_t outHeight = height / step;
+
+    if (yuvLayout != YUV_NONE) {
+        if (step == 1) {
+            convertYUV(frameData, pixels, pitch, RGB_LAYOUT_RGB24);
+            return;
+        }
+        uint8_t sample[3];
+        for (uint32_t y = 0; y < outHeight; ++y) {
+            uint8_t* dst = pixels + y * pitch;
+            for (uint32_t x = 0; x < outWidth; ++x) {
+                sampleYUV(frameData, x * step, y * step, sample);
+                convertYUVPixel(sample[0], sample[1], sample[2], dst + x * 3, yuvCoefficients);
+            }
+        }
+        return;
+    }
+
+    if (highDepth) {
+        if (step == 1) {
+            convertHighDepth(frameData, pixels, pitch, DEEP_LAYOUT_RGB24);
+            return;
+        }
+        // Whole rows are converted, then decimated
+        std::vector<uint16_t> scratch(deepScratchSize(width));
+        std::vector<uint8_t> row(static_cast<size_t>(width) * 3);
+        for (uint32_t y = 0; y < outHeight; ++y) {
+            uint32_t srcY = topDown ? y * step : (height - 1 - y * step);
+            convertDeepRow(deepSource, frameData + static_cast<size_t>(srcY) * sourceStride, row.data(),
+                           DEEP_LAYOUT_RGB24, width, y, deepCoefficients, scratch.data());
+            uint8_t* dst = pixels + y * pitch;
+            for (uint32_t x = 0; x < outWidth; ++x) {
+                std::memcpy(dst + x * 3, row.data() + static_cast<size_t>(x) * step * 3, 3);
+            }
+        }
+        return;
+    }
+
+    for (uint32_t y = 0; y < outHeight; ++y) {
+        uint32_t srcY = topDown ? y * step : (height - 1 - y * step);
+        rowKernel(tables, frameData + static_cast<size_t>(srcY) * sourceStride, pixels + y * pitch, outWidth, step);
+    }
+}
+
+void FrameConverter::convertToRGB24Box(const uint8_t* frameData, uint8_t* pixels, int pitch, uint32_t factor) const {
+    // 16-bit column sums hold 257 rows of 255
+    if (factor == 0) factor = 1;
+    if (factor > 256) factor = 256;
+    uint32_t outWidth = width / factor;
+    uint32_t outHeight = height / factor;
+    uint32_t area = factor * factor;
+
+    if (yuvLayout == YUV_NONE) {
+        // Bytes of channels are summed as they are, interleaved. Indexed,
+        // packed and high-bit-depth pixels are expanded to RGB24 row by row
+        // first, and decoded RLE images are RGB24 already; the others,
+        // decoded MJPG included, are BGR(A).
+        bool byteChannels = !highDepth && (runLengthBits != 0 || motionJPEG || bitsPerPixel == 24 ||
+                                           maskLayout == MASKS_XRGB8888 || maskLayout == MASKS_ARGB8888);
+        size_t channelBytes = byteChannels ? bytesPerPixel : 3;
+        size_t red = byteChannels && runLengthBits == 0 ? 2 : 0;
+        size_t blue = 2 - red;
+        size_t rowBytes = static_cast<size_t>(outWidth) * factor * channelBytes;
+        std::vector<uint16_t> sums(rowBytes);
+        std::vector<uint8_t> expanded(byteChannels ? 0 : (highDepth ? static_cast<size_t>(width) * 3 : rowBytes));
+        std::vector<uint16_t> scratch(highDepth ? deepScratchSize(width) : 0);
+
+        for (uint32_t y = 0; y < outHeight; ++y) {
+            std::fill(sums.begin(), sums.end(), 0);
+            for (uint32_t r = 0; r < factor; ++r) {
+                uint32_t srcY = topDown ? y * factor + r : (height - 1 - (y * factor + r));
+                const uint8_t* src = frameData + static_cast<size_t>(srcY) * sourceStride;
+                if (highDepth) {
+                    convertDeepRow(deepSource, src, expanded.data(), DEEP_LAYOUT_RGB24, width, r,
+                                   deepCoefficients, scratch.data());
+                    src = expanded.data();
+                } else if (!byteChannels) {
+                    rowKernel(tables, src, expanded.data(), outWidth * factor, 1);
+                    src = expanded.data();
+                }
+                accumulateRow(sums.data(), src, rowBytes);
+            }
+
+            uint8_t* dst = pixels + y * pitch;
+            const uint16_t* column = sums.data();
+            for (uint32_t x = 0; x < outWidth; ++x) {
+                uint32_t b = 0, g = 0, r = 0;
+                for (uint32_t k = 0; k < factor; ++k, column += channelBytes) {
+                    b += column[blue];
+                    g += column[1];
+                    r += column[red];
+                }
+                dst[x * 3 + 0] = static_cast<uint8_t>((r + area / 2) / area);
+                dst[x * 3 + 1] = static_cast<uint8_t>((g + area / 2) / area);
+                dst[x * 3 + 2] = static_cast<uint8_t>((b + area / 2) / area);
+            }
+        }
+        return;
+    }
+
+    // YUV pixels are converted before they are summed
+    std::vector<uint32_t> sums(static_cast<size_t>(outWidth) * 3);
+    for (uint32_t y = 0; y < outHeight; ++y) {
+        std::fill(sums.begin(), sums.end(), 0);
+        for (uint32_t r = 0; r < factor; ++r) {
+            uint32_t srcY = y * factor + r;
+            for (uint32_t x = 0; x < outWidth * factor; ++x) {
+                uint32_t* sum = &sums[(x / factor) * 3];
+                uint8_t sample[3];
+                uint8_t rgb[3];
+                sampleYUV(frameData, x, srcY, sample);
+                convertYUVPixel(sample[0], sample[1], sample[2], rgb, yuvCoefficients);
+                sum[0] += rgb[0];
+                sum[1] += rgb[1];
+                sum[2] += rgb[2];
+            }
+        }
+
+        uint8_t* dst = pixels + y * pitch;
+        for (uint32_t i = 0; i < outWidth * 3; ++i) {
+            dst[i] = static_cast<uint8_t>((sums[i] + area / 2) / area);
+        }
+    }
+}
+
+void FrameConverter::convertToRGB48(const uint8_t* frameData, uint8_t* pixels, int pitch) const {
+    if (highDepth) {
+        convertHighDepth(frameData, pixels, pitch, DEEP_LAYOUT_RGB48);
+    }
+}
+
+void FrameConverter::convertHighDepth(const uint8_t* frameData, uint8_t* pixels, int pitch, DeepLayout layout) const {
+    uint32_t bands = bandPool ? std::min(bandPool->getThreadCount(), height / kBandRows) : 1;
+    if (bands <= 1) {
+        convertHighDepthRows(frameData, pixels, pitch, layout, 0, height);
+        return;
+    }
+
+    for (uint32_t i = 0; i < bands; ++i) {
+        uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(height) * i / bands);
+        uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(height) * (i + 1) / bands);
+        bandPool->submit([this, frameData, pixels, pitch, layout, first, end]() {
+            convertHighDepthRows(frameData, pixels, pitch, layout, first, end - first);
+        });
+    }
+    bandPool->waitIdle();
+}
+
+void FrameConverter::convertHighDepthRows(const uint8_t* frameData, uint8_t* pixels, int pitch, DeepLayout layout,
+                                          uint32_t first, uint32_t count) const {
+    std::vector<uint16_t> scratch(deepScratchSize(width));
+    for (uint32_t y = first; y < first + count; ++y) {
+        uint32_t srcY = topDown ? y : height - 1 - y;
+        convertDeepRow(deepSource, frameData + static_cast<size_t>(srcY) * sourceStride,
+                       pixels + static_cast<size_t>(y) * pitch, layout, width, y, deepCoefficients, scratch.data());
+    }
+}
+
+void FrameConverter::decodeRLE(const uint8_t* data, size_t size, uint8_t* pixels, int pitch) const {
+    const uint8_t* end = data + size;
+    const uint8_t* lut = tables.colors;
+    bool nibbles = runLengthBits == 4;
+    // Rows are counted from the bottom of the bitmap
+    uint32_t x = 0;
+    uint32_t y = 0;
+
+    while (end - data >= 2 && y < height) {
+        uint32_t count = data[0];
+        uint32_t value = data[1];
+        data += 2;
+        uint8_t* row = pixels + static_cast<size_t>(height - 1 - y) * pitch;
+        uint32_t visible = x < width ? std::min(count, width - x) : 0;
+
+        if (count > 0) {
+            // Encoded run of one index, or of two alternating nibbles
+            const uint8_t* first = lut + (nibbles ? value >> 4 : value) * 3;
+            const uint8_t* second = lut + (nibbles ? value & 0x0F : value) * 3;
+            uint8_t* dst = row + static_cast<size_t>(x) * 3;
+            for (uint32_t i = 0; i < visible; ++i, dst += 3) {
+                const uint8_t* color = (i & 1) ? second : first;
+                dst[0] = color[0];
+                dst[1] = color[1];
+                dst[2] = color[2];
+            }
+            x += count;
+            continue;
+        }
+
+        switch (value) {
+            case 0:
+                // End of line
+                x = 0;
+                ++y;
+                break;
+            case 1:
+                // End of bitmap
+                return;
+            case 2:
+                // Skip right and up, leaving the pixels of the previous frame
+                if (end - data < 2) return;
+                x += data[0];
+                y += data[1];
+                data += 2;
+                break;
+            default: {
+                // Absolute run of value indices, padded to 16 bits
+                size_t bytes = nibbles ? (value + 1) / 2 : value;
+                if (static_cast<size_t>(end - data) < bytes) return;
+                visible = x < width ? std::min(value, width - x) : 0;
+                uint8_t* dst = row + static_cast<size_t>(x) * 3;
+                for (uint32_t i = 0; i < visible; ++i, dst += 3) {
+                    uint32_t index = nibbles ? (data[i / 2] >> ((i & 1) ? 0 : 4)) & 0x0F : data[i];
+                    const uint8_t* color = lut + index * 3;
+                    dst[0] = color[0];
+                    dst[1] = color[1];
+                    dst[2] = color[2];
+                }
+                x += value;
+                data += std::min(bytes + (bytes & 1), static_cast<size_t>(end - data));
+                break;
+            }
+        }
+    }
+}
+
+void FrameConverter::convertRowBGRA(const uint8_t* frameData, uint32_t y, uint8_t* dst, uint16_t* scratch) const {
+    if (yuvLayout != YUV_NONE) {
+        const uint8_t* planes[3];
+        int pitches[3];
+        getSourcePlanes(frameData, planes, pitches);
+        YUVSource source = yuvLayout == YUV_YUY2 ? YUV_SOURCE_YUY2 :
+                           yuvLayout == YUV_UYVY ? YUV_SOURCE_UYVY :
+                           yuvLayout == YUV_NV12 ? YUV_SOURCE_NV12 : YUV_SOURCE_PLANAR;
+        size_t chromaRow = static_cast<size_t>(y / 2);
+        const uint8_t* u = planes[1] ? planes[1] + chromaRow * pitches[1] : nullptr;
+        const uint8_t* v = planes[2] ? planes[2] + chromaRow * pitches[2] : nullptr;
+        convertYUVRow(source, planes[0] + static_cast<size_t>(y) * pitches[0], u, v, dst,
+                      RGB_LAYOUT_BGRA32, width, yuvCoefficients);
+        return;
+    }
+
+    uint32_t srcY = topDown ? y : height - 1 - y;
+    const uint8_t* src = frameData + static_cast<size_t>(srcY) * sourceStride;
+    if (highDepth) {
+        convertDeepRow(deepSource, src, dst, DEEP_LAYOUT_BGRA32, width, y, deepCoefficients, scratch);
+    } else {
+        bgraRowKernel(tables, src, dst, width, 1);
+    }
+}
+
+void FrameConverter::convertYUV(const uint8_t* frameData, uint8_t* pixels, int pitch, RGBLayout layout) const {
+    const uint8_t* planes[3];
+    int pitches[3];
+    getSourcePlanes(frameData, planes, pitches);
+
+    YUVSource source = yuvLayout == YUV_YUY2 ? YUV_SOURCE_YUY2 :
+                       yuvLayout == YUV_UYVY ? YUV_SOURCE_UYVY :
+                       yuvLayout == YUV_NV12 ? YUV_SOURCE_NV12 : YUV_SOURCE_PLANAR;
+    for (uint32_t y = 0; y < height; ++y) {
+        size_t chromaRow = static_cast<size_t>(y / 2);
+        const uint8_t* u = planes[1] ? planes[1] + chromaRow * pitches[1] : nullptr;
+        const uint8_t* v = planes[2] ? planes[2] + chromaRow * pitches[2] : nullptr;
+        convertYUVRow(source, planes[0] + static_cast<size_t>(y) * pitches[0], u, v,
+                      pixels + static_cast<size_t>(y) * pitch, layout, width, yuvCoefficients);
+    }
+}
+
+void FrameConverter::copyYUV(const uint8_t* frameData, uint8_t* pixels, int pitch) const {
+    const uint8_t* planes[3];
+    int pitches[3];
+    getSourcePlanes(frameData, planes, pitches);
+
+    if (yuvLayout == YUV_YUY2 || yuvLayout == YUV_UYVY) {
+        copyPlane(frameData, pitches[0], pixels, pitch, pitches[0], height);
+        return;
+    }
+
+    copyPlane(planes[0], width, pixels, pitch, width, height);
+    uint8_t* chroma = pixels + static_cast<size_t>(pitch) * height;
+    if (yuvLayout == YUV_NV12) {
+        size_t chromaPitch = static_cast<size_t>((pitch + 1) / 2) * 2;
+        copyPlane(planes[1], chromaWidth * 2, chroma, chromaPitch, chromaWidth * 2, chromaHeight);
+    } else {
+        // The planes keep their order, so YV12 stays YV12
+        size_t chromaPitch = static_cast<size_t>((pitch + 1) / 2);
+        const uint8_t* first = yuvLayout == YUV_I420 ? planes[1] : planes[2];
+        const uint8_t* second = yuvLayout == YUV_I420 ? planes[2] : planes[1];
+        copyPlane(first, chromaWidth, chroma, chromaPitch, chromaWidth, chromaHeight);
+        copyPlane(second, chromaWidth, chroma + chromaPitch * chromaHeight, chromaPitch, chromaWidth, chromaHeight);
+    }
+}
+
+void FrameConverter::sampleYUV(const uint8_t* frameData, uint32_t x, uint32_t y, uint8_t sample[3]) const {
+    if (yuvLayout == YUV_YUY2 || yuvLayout == YUV_UYVY) {
+        // Two pixels share one four-byte group
+        const uint8_t* group = frameData + static_cast<size_t>(y) * chromaWidth * 4 + (x / 2) * 4;
+        if (yuvLayout == YUV_YUY2) {
+            sample[0] = group[(x & 1) * 2];
+            sample[1] = group[1];
+            sample[2] = group[3];
+        } else {
+            sample[0] = group[1 + (x & 1) * 2];
+            sample[1] = group[0];
+            sample[2] = group[2];
+        }
+        return;
+    }
+
+    const uint8_t* planes[3];
+    int pitches[3];
+    getSourcePlanes(frameData, planes, pitches);
+    size_t chromaRow = static_cast<size_t>(y / 2);
+    sample[0] = planes[0][static_cast<size_t>(y) * width + x];
+    if (yuvLayout == YUV_NV12) {
+        const uint8_t* pair = planes[1] + chromaRow * pitches[1] + (x / 2) * 2;
+        sample[1] = pair[0];
+        sample[2] = pair[1];
+    } else {
+        sample[1] = planes[1][chromaRow * pitches[1] + x / 2];
+        sample[2] = planes[2][chromaRow * pitches[2] + x / 2];
+    }
+}
\ No newline at end of file
@@ -0,0 +1,511 @@
+/**
+ * @file frame_converter.h
+ * @brief Conversion of raw AVI frames to SDL texture formats
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the FrameConverter class, which turns the raw bitmap
+ * of one video stream into a top-down frame in a pixel format SDL can
+ * upload directly. YUV frames are passed through to SDL YUV textures, or
+ * converted to RGB where the renderer cannot take them.
+ */
+
+#ifndef FRAME_CONVERTER_H
+#define FRAME_CONVERTER_H
+
+#include "avi_format.h"
+#include "deep_convert.h"
+#include "resampler.h"
+#include "yuv_convert.h"
+#include <SDL2/SDL.h>
+#include <vector>
+
+class ThreadPool;
+
+/**
+ * @brief One channel of a pixel described by a color mask
+ */
+struct ColorChannel {
+    uint32_t shift;                  ///< Position of the highest 8 bits of the channel
+    uint32_t mask;                   ///< Mask of the shifted channel, 0 if absent
+    uint8_t levels[256];             ///< 8-bit value of every level of the channel
+};
+
+/**
+ * @brief Lookup tables read by the conversion kernels
+ */
+struct PixelTables {
+    uint8_t colors[256 * 3];         ///< RGB24 color of every palette index, black past the palette
+    ColorChannel channels[4];        ///< Red, green, blue and alpha of masked 16- and 32-bit pixels
+};
+
+/**
+ * @brief Conversion of a whole frame for display
+ *
+ * @param tables Palette and channel tables of the stream
+ * @param frameData Source frame
+ * @param sourceStride Row stride of the source in bytes
+ * @param pixels Destination buffer
+ * @param pitch Row stride of the destination in bytes
+ * @param width Pixels per row
+ * @param height Rows
+ */
+typedef void (*FrameKernel)(const PixelTables& tables, const uint8_t* frameData, size_t sourceStride,
+                            uint8_t* pixels, int pitch, uint32_t width, uint32_t height);
+
+/**
+ * @brief Conversion of one row to RGB24
+ *
+ * @param tables Palette and channel tables of the stream
+ * @param src Source row
+ * @param dst Destination row
+ * @param count Pixels to write
+ * @param step Source pixels per written pixel
+ */
+typedef void (*RowKernel)(const PixelTables& tables, const uint8_t* src, uint8_t* dst, uint32_t count, uint32_t step);
+
+/**
+ * @brief Pixel format converter for one video stream
+ *
+ * Configured once from the stream's bitmap header and palette, after which
+ * convert() may be called from any thread.
+ *
+ * Supported formats:
+ * - 8-bit indexed color (with palette), converted to RGB24
+ * - 16-bit RGB555 (the BI_RGB default) and RGB565, uploaded as they are
+ * - 24-bit BGR, converted to RGB24
+ * - 32-bit XRGB8888 (the BI_RGB default) and ARGB8888, uploaded as they are
+ * - 16- and 32-bit BI_BITFIELDS with any other masks, converted to ARGB8888
+ * - BI_RLE8 and BI_RLE4 run-length encoded indexed color, decoded to RGB24
+ *   with decodeRLE()
+ * - YUY2 and UYVY (4:2:2), I420/IYUV, YV12 and NV12 (4:2:0), kept as they
+ *   are for the matching SDL YUV texture format, or converted to ARGB8888
+ *   after setRGBOutput()
+ * - 10-bit v210 (4:2:2), 48-bit RGB and 64-bit RGBA (BI_RGB, or the b48r
+ *   and b64a FourCCs), dithered to ARGB8888, or to ARGB2101010 after
+ *   setTenBitOutput(); convertToRGB48() keeps 16 bits per channel
+ * - Motion-JPEG (MJPG), decoded to ARGB8888 by MJPEGDecoder when built
+ *   with libjpeg-turbo
+ *
+ * Run-length encoded frames only describe the pixels that changed since
+ * the previous frame, so they are decoded onto a persistent image (see
+ * RLEDecoder). For these streams, the source frames given to convert()
+ * and the RGB24 conversions are the decoded images. The same holds for
+ * MJPG streams, whose frames are decoded independently.
+ *
+ * RGB, indexed and decoded RLE frames go through kernels instantiated from
+ * templates over the source format, the destination format, the row order
+ * and whether rows are padded. configure() picks the instantiations for the
+ * stream once, so the loops have no per-row or per-pixel branches.
+ *
+ * The RGB24 conversions used by export, analysis and the video wall also
+ * accept the YUV formats. YUV is taken as limited range, BT.601 up to 576
+ * rows and BT.709 above, which is what SDL assumes for YUV textures, and
+ * whole rows are converted with the SIMD kernels of yuv_convert.h.
+ * High-bit-depth rows go through the kernels of deep_convert.h; given a
+ * thread pool, their frames are converted in bands of rows in parallel.
+ *
+ * After setOutputSize() with a smaller size, convert() shrinks frames of
+ * any format to ARGB8888 at that size: rows are converted one at a time
+ * and fed to a Resampler, so only the output resolution is written.
+ */
+class FrameConverter {
+public:
+    /**
+     * @brief Layout of YUV source frames
+     */
+    enum YUVLayout {
+        YUV_NONE,       ///< Not a YUV format
+        YUV_YUY2,       ///< Packed 4:2:2, Y0 U Y1 V
+        YUV_UYVY,       ///< Packed 4:2:2, U Y0 V Y1
+        YUV_I420,       ///< Planar 4:2:0, Y then U then V
+        YUV_YV12,       ///< Planar 4:2:0, Y then V then U
+        YUV_NV12        ///< Y plane, then interleaved U and V
+    };
+
+private:
+    /**
+     * @brief Arrangement of the channels of 16- and 32-bit sources
+     */
+    enum MaskLayout {
+        MASKS_NONE,         ///< Not a 16- or 32-bit format
+        MASKS_RGB555,       ///< x1R5G5B5, SDL_PIXELFORMAT_RGB555
+        MASKS_RGB565,       ///< R5G6B5, SDL_PIXELFORMAT_RGB565
+        MASKS_XRGB8888,     ///< x8R8G8B8, SDL_PIXELFORMAT_RGB888
+        MASKS_ARGB8888,     ///< A8R8G8B8, SDL_PIXELFORMAT_ARGB8888
+        MASKS_GENERIC       ///< Any other masks, expanded channel by channel
+    };
+
+    uint32_t width;                      ///< Frame width in pixels
+    uint32_t height;                     ///< Frame height in pixels
+    uint32_t bitsPerPixel;               ///< Bits per pixel of the source
+    uint32_t bytesPerPixel;              ///< Bytes per pixel of the source
+    bool topDown;                        ///< True if the source bitmap is top-down
+    YUVLayout yuvLayout;                 ///< Layout of YUV sources, YUV_NONE for RGB
+    uint32_t chromaWidth;                ///< Chroma samples per row of YUV sources
+    uint32_t chromaHeight;               ///< Chroma rows of 4:2:0 sources
+    uint32_t runLengthBits;              ///< Bits per index of BI_RLE8/BI_RLE4 sources, 0 otherwise
+    bool motionJPEG;                     ///< True for MJPG sources, decoded to ARGB8888 by MJPEGDecoder
+    MaskLayout maskLayout;               ///< Channels of 16- and 32-bit sources
+    PixelTables tables;                  ///< Palette colors and channel masks for the kernels
+    FrameKernel frameKernel;             ///< convert() of RGB, indexed and decoded RLE frames
+    RowKernel rowKernel;                 ///< RGB24 rows of the same frames
+    RowKernel bgraRowKernel;             ///< ARGB8888 rows of the same frames, for scaled output
+    YUVCoefficients yuvCoefficients;     ///< Color space of YUV sources
+    bool rgbOutput;                      ///< True if convert() turns YUV into ARGB8888
+    bool highDepth;                      ///< True for v210 and 16-bit per channel sources
+    DeepSource deepSource;               ///< Layout of high-bit-depth sources
+    DeepCoefficients deepCoefficients;   ///< Color space of v210 sources
+    bool tenBitOutput;                   ///< True if convert() writes ARGB2101010 for high-bit-depth sources
+    ThreadPool* bandPool;                ///< Workers for banded conversion of high-bit-depth frames, or null
+    SDL_PixelFormatEnum pixelFormat;     ///< SDL pixel format of converted frames at full size
+    uint32_t displayPitch;               ///< Row stride of a converted frame at full size in bytes
+    uint32_t displayFrameSize;           ///< Bytes of a converted frame at full size
+    bool scaled;                         ///< True if convert() shrinks frames with the resampler
+    Resampler resampler;                 ///< Weights of the output size after setOutputSize()
+    uint32_t sourceStride;               ///< Row stride of raw frames, padded to four bytes for DIBs
+    uint32_t sourceFrameSize;            ///< Bytes of a complete raw frame
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * Creates an unconfigured converter.
+     */
+    FrameConverter();
+
+    /**
+     * @brief Set up conversion for a video stream
+     *
+     * Determines the SDL pixel format and the conversion routine from the
+     * bitmap header, and prints the detected format. 16- and 32-bit
+     * frames whose masks match an SDL format are uploaded without
+     * conversion.
+     *
+     * @param bitmapHeader Bitmap format of the stream
+     * @param streamPalette Palette of the stream, used for indexed frames
+     * @param colorMasks Channel masks of BI_BITFIELDS streams
+     * @return true if the format is supported, false otherwise
+     */
+    bool configure(const BitmapInfoHeader& bitmapHeader, const std::vector<RGBQuad>& streamPalette,
+                   const BitmapColorMasks& colorMasks);
+
+    /**
+     * @brief Convert YUV frames to RGB for display
+     *
+     * For renderers without YUV textures, or whose YUV textures are
+     * converted in software on every upload. Once enabled, YUV streams
+     * report SDL_PIXELFORMAT_ARGB8888 and convert() writes it. Has no
+     * effect on RGB formats. May be called before or after configure(),
+     * but not while frames are being converted.
+     *
+     * @param enable true to convert, false to pass YUV frames through
+     */
+    void setRGBOutput(bool enable);
+
+    /**
+     * @brief Keep 10 bits per channel for display
+     *
+     * For renderers that take SDL_PIXELFORMAT_ARGB2101010 textures. Once
+     * enabled, high-bit-depth streams report that format and convert()
+     * writes it instead of dithering to ARGB8888. Has no effect on other
+     * formats. Same calling rules as setRGBOutput().
+     *
+     * @param enable true for ARGB2101010, false for ARGB8888
+     */
+    void setTenBitOutput(bool enable);
+
+    /**
+     * @brief Convert high-bit-depth frames in bands on a thread pool
+     *
+     * convert(), convertToRGB24() and convertToRGB48() then split frames
+     * of high-bit-depth streams into bands of rows, one task each, and
+     * wait for them. The calling thread must not be a worker of the pool.
+     *
+     * @param pool Pool to use, or null to convert on the calling thread
+     */
+    void setThreadPool(ThreadPool* pool) { bandPool = pool; }
+
+    /**
+     * @brief Shrink converted frames to a display size
+     *
+     * For renderers that scale in software: uploading and drawing the
+     * output resolution costs less than the full frame, and the area
+     * filter looks better than the renderer's scaling. When the size is
+     * smaller than the frame in either direction, convert() writes
+     * ARGB8888 frames of that size, and the display getters describe
+     * them. A size of at least the frame size restores full-size output.
+     * Must be called after configure(), and not while frames are being
+     * converted.
+     *
+     * @param outputWidth Width of converted frames
+     * @param outputHeight Height of converted frames
+     */
+    void setOutputSize(uint32_t outputWidth, uint32_t outputHeight);
+
+    /**
+     * @brief Convert and copy a frame
+     *
+     * Dispatches to the conversion routine of the configured format.
+     * YUV frames are copied plane by plane; the chroma planes follow the
+     * luma plane as in a locked SDL texture, with half the pitch for
+     * I420 and YV12 and the same pitch for NV12. With setRGBOutput() they
+     * are converted to ARGB8888 instead. With setOutputSize(), frames of
+     * every format are converted to ARGB8888 and shrunk.
+     *
+     * @param frameData Raw frame data from the AVI file (at least getSourceFrameSize() bytes)
+     * @param pixels Destination pixel buffer
+     * @param pitch Row stride of the destination in bytes
+     */
+    void convert(const uint8_t* frameData, uint8_t* pixels, int pitch) const;
+
+    /**
+     * @brief Convert only the parts of a frame that changed
+     *
+     * Compares the frame with the previous one in bands of 16 rows, with
+     * SSE2 where available. For each band that differs, the columns from
+     * the first to the last changed pixel are converted into the image
+     * and copied into the reference. Only for streams where
+     * canConvertChanges() is true.
+     *
+     * @param frameData Raw frame data (at least getSourceStride() * getHeight() bytes)
+     * @param reference Raw copy of the frame the image shows, updated in place
+     * @param pixels Converted image of that frame, updated in place
+     * @param pitch Row stride of the image in bytes
+     * @param regions Receives the rectangles that changed, bands that touch merged
+     */
+    void convertChanges(const uint8_t* frameData, uint8_t* reference, uint8_t* pixels, int pitch,
+                        std::vector<SDL_Rect>& regions) const;
+
+    /**
+     * @brief Apply a run-length encoded frame to a decoded image
+     *
+     * Expands BI_RLE8 or BI_RLE4 data straight into RGB24 through the
+     * palette. Pixels the frame skips with delta and end-of-line escapes
+     * keep their color, so the image must hold the previous frame, or be
+     * cleared for a key frame. Runs past the edge of the image are clipped
+     * and the data ends at the end-of-bitmap escape or at the given size,
+     * whichever comes first.
+     *
+     * @param data RLE frame data
+     * @param size Bytes of data
+     * @param pixels Top-down RGB24 image of getDisplayFrameSize() bytes
+     * @param pitch Row stride of the image in bytes
+     */
+    void decodeRLE(const uint8_t* data, size_t size, uint8_t* pixels, int pitch) const;
+
+    /**
+     * @brief Convert a frame to RGB24 with integer decimation
+     *
+     * Writes a top-down RGB24 image of getWidth() / step by
+     * getHeight() / step pixels, taking every step-th pixel of every
+     * step-th row. Lets streams of any supported format share one RGB24
+     * mosaic.
+     *
+     * @param frameData Raw frame data from the AVI file (at least getSourceFrameSize() bytes)
+     * @param pixels Destination RGB24 buffer
+     * @param pitch Row stride of the destination in bytes
+     * @param step Decimation factor, at least 1
+     */
+    void convertToRGB24(const uint8_t* frameData, uint8_t* pixels, int pitch, uint32_t step) const;
+
+    /**
+     * @brief Convert a frame to RGB24 with box-filter downscaling
+     *
+     * Writes a top-down RGB24 image of getWidth() / factor by
+     * getHeight() / factor pixels, each the average of a factor by factor
+     * block of the source. Rows of a block are summed first (with SSE2
+     * where available), then each block is averaged and swizzled to RGB in
+     * the same pass. Slower than convertToRGB24() but free of aliasing,
+     * which suits thumbnails.
+     *
+     * @param frameData Raw frame data from the AVI file (at least getSourceFrameSize() bytes)
+     * @param pixels Destination RGB24 buffer
+     * @param pitch Row stride of the destination in bytes
+     * @param factor Downscaling factor, from 1 to 256
+     */
+    void convertToRGB24Box(const uint8_t* frameData, uint8_t* pixels, int pitch, uint32_t factor) const;
+
+    /**
+     * @brief Convert a high-bit-depth frame to 16 bits per channel
+     *
+     * Writes a top-down image of native-endian 16-bit R, G and B samples,
+     * for export without loss. Only for streams where isHighDepth() is
+     * true.
+     *
+     * @param frameData Raw frame data from the AVI file (at least getSourceFrameSize() bytes)
+     * @param pixels Destination buffer
+     * @param pitch Row stride of the destination in bytes
+     */
+    void convertToRGB48(const uint8_t* frameData, uint8_t* pixels, int pitch) const;
+
+    /** @brief Frame width in pixels */
+    uint32_t getWidth() const { return width; }
+
+    /** @brief Frame height in pixels */
+    uint32_t getHeight() const { return height; }
+
+    /** @brief Bits per pixel of the source */
+    uint32_t getBitsPerPixel() const { return bitsPerPixel; }
+
+    /** @brief Width of converted frames, smaller than getWidth() after setOutputSize() */
+    uint32_t getOutputWidth() const { return scaled ? resampler.getOutputWidth() : width; }
+
+    /** @brief Height of converted frames, smaller than getHeight() after setOutputSize() */
+    uint32_t getOutputHeight() const { return scaled ? resampler.getOutputHeight() : height; }
+
+    /** @brief True if convert() shrinks frames to getOutputWidth() by getOutputHeight() */
+    bool isScaled() const { return scaled; }
+
+    /** @brief SDL pixel format of converted frames */
+    SDL_PixelFormatEnum getPixelFormat() const { return scaled ? SDL_PIXELFORMAT_ARGB8888 : pixelFormat; }
+
+    /** @brief Row stride of a converted frame in bytes */
+    uint32_t getDisplayPitch() const { return scaled ? getOutputWidth() * 4 : displayPitch; }
+
+    /** @brief Size of a converted frame in bytes */
+    size_t getDisplayFrameSize() const {
+        return scaled ? static_cast<size_t>(getDisplayPitch()) * getOutputHeight() : displayFrameSize;
+    }
+
+    /** @brief True if convertChanges() handles the stream: RGB, indexed, RLE and MJPG at full size */
+    bool canConvertChanges() const { return frameKernel != nullptr && !scaled; }
+
+    /** @brief True for BI_RLE8 and BI_RLE4 streams, whose frames go through decodeRLE() */
+    bool isRunLength() const { return runLengthBits != 0; }
+
+    /** @brief True for MJPG streams, whose frames go through MJPEGDecoder */
+    bool isMotionJPEG() const { return motionJPEG; }
+
+    /** @brief True for v210, 48-bit and 64-bit streams, which carry more than 8 bits per channel */
+    bool isHighDepth() const { return highDepth; }
+
+    /** @brief Layout of YUV sources, YUV_NONE for RGB formats */
+    YUVLayout getYUVLayout() const { return yuvLayout; }
+
+    /**
+     * @brief Check whether raw frames are already in the display format
+     *
+     * True for the YUV formats, unless setRGBOutput() or setOutputSize()
+     * is in effect: their frames can be uploaded as they are, without
+     * convert().
+     */
+    bool isPassThrough() const { return yuvLayout != YUV_NONE && !rgbOutput && !scaled; }
+
+    /**
+     * @brief Locate the planes of a frame in display layout
+     *
+     * Works on raw frames of pass-through formats and on frames written
+     * by convert() with getDisplayPitch(). Frames converted to RGB have a
+     * single plane.
+     *
+     * @param frame Frame data
+     * @param planes Receives the start of the Y, U and V planes (U and V are the same interleaved plane for NV12; only planes[0] is set for packed formats)
+     * @param pitches Receives the row stride of each plane
+     */
+    void getPlanes(const uint8_t* frame, const uint8_t* planes[3], int pitches[3]) const;
+
+    /** @brief Row stride of raw frames, and of the images of RLEDecoder and MJPEGDecoder */
+    uint32_t getSourceStride() const { return sourceStride; }
+
+    /** @brief Bytes of a complete raw frame; shorter chunks are dropped frames (0 for RLE, where any chunk is valid; 1 for MJPG, where only empty chunks are dropped) */
+    uint32_t getSourceFrameSize() const { return sourceFrameSize; }
+
+private:
+    /**
+     * @brief Pick the kernels of RGB, indexed and RLE streams
+     *
+     * Called once by configure().
+     */
+    void selectKernels();
+
+    /**
+     * @brief Choose how 16- and 32-bit pixels are handled
+     *
+     * @param colorMasks Masks from the stream, or the BI_RGB defaults
+     * @return true if the masks describe valid channels
+     */
+    bool configureMasks(const BitmapColorMasks& colorMasks);
+
+    /**
+     * @brief Set the display format of YUV and high-bit-depth streams
+     *
+     * The native SDL YUV format, or ARGB8888 after setRGBOutput();
+     * ARGB8888 or ARGB2101010 for high-bit-depth streams.
+     */
+    void updateDisplayFormat();
+
+    /**
+     * @brief Locate the planes of a raw YUV frame
+     *
+     * @param frame Frame in its native layout
+     * @param planes Receives the start of the Y, U and V planes, as for getPlanes()
+     * @param pitches Receives the row stride of each plane
+     */
+    void getSourcePlanes(const uint8_t* frame, const uint8_t* planes[3], int pitches[3]) const;
+
+    /**
+     * @brief Convert one row of any format to ARGB8888
+     *
+     * @param frameData Source frame
+     * @param y Row, counted from the top
+     * @param dst Destination row of getWidth() pixels
+     * @param scratch Buffer of deepScratchSize() samples for high-bit-depth rows
+     */
+    void convertRowBGRA(const uint8_t* frameData, uint32_t y, uint8_t* dst, uint16_t* scratch) const;
+
+    /**
+     * @brief Convert a YUV frame row by row
+     *
+     * @param frameData Source frame in its native layout
+     * @param pixels Destination buffer
+     * @param pitch Row stride of the destination in bytes
+     * @param layout Layout of the destination pixels
+     */
+    void convertYUV(const uint8_t* frameData, uint8_t* pixels, int pitch, RGBLayout layout) const;
+
+    /**
+     * @brief Copy a YUV frame plane by plane
+     *
+     * @param frameData Source frame in its native layout
+     * @param pixels Destination buffer
+     * @param pitch Row stride of the luma plane (of the packed rows for 4:2:2)
+     */
+    void copyYUV(const uint8_t* frameData, uint8_t* pixels, int pitch) const;
+
+    /**
+     * @brief Convert a high-bit-depth frame, in bands if a pool is set
+     *
+     * @param frameData Source frame
+     * @param pixels Destination buffer
+     * @param pitch Row stride of the destination in bytes
+     * @param layout Layout of the destination pixels
+     */
+    void convertHighDepth(const uint8_t* frameData, uint8_t* pixels, int pitch, DeepLayout layout) const;
+
+    /**
+     * @brief Convert a band of rows of a high-bit-depth frame
+     *
+     * @param frameData Source frame
+     * @param pixels Destination buffer (of the whole frame)
+     * @param pitch Row stride of the destination in bytes
+     * @param layout Layout of the destination pixels
+     * @param first First row of the band
+     * @param count Rows in the band
+     */
+    void convertHighDepthRows(const uint8_t* frameData, uint8_t* pixels, int pitch, DeepLayout layout,
+                              uint32_t first, uint32_t count) const;
+
+    /**
+     * @brief Read the luma and chroma samples of one pixel of a YUV frame
+     *
+     * @param frameData Source frame in its native layout
+     * @param x Column of the pixel
+     * @param y Row of the pixel
+     * @param sample Receives Y, U and V
+     */
+    void sampleYUV(const uint8_t* frameData, uint32_t x, uint32_t y, uint8_t sample[3]) const;
+};
+
+#endif // FRAME_CONVERTER_H
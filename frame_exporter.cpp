@@ -0,0 +1,531 @@
+/**
+ * @file frame_exporter.cpp
+ * @brief Implementation of the FrameExporter class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "frame_exporter.h"
+#include "mjpeg_decoder.h"
+#include "path_pattern.h"
+#include "read_ahead.h"
+#include "rle_decoder.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/uio.h>
+#endif
+
+namespace {
+    /**
+     * @brief Minimum size of an output batch
+     */
+    const size_t kBatchBytes = 4u << 20;
+
+    /**
+     * @brief Pipe capacity requested for spliced output
+     */
+    const int kPipeBytes = 1 << 20;
+}
+
+FrameExporter::FrameExporter(const AVIReader& reader, int streamNumber)
+    : reader(reader), streamNumber(streamNumber), deep(false), format(FORMAT_RAW), perFrameFiles(false),
+      outputFd(-1), outputIsPipe(false), currentBatch(0), batchUsed(0),
+      audioStream(-1), audioBytesPerFrame(0), bytesWritten(0), framesWritten(0) {
+}
+
+FrameExporter::~FrameExporter() {
+    closeOutput();
+}
+
+bool FrameExporter::parseFormat(const std::string& name, Format& result) {
+    if (name == "raw") {
+        result = FORMAT_RAW;
+    } else if (name == "y4m") {
+        result = FORMAT_Y4M;
+    } else if (name == "ppm") {
+        result = FORMAT_PPM;
+    } else if (name == "avi") {
+        result = FORMAT_AVI;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool FrameExporter::open(const std::string& path, Format outputFormat) {
+    const AVIStream& stream = reader.getStream(streamNumber);
+    if (!stream.isVideo() || stream.chunkOffsets.empty()) {
+        std::cerr << "Error: Stream " << streamNumber << " is not a video stream" << std::endl;
+        return false;
+    }
+    if (!converter.configure(stream.bitmapHeader, stream.palette, stream.colorMasks)) {
+        std::cerr << "Error: Unsupported pixel format" << std::endl;
+        return false;
+    }
+
+    format = outputFormat;
+    outputPath = path;
+    perFrameFiles = path.find('%') != std::string::npos;
+    if (perFrameFiles && !isNumberPattern(path)) {
+        std::cerr << "Error: Output pattern " << path << " needs exactly one %d or %u (%% for a literal %)" << std::endl;
+        return false;
+    }
+    deep = converter.isHighDepth() && format != FORMAT_AVI;
+    if (converter.isHighDepth() || converter.isMotionJPEG()) {
+        workers.reset(new ThreadPool());
+        converter.setThreadPool(workers.get());
+    }
+    if (format == FORMAT_Y4M || format == FORMAT_AVI) {
+        rgb.resize(static_cast<size_t>(converter.getWidth()) * converter.getHeight() * (deep ? 6 : 3));
+    }
+    if (format == FORMAT_AVI) {
+        if (path == "-" || perFrameFiles) {
+            std::cerr << "Error: AVI export needs an output file" << std::endl;
+            return false;
+        }
+        return openAVI(path);
+    }
+
+    // A batch always holds a whole frame plus one pipe's worth of data;
+    // see flush() for why the latter matters
+    size_t batchBytes = std::max(kBatchBytes, payloadSize() + frameHeader().size() + fileHeader().size());
+    batchBytes += kPipeBytes;
+    batches[0].resize(batchBytes);
+    batches[1].resize(batchBytes);
+
+    return perFrameFiles || openOutput(path);
+}
+
+bool FrameExporter::exportFrames(uint32_t first, uint32_t last) {
+    const AVIStream& stream = reader.getStream(streamNumber);
+    if (first > last || last >= stream.getChunkCount()) {
+        std::cerr << "Error: Frame range " << first << "-" << last << " is outside 0-"
+                  << (stream.getChunkCount() - 1) << std::endl;
+        return false;
+    }
+
+    // Large sequential reads, exactly as for forward playback
+    size_t blockBytes = std::max(static_cast<size_t>(stream.maxChunkSize) * 4, static_cast<size_t>(32u << 20));
+    ReadAheadWindow readAhead(reader, streamNumber, blockBytes);
+    readAhead.setStride(1);
+
+    // RLE frames start from the key frame before the first exported frame
+    std::unique_ptr<RLEDecoder> decoder;
+    if (converter.isRunLength()) decoder.reset(new RLEDecoder(reader, streamNumber, converter));
+
+    // MJPG frames are decoded ahead on the workers and written in order
+    std::unique_ptr<MJPEGDecoder> jpegDecoder;
+    if (converter.isMotionJPEG()) {
+        jpegDecoder.reset(new MJPEGDecoder(reader, streamNumber, converter));
+        jpegDecoder->startPipeline(*workers, readAhead, workers->getThreadCount() * 2);
+    }
+
+    std::string header = frameHeader();
+    size_t payload = payloadSize();
+    int64_t lastGood = -1;
+    std::vector<uint8_t> repeat;
+
+    for (uint32_t i = first; i <= last; ++i) {
+        if (perFrameFiles) {
+            if (!openOutput(formatNumberPattern(outputPath, i))) return false;
+        }
+
+        uint8_t* out;
+        if (format == FORMAT_AVI) {
+            if (!writeAudio(i, i == last)) return false;
+            out = writer.reserveChunk(0, static_cast<uint32_t>(payload));
+            if (!out) return false;
+        } else {
+            uint8_t* record = reserve(header.size() + payload);
+            if (!record) return false;
+            std::memcpy(record, header.data(), header.size());
+            out = record + header.size();
+        }
+
+        const uint8_t* frameData = nullptr;
+        if (jpegDecoder && stream.chunkSizes[i] >= converter.getSourceFrameSize()) {
+            // Damaged images are repeated over like dropped frames
+            frameData = jpegDecoder->decode(i, nullptr);
+            if (frameData) {
+                lastGood = i;
+            } else if (lastGood >= 0) {
+                frameData = jpegDecoder->decode(static_cast<uint32_t>(lastGood), nullptr);
+            }
+        } else if (stream.chunkSizes[i] >= converter.getSourceFrameSize()) {
+            frameData = readAhead.acquire(i);
+            if (frameData && decoder) frameData = decoder->decode(i, frameData);
+            if (!frameData) {
+                std::cerr << "Error: Cannot read frame " << i << std::endl;
+                return false;
+            }
+            lastGood = i;
+        } else if (jpegDecoder && lastGood >= 0) {
+            frameData = jpegDecoder->decode(static_cast<uint32_t>(lastGood), nullptr);
+        } else if (lastGood >= 0) {
+            // Dropped frame: repeat the last complete one
+            repeat.resize(stream.chunkSizes[lastGood]);
+            if (reader.readChunk(streamNumber, static_cast<uint32_t>(lastGood), repeat.data(), repeat.size())) {
+                frameData = repeat.data();
+            }
+        }
+
+        if (frameData) {
+            convertFrame(frameData, out);
+        } else {
+            std::memset(out, 0, payload);
+        }
+        framesWritten++;
+
+        if (perFrameFiles && !closeOutput()) return false;
+    }
+
+    if (jpegDecoder && jpegDecoder->getFailureCount() > 0) {
+        std::cerr << "Warning: " << jpegDecoder->getFailureCount()
+                  << " MJPG frame(s) could not be decoded and repeat the previous frame" << std::endl;
+    }
+
+    if (format == FORMAT_AVI) {
+        bool success = writer.close();
+        bytesWritten = writer.getFileSize();
+        return success;
+    }
+    return perFrameFiles || flush();
+}
+
+std::string FrameExporter::fileHeader() const {
+    if (format != FORMAT_Y4M) return std::string();
+
+    // Frame rate as the exact fraction of the stream header
+    const AVIStreamHeader& header = reader.getStream(streamNumber).header;
+    uint32_t rate = header.rate;
+    uint32_t scale = header.scale;
+    if (rate == 0 || scale == 0) {
+        rate = 1000000;
+        scale = reader.getMainHeader().microSecPerFrame;
+        if (scale == 0) scale = rate / 30;
+    }
+
+    char text[128];
+    std::snprintf(text, sizeof(text), "YUV4MPEG2 W%u H%u F%u:%u Ip A1:1 %s\n",
+                  converter.getWidth(), converter.getHeight(), rate, scale, deep ? "C444p16" : "C444");
+    return text;
+}
+
+std::string FrameExporter::frameHeader() const {
+    if (format == FORMAT_Y4M) return "FRAME\n";
+    if (format == FORMAT_PPM) {
+        char text[64];
+        std::snprintf(text, sizeof(text), "P6\n%u %u\n%u\n", converter.getWidth(), converter.getHeight(),
+                      deep ? 65535u : 255u);
+        return text;
+    }
+    return std::string();
+}
+
+size_t FrameExporter::payloadSize() const {
+    if (format == FORMAT_AVI) {
+        // DIB rows are padded to four bytes
+        return static_cast<size_t>((converter.getWidth() * 3 + 3) & ~3u) * converter.getHeight();
+    }
+
+    // RGB24 and planar 4:4:4 both take three samples per pixel
+    return static_cast<size_t>(converter.getWidth()) * converter.getHeight() * (deep ? 6 : 3);
+}
+
+bool FrameExporter::openOutput(const std::string& path) {
+    if (path == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY);
+        outputFd = _fileno(stdout);
+#else
+        outputFd = STDOUT_FILENO;
+#endif
+    } else {
+#ifdef _WIN32
+        outputFd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+        outputFd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+        if (outputFd < 0) {
+            std::cerr << "Error: Cannot create file " << path << std::endl;
+            return false;
+        }
+    }
+
+    outputIsPipe = false;
+#ifdef __linux__
+    struct stat info;
+    if (fstat(outputFd, &info) == 0 && S_ISFIFO(info.st_mode)) {
+        // Fewer, larger splices; the default capacity is fine if this fails
+        fcntl(outputFd, F_SETPIPE_SZ, kPipeBytes);
+        int capacity = fcntl(outputFd, F_GETPIPE_SZ);
+        outputIsPipe = capacity > 0 && capacity <= kPipeBytes;
+    }
+#endif
+
+    std::string header = fileHeader();
+    if (!header.empty()) {
+        uint8_t* space = reserve(header.size());
+        if (!space) return false;
+        std::memcpy(space, header.data(), header.size());
+    }
+    return true;
+}
+
+bool FrameExporter::openAVI(const std::string& path) {
+    const AVIStream& stream = reader.getStream(streamNumber);
+    uint32_t width = converter.getWidth();
+    uint32_t height = converter.getHeight();
+
+    AVIMainHeader mainHeader = reader.getMainHeader();
+    mainHeader.width = width;
+    mainHeader.height = height;
+    writer.setMainHeader(mainHeader);
+
+    // Bottom-up 24-bit BI_RGB, the format every player decodes
+    BitmapInfoHeader bitmap;
+    std::memset(&bitmap, 0, sizeof(bitmap));
+    bitmap.size = sizeof(bitmap);
+    bitmap.width = static_cast<int32_t>(width);
+    bitmap.height = static_cast<int32_t>(height);
+    bitmap.planes = 1;
+    bitmap.bitCount = 24;
+    bitmap.sizeImage = static_cast<uint32_t>(payloadSize());
+    const uint8_t* bitmapBytes = reinterpret_cast<const uint8_t*>(&bitmap);
+
+    AVIStreamHeader videoHeader = stream.header;
+    std::memset(videoHeader.fccHandler, 0, sizeof(videoHeader.fccHandler));
+    videoHeader.start = 0;
+    videoHeader.initialFrames = 0;
+    videoHeader.sampleSize = 0;
+    writer.addStream(videoHeader, std::vector<uint8_t>(bitmapBytes, bitmapBytes + sizeof(bitmap)));
+
+    audioStream = -1;
+    if (reader.hasAudio() && reader.getWaveFormat().blockAlign > 0) {
+        AVIStreamHeader audioHeader = reader.getAudioStreamHeader();
+        audioHeader.start = 0;
+        audioHeader.initialFrames = 0;
+        audioStream = writer.addStream(audioHeader, reader.getStream(reader.getAudioStream()).format);
+
+        double frameSeconds;
+        if (stream.header.rate > 0 && stream.header.scale > 0) {
+            frameSeconds = static_cast<double>(stream.header.scale) / stream.header.rate;
+        } else {
+            frameSeconds = reader.getMainHeader().microSecPerFrame / 1e6;
+        }
+        audioBytesPerFrame = frameSeconds * reader.getWaveFormat().avgBytesPerSec;
+    }
+
+    return writer.open(path);
+}
+
+bool FrameExporter::writeAudio(uint32_t frame, bool last) {
+    if (audioStream < 0) return true;
+
+    // Whole sample frames from the start of this video frame to the start
+    // of the next one
+    uint64_t total = reader.getAudioByteCount();
+    uint32_t blockAlign = reader.getWaveFormat().blockAlign;
+    uint64_t begin = static_cast<uint64_t>(frame * audioBytesPerFrame / blockAlign) * blockAlign;
+    uint64_t end = static_cast<uint64_t>((frame + 1.0) * audioBytesPerFrame / blockAlign) * blockAlign;
+    if (last) end = total;
+    begin = std::min(begin, total);
+    end = std::min(end, total);
+    if (end <= begin) return true;
+
+    uint32_t size = static_cast<uint32_t>(end - begin);
+    uint8_t* out = writer.reserveChunk(audioStream, size);
+    if (!out) return false;
+    size_t got = reader.readAudio(begin, out, size);
+    if (got < size) std::memset(out + got, 0, size - got);
+    return true;
+}
+
+bool FrameExporter::closeOutput() {
+    if (outputFd < 0) return true;
+
+    bool success = flush();
+    if (outputPath != "-" || perFrameFiles) {
+#ifdef _WIN32
+        _close(outputFd);
+#else
+        ::close(outputFd);
+#endif
+    }
+    outputFd = -1;
+    return success;
+}
+
+uint8_t* FrameExporter::reserve(size_t bytes) {
+    if (batchUsed + bytes > batches[currentBatch].size() && !flush()) {
+        return nullptr;
+    }
+    uint8_t* space = batches[currentBatch].data() + batchUsed;
+    batchUsed += bytes;
+    return space;
+}
+
+bool FrameExporter::flush() {
+    if (batchUsed == 0) return true;
+
+    bool success = writeAll(batches[currentBatch].data(), batchUsed);
+
+    // vmsplice() leaves the batch's pages referenced by the pipe until the
+    // reader consumes them. The other batch is only flushed once full,
+    // which is more than the pipe holds, so when its splice returns none of
+    // this batch is left in the pipe and it can be refilled.
+    currentBatch ^= 1;
+    batchUsed = 0;
+    return success;
+}
+
+bool FrameExporter::writeAll(const uint8_t* data, size_t size) {
+#ifdef __linux__
+    while (outputIsPipe && size > 0) {
+        struct iovec chunk;
+        chunk.iov_base = const_cast<uint8_t*>(data);
+        chunk.iov_len = size;
+        ssize_t written = vmsplice(outputFd, &chunk, 1, 0);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EINVAL || errno == ENOSYS) {
+                // Not spliceable after all: fall back to write()
+                outputIsPipe = false;
+                break;
+            }
+            std::cerr << "Error: Write failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        data += written;
+        size -= written;
+        bytesWritten += written;
+    }
+#endif
+
+    while (size > 0) {
+#ifdef _WIN32
+        int written = _write(outputFd, data, static_cast<unsigned>(std::min(size, static_cast<size_t>(1u << 30))));
+#else
+        ssize_t written = ::write(outputFd, data, size);
+#endif
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "Error: Write failed: " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        data += written;
+        size -= written;
+        bytesWritten += written;
+    }
+    return true;
+}
+
+void FrameExporter::convertFrame(const uint8_t* frameData, uint8_t* out) {
+    uint32_t width = converter.getWidth();
+    uint32_t height = converter.getHeight();
+
+    if (format == FORMAT_AVI) {
+        // Bottom-up BGR rows, padded to four bytes
+        converter.convertToRGB24(frameData, rgb.data(), static_cast<int>(width * 3), 1);
+        size_t rowBytes = (width * 3 + 3) & ~3u;
+        for (uint32_t y = 0; y < height; ++y) {
+            const uint8_t* source = rgb.data() + static_cast<size_t>(height - 1 - y) * width * 3;
+            uint8_t* row = out + y * rowBytes;
+            for (uint32_t x = 0; x < width; ++x) {
+                row[x * 3 + 0] = source[x * 3 + 2];
+                row[x * 3 + 1] = source[x * 3 + 1];
+                row[x * 3 + 2] = source[x * 3 + 0];
+            }
+            std::memset(row + width * 3, 0, rowBytes - width * 3);
+        }
+        return;
+    }
+
+    if (deep) {
+        convertDeepFrame(frameData, out);
+        return;
+    }
+
+    if (format != FORMAT_Y4M) {
+        // RGB24 is written as converted
+        converter.convertToRGB24(frameData, out, static_cast<int>(width * 3), 1);
+        return;
+    }
+
+    converter.convertToRGB24(frameData, rgb.data(), static_cast<int>(width * 3), 1);
+
+    // BT.601 studio-range YCbCr, one plane after the other
+    size_t pixels = static_cast<size_t>(width) * height;
+    uint8_t* yPlane = out;
+    uint8_t* uPlane = out + pixels;
+    uint8_t* vPlane = out + pixels * 2;
+    for (size_t i = 0; i < pixels; ++i) {
+        int r = rgb[i * 3 + 0];
+        int g = rgb[i * 3 + 1];
+        int b = rgb[i * 3 + 2];
+        yPlane[i] = static_cast<uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+        uPlane[i] = static_cast<uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+        vPlane[i] = static_cast<uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+    }
+}
+
+
+void FrameExporter::convertDeepFrame(const uint8_t* frameData, uint8_t* out) {
+    uint32_t width = converter.getWidth();
+    uint32_t height = converter.getHeight();
+    size_t pixels = static_cast<size_t>(width) * height;
+
+    if (format == FORMAT_RAW) {
+        converter.convertToRGB48(frameData, out, static_cast<int>(width * 6));
+        return;
+    }
+
+    if (format == FORMAT_PPM) {
+        // PPM samples above 255 are big-endian
+        converter.convertToRGB48(frameData, out, static_cast<int>(width * 6));
+        for (size_t i = 0; i < pixels * 3; ++i) {
+            uint16_t sample;
+            std::memcpy(&sample, out + i * 2, sizeof(sample));
+            out[i * 2] = static_cast<uint8_t>(sample >> 8);
+            out[i * 2 + 1] = static_cast<uint8_t>(sample);
+        }
+        return;
+    }
+
+    converter.convertToRGB48(frameData, rgb.data(), static_cast<int>(width * 6));
+
+    // BT.601 studio-range YCbCr as for 8 bits, scaled by 256, in
+    // little-endian 16-bit planes
+    uint8_t* planes[3] = {out, out + pixels * 2, out + pixels * 4};
+    for (size_t i = 0; i < pixels; ++i) {
+        uint16_t pixel[3];
+        std::memcpy(pixel, rgb.data() + i * 6, sizeof(pixel));
+        int r = pixel[0];
+        int g = pixel[1];
+        int b = pixel[2];
+        uint16_t samples[3] = {
+            static_cast<uint16_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 4096),
+            static_cast<uint16_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 32768),
+            static_cast<uint16_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 32768)
+        };
+        for (int plane = 0; plane < 3; ++plane) {
+            std::memcpy(planes[plane] + i * 2, &samples[plane], sizeof(uint16_t));
+        }
+    }
+}
@@ -0,0 +1,237 @@
+/**
+ * @file frame_exporter.h
+ * @brief Export of converted frames as raw RGB, Y4M, PPM or AVI
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the FrameExporter class, which writes the frames of
+ * one video stream to stdout or to files so that encoders and analysis
+ * tools can read them without going through the display path.
+ */
+
+#ifndef FRAME_EXPORTER_H
+#define FRAME_EXPORTER_H
+
+#include "avi_reader.h"
+#include "avi_writer.h"
+#include "frame_converter.h"
+#include "thread_pool.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Frame exporter for one video stream
+ *
+ * Frames are read with the same block read-ahead as playback, converted to
+ * top-down RGB24 and written as:
+ * - raw: RGB24 pixels, frame after frame (ffmpeg: -f rawvideo -pix_fmt rgb24)
+ * - y4m: YUV4MPEG2 with 4:4:4 BT.601 samples and the stream's frame rate
+ * - ppm: binary PPM (P6) images back to back
+ * - avi: uncompressed 24-bit AVI with the audio stream, if any, written
+ *   with AVIWriter; needs a file path
+ *
+ * High-bit-depth streams (v210, 48-bit and 64-bit RGB) keep 16 bits per
+ * channel in the first three formats: raw writes RGB48 little-endian
+ * (ffmpeg: -pix_fmt rgb48le), y4m 16-bit 4:4:4 (C444p16) and ppm images
+ * with a maximum value of 65535. Their frames are converted in bands on a
+ * thread pool. MJPG frames are decoded ahead on the same kind of pool and
+ * written in order.
+ *
+ * Output is collected into batches of several megabytes before it is
+ * written. When the output is a pipe on Linux, batches are handed to the
+ * pipe with vmsplice() instead of being copied by write(). An output path
+ * containing a printf-style frame number (e.g. frame%05d.ppm) writes one
+ * file per frame.
+ *
+ * Usage example:
+ * @code
+ * FrameExporter exporter(reader, reader.getVideoStream());
+ * if (exporter.open("-", FrameExporter::FORMAT_Y4M)) {
+ *     exporter.exportFrames(0, reader.getFrameCount() - 1);
+ * }
+ * @endcode
+ */
+class FrameExporter {
+public:
+    /**
+     * @brief Output formats
+     */
+    enum Format {
+        FORMAT_RAW,     ///< Raw RGB24 frames
+        FORMAT_Y4M,     ///< YUV4MPEG2, 4:4:4
+        FORMAT_PPM,     ///< Binary PPM images
+        FORMAT_AVI      ///< Uncompressed AVI file
+    };
+
+private:
+    const AVIReader& reader;         ///< Source of frame data
+    int streamNumber;                ///< Video stream to export
+    FrameConverter converter;        ///< Conversion to RGB24, or RGB48 for high bit depths
+    std::unique_ptr<ThreadPool> workers; ///< Workers for high-bit-depth and MJPG frames, null otherwise
+    bool deep;                       ///< True if frames are written with 16 bits per channel
+    Format format;                   ///< Output format
+    std::string outputPath;          ///< Output path, "-" for stdout
+    bool perFrameFiles;              ///< True if the path holds a frame number
+    int outputFd;                    ///< Current output file descriptor, -1 if none
+    bool outputIsPipe;               ///< True if batches can be spliced into a pipe
+
+    std::vector<uint8_t> batches[2]; ///< Output batches, alternately filled and written
+    int currentBatch;                ///< Batch being filled
+    size_t batchUsed;                ///< Bytes used in the current batch
+    std::vector<uint8_t> rgb;        ///< Converted frame, for formats that are not RGB24 (or RGB48)
+    AVIWriter writer;                ///< Output file of FORMAT_AVI
+    int audioStream;                 ///< Audio stream of the AVI output, -1 if none
+    double audioBytesPerFrame;       ///< Audio bytes per video frame of the AVI output
+
+    uint64_t bytesWritten;           ///< Bytes written to the output
+    uint32_t framesWritten;          ///< Frames written to the output
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param reader Open reader; must outlive this object
+     * @param streamNumber Video stream to export
+     */
+    FrameExporter(const AVIReader& reader, int streamNumber);
+
+    /**
+     * @brief Destructor
+     *
+     * Flushes and closes the output.
+     */
+    ~FrameExporter();
+
+    /**
+     * @brief Parse a format name
+     *
+     * @param name "raw", "y4m", "ppm" or "avi"
+     * @param result Receives the format
+     * @return true if the name is known, false otherwise
+     */
+    static bool parseFormat(const std::string& name, Format& result);
+
+    /**
+     * @brief Prepare the conversion and open the output
+     *
+     * @param path Output path, "-" for stdout, or a pattern with a frame number; FORMAT_AVI needs a plain file path
+     * @param outputFormat Format to write
+     * @return true if the stream can be exported, false otherwise
+     */
+    bool open(const std::string& path, Format outputFormat);
+
+    /**
+     * @brief Write a range of frames
+     *
+     * Dropped frames (empty or short chunks) repeat the previous image so
+     * that the output keeps the stream's timing.
+     *
+     * @param first First frame to write
+     * @param last Last frame to write, inclusive
+     * @return true if all frames were written, false on a read or write error
+     */
+    bool exportFrames(uint32_t first, uint32_t last);
+
+    /** @brief Bytes written to the output */
+    uint64_t getBytesWritten() const { return bytesWritten; }
+
+    /** @brief Frames written to the output */
+    uint32_t getFramesWritten() const { return framesWritten; }
+
+private:
+    FrameExporter(const FrameExporter&);
+    FrameExporter& operator=(const FrameExporter&);
+
+    /**
+     * @brief Header written once at the start of every output file
+     */
+    std::string fileHeader() const;
+
+    /**
+     * @brief Header written before every frame
+     */
+    std::string frameHeader() const;
+
+    /**
+     * @brief Bytes of one frame's pixels in the output format
+     */
+    size_t payloadSize() const;
+
+    /**
+     * @brief Open an output file, or stdout for "-"
+     *
+     * @param path Path of the file
+     * @return true on success
+     */
+    bool openOutput(const std::string& path);
+
+    /**
+     * @brief Declare the streams of the AVI output and create the file
+     *
+     * @param path Path of the file
+     * @return true on success
+     */
+    bool openAVI(const std::string& path);
+
+    /**
+     * @brief Append the audio that plays during a frame to the AVI output
+     *
+     * @param frame Frame the audio belongs to
+     * @param last True for the last exported frame, which takes the rest of the audio
+     * @return true on success
+     */
+    bool writeAudio(uint32_t frame, bool last);
+
+    /**
+     * @brief Flush and close the current output
+     *
+     * @return true if the remaining data was written
+     */
+    bool closeOutput();
+
+    /**
+     * @brief Get space for the next bytes of output in the current batch
+     *
+     * Writes the batch out first if the bytes do not fit.
+     *
+     * @param bytes Number of bytes needed
+     * @return Pointer to the space, or nullptr on a write error
+     */
+    uint8_t* reserve(size_t bytes);
+
+    /**
+     * @brief Write out the current batch and switch to the other one
+     *
+     * @return true on success
+     */
+    bool flush();
+
+    /**
+     * @brief Write a buffer completely to the output
+     *
+     * @param data Bytes to write
+     * @param size Number of bytes
+     * @return true on success
+     */
+    bool writeAll(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Convert a raw frame into the output format
+     *
+     * @param frameData Raw frame from the file
+     * @param out Destination of payloadSize() bytes
+     */
+    void convertFrame(const uint8_t* frameData, uint8_t* out);
+
+    /**
+     * @brief Convert a raw high-bit-depth frame into 16-bit output
+     *
+     * @param frameData Raw frame
+     * @param out Space for payloadSize() bytes
+     */
+    void convertDeepFrame(const uint8_t* frameData, uint8_t* out);
+};
+
+#endif // FRAME_EXPORTER_H
@@ -0,0 +1,158 @@
+/**
+ * @file frame_hasher.cpp
+ * @brief Implementation of the FrameHasher class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "frame_hasher.h"
+#include "crc32c.h"
+#include <cstdio>
+#include <iostream>
+
+namespace {
+    /**
+     * @brief Target size of one read
+     */
+    const uint64_t kRunBytes = 8u << 20;
+
+    /**
+     * @brief Largest gap between frames that is read through
+     *
+     * Covers chunk headers and interleaved audio; larger gaps start a new run.
+     */
+    const uint64_t kMaxGapBytes = 256u << 10;
+}
+
+FrameHasher::FrameHasher(const AVIReader& reader, int streamNumber, unsigned threads)
+    : reader(reader), streamNumber(streamNumber), pool(threads), failed(false), bytesHashed(0) {
+}
+
+bool FrameHasher::run() {
+    const AVIStream& stream = reader.getStream(streamNumber);
+    if (!stream.isVideo() || stream.chunkOffsets.empty()) {
+        std::cerr << "Error: Stream " << streamNumber << " is not a video stream" << std::endl;
+        return false;
+    }
+
+    uint32_t count = stream.getChunkCount();
+    checksums.assign(count, 0);
+    failed = false;
+    bytesHashed = stream.totalBytes;
+
+    // Group frames that lie close together in the file into one read
+    uint32_t first = 0;
+    while (first < count) {
+        uint64_t start = stream.chunkOffsets[first];
+        uint64_t end = start + stream.chunkSizes[first];
+        uint32_t next = first + 1;
+        while (next < count) {
+            uint64_t offset = stream.chunkOffsets[next];
+            uint64_t nextEnd = offset + stream.chunkSizes[next];
+            if (offset < end || offset - end > kMaxGapBytes || nextEnd - start > kRunBytes) break;
+            end = nextEnd;
+            next++;
+        }
+
+        uint32_t runFirst = first;
+        uint32_t runCount = next - first;
+        pool.submit([this, runFirst, runCount] { hashRun(runFirst, runCount); });
+        first = next;
+    }
+    pool.waitIdle();
+
+    if (failed) {
+        std::cerr << "Error: Failed to read frame data" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void FrameHasher::hashRun(uint32_t first, uint32_t count) {
+    // One buffer per worker, reused across runs
+    static thread_local std::vector<uint8_t> buffer;
+
+    const AVIStream& stream = reader.getStream(streamNumber);
+    uint32_t last = first + count - 1;
+    uint64_t start = stream.chunkOffsets[first];
+    size_t span = static_cast<size_t>(stream.chunkOffsets[last] + stream.chunkSizes[last] - start);
+
+    if (buffer.size() < span) buffer.resize(span);
+    if (span > 0 && !reader.readAt(start, buffer.data(), span)) {
+        failed = true;
+        return;
+    }
+
+    for (uint32_t i = first; i <= last; ++i) {
+        const uint8_t* payload = buffer.data() + (stream.chunkOffsets[i] - start);
+        checksums[i] = crc32c(0, payload, stream.chunkSizes[i]);
+    }
+}
+
+bool FrameHasher::isDropped(uint32_t frameIndex) const {
+    return reader.getStream(streamNumber).chunkSizes[frameIndex] == 0;
+}
+
+bool FrameHasher::isRepeat(uint32_t frameIndex) const {
+    const AVIStream& stream = reader.getStream(streamNumber);
+    return frameIndex > 0 && !isDropped(frameIndex) &&
+           stream.chunkSizes[frameIndex] == stream.chunkSizes[frameIndex - 1] &&
+           checksums[frameIndex] == checksums[frameIndex - 1];
+}
+
+void FrameHasher::writeManifest(std::ostream& out, const std::string& filepath) const {
+    const AVIStream& stream = reader.getStream(streamNumber);
+
+    out << "# avi_player frame manifest" << std::endl;
+    out << "# file: " << filepath << std::endl;
+    out << "# stream: " << streamNumber << ", frames: " << checksums.size()
+        << ", checksum: crc32c" << std::endl;
+    out << "# frame offset size crc32c [dropped|repeat]" << std::endl;
+
+    char line[96];
+    for (uint32_t i = 0; i < checksums.size(); ++i) {
+        std::snprintf(line, sizeof(line), "%u %llu %u %08x", i,
+                      static_cast<unsigned long long>(stream.chunkOffsets[i]),
+                      stream.chunkSizes[i], checksums[i]);
+        out << line;
+        if (isDropped(i)) {
+            out << " dropped";
+        } else if (isRepeat(i)) {
+            out << " repeat";
+        }
+        out << '\n';
+    }
+    out.flush();
+}
+
+void FrameHasher::printSummary(std::ostream& out) const {
+    uint32_t dropped = 0;
+    uint32_t repeated = 0;
+    uint32_t count = static_cast<uint32_t>(checksums.size());
+
+    // Report runs rather than single frames, as a stall usually spans several
+    uint32_t i = 0;
+    while (i < count) {
+        bool drop = isDropped(i);
+        bool repeat = !drop && isRepeat(i);
+        if (!drop && !repeat) {
+            i++;
+            continue;
+        }
+
+        uint32_t end = i + 1;
+        while (end < count && (drop ? isDropped(end) : isRepeat(end))) end++;
+
+        if (drop) {
+            out << "  Dropped frames " << i << "-" << (end - 1) << std::endl;
+            dropped += end - i;
+        } else {
+            out << "  Frames " << i << "-" << (end - 1) << " repeat frame " << (i - 1) << std::endl;
+            repeated += end - i;
+        }
+        i = end;
+    }
+
+    out << "Dropped frames: " << dropped << ", repeated frames: " << repeated << std::endl;
+}
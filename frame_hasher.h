@@ -0,0 +1,123 @@
+/**
+ * @file frame_hasher.h
+ * @brief Per-frame checksums and duplicate-frame detection
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the FrameHasher class, which fingerprints every frame
+ * payload of a video stream with CRC-32C so that archived copies can be
+ * checked against the originals and dropped or repeated frames found.
+ */
+
+#ifndef FRAME_HASHER_H
+#define FRAME_HASHER_H
+
+#include "avi_reader.h"
+#include "thread_pool.h"
+#include <atomic>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Parallel CRC-32C fingerprinting of a video stream
+ *
+ * The stream's chunks are split into runs of consecutive frames of a few
+ * megabytes. Each run is fetched with one positional read and checksummed
+ * on a pool worker, so disks see large sequential requests from several
+ * threads at once while the checksums keep up on the other cores.
+ *
+ * The manifest lists one line per frame; two manifests of identical files
+ * are identical. Frames are flagged as:
+ * - dropped: the chunk is empty (compressed frames are shorter than a full
+ *   frame by design, so the size is not compared)
+ * - repeat: same size and checksum as the previous frame
+ *
+ * Usage example:
+ * @code
+ * FrameHasher hasher(reader, reader.getVideoStream(), 0);
+ * if (hasher.run()) {
+ *     hasher.writeManifest(std::cout, "video.avi");
+ * }
+ * @endcode
+ */
+class FrameHasher {
+private:
+    const AVIReader& reader;         ///< Source of frame data
+    int streamNumber;                ///< Video stream to fingerprint
+    ThreadPool pool;                 ///< Workers for reads and checksums
+    std::vector<uint32_t> checksums; ///< CRC-32C of each frame payload
+    std::atomic<bool> failed;        ///< Set when a read fails
+    uint64_t bytesHashed;            ///< Payload bytes checksummed
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param reader Open reader; must outlive this object
+     * @param streamNumber Video stream to fingerprint
+     * @param threads Worker threads; 0 uses one per hardware thread
+     */
+    FrameHasher(const AVIReader& reader, int streamNumber, unsigned threads);
+
+    /**
+     * @brief Checksum every frame of the stream
+     *
+     * @return true on success, false if the stream is not a video stream or a read failed
+     */
+    bool run();
+
+    /**
+     * @brief Write the per-frame manifest
+     *
+     * One line per frame: index, file offset, size and checksum, followed
+     * by a flag for dropped and repeated frames.
+     *
+     * @param out Destination stream
+     * @param filepath File name recorded in the manifest header
+     */
+    void writeManifest(std::ostream& out, const std::string& filepath) const;
+
+    /**
+     * @brief Print the runs of dropped and repeated frames
+     *
+     * @param out Destination stream
+     */
+    void printSummary(std::ostream& out) const;
+
+    /** @brief Checksum of each frame payload */
+    const std::vector<uint32_t>& getChecksums() const { return checksums; }
+
+    /** @brief Payload bytes checksummed by run() */
+    uint64_t getBytesHashed() const { return bytesHashed; }
+
+    /** @brief Worker threads used by run() */
+    unsigned getThreadCount() const { return pool.getThreadCount(); }
+
+private:
+    FrameHasher(const FrameHasher&);
+    FrameHasher& operator=(const FrameHasher&);
+
+    /**
+     * @brief Read and checksum a run of consecutive frames
+     *
+     * Runs on a pool worker.
+     *
+     * @param first First frame of the run
+     * @param count Number of frames
+     */
+    void hashRun(uint32_t first, uint32_t count);
+
+    /**
+     * @brief Check whether a frame is dropped
+     */
+    bool isDropped(uint32_t frameIndex) const;
+
+    /**
+     * @brief Check whether a frame repeats the previous one
+     */
+    bool isRepeat(uint32_t frameIndex) const;
+};
+
+#endif // FRAME_HASHER_H
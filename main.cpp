@@ -9,8 +9,20 @@
  * arguments, creates an AVIPlayer instance, and manages the playback lifecycle.
  */
 
+#include "avi_editor.h"
 #include "avi_player.h"
+#include "contact_sheet.h"
+#include "crc32c.h"
+#include "frame_analyzer.h"
+#include "frame_exporter.h"
+#include "frame_hasher.h"
+#include "path_pattern.h"
+#include "video_wall.h"
 #include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <memory>
 
 /**
  * @brief Print usage information
@@ -20,23 +32,375 @@
  * @param programName Name of the program executable
  */
 void printUsage(const char* programName) {
-    std::cout << "AVI Player v1.0 - Simple Uncompressed AVI Video Player" << std::endl;
-    std::cout << "Usage: " << programName << " <avi_file_path>" << std::endl;
+    std::cout << "AVI Player v1.0 - Simple AVI Video Player" << std::endl;
+    std::cout << "Usage: " << programName << " [options] <avi_file_path>..." << std::endl;
+    std::cout << "       " << programName << " --wall [--wall-size WxH] [--threads n] <avi_file>..." << std::endl;
+    std::cout << "       " << programName << " --export <raw|y4m|ppm|avi> [--output path] [--frames a-b] <avi_file>" << std::endl;
+    std::cout << "       " << programName << " --hash [--output manifest] [--threads n] <avi_file>" << std::endl;
+    std::cout << "       " << programName << " --analyze [--output csv] [--threads n] <avi_file>" << std::endl;
+    std::cout << "       " << programName << " --contact-sheet <image> [--grid CxR] [--thumb-width n] <avi_file>" << std::endl;
+    std::cout << "       " << programName << " --trim --frames a-b --output <avi> <avi_file>" << std::endl;
+    std::cout << "       " << programName << " --split <frames> --output <pattern> <avi_file>" << std::endl;
+    std::cout << "       " << programName << " --concat --output <avi> <avi_file>..." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  --cache-mb <n>   Keep up to n MB of converted frames for seeking and looping" << std::endl;
+    std::cout << "  --loop           Loop playback" << std::endl;
+    std::cout << "  --reverse        Start playing backwards from the last frame" << std::endl;
+    std::cout << "  --speed <rate>   Playback speed from 0.1 to 32 (default 1)" << std::endl;
+    std::cout << "  --no-audio       Do not play the audio stream" << std::endl;
+    std::cout << "  --fullscreen     Start in fullscreen (the window can also be resized)" << std::endl;
+    std::cout << "  --dirty-rects    Upload only the regions that changed since the previous frame" << std::endl;
+    std::cout << "  --textures <n>   Streaming textures per stream, written in turn, 1 to 3 (default 2)" << std::endl;
+    std::cout << "  --vsync          Present frames in step with the display refresh" << std::endl;
+    std::cout << "  --playlist <file> Also play the files listed in a text file, one per line" << std::endl;
+    std::cout << "  --video-stream <n|all>" << std::endl;
+    std::cout << "                   Show video stream n (repeat to show several side by side)" << std::endl;
+    std::cout << "  --wall           Play all given files as tiles of one window (video wall)" << std::endl;
+    std::cout << "  --wall-size <WxH> Size of the video wall window (default 1920x1080)" << std::endl;
+    std::cout << "  --threads <n>    Worker threads of the video wall and of MJPG decoding (default: one per core)" << std::endl;
+    std::cout << "  --export <fmt>   Write frames as raw RGB24, Y4M, PPM or uncompressed AVI instead of playing" << std::endl;
+    std::cout << "  --output <path>  Export destination: - for stdout (default), a file, or" << std::endl;
+    std::cout << "                   a pattern such as frame%05d.ppm for one file per frame" << std::endl;
+    std::cout << "  --frames <a-b>   Export only frames a to b (inclusive)" << std::endl;
+    std::cout << "  --hash           Write a CRC-32C manifest of all frames and report" << std::endl;
+    std::cout << "                   dropped and repeated frames" << std::endl;
+    std::cout << "  --analyze        Write per-frame luma differences as CSV and report" << std::endl;
+    std::cout << "                   scene cuts and frozen stretches" << std::endl;
+    std::cout << "  --cut-threshold <x>    Mean luma difference of a scene cut (default 30)" << std::endl;
+    std::cout << "  --freeze-threshold <x> Largest mean luma difference of a frozen frame (default 0.5)" << std::endl;
+    std::cout << "  --contact-sheet <image> Write evenly spaced thumbnails as one BMP (or .ppm) image" << std::endl;
+    std::cout << "  --grid <CxR>     Columns and rows of the contact sheet (default 4x4)" << std::endl;
+    std::cout << "  --thumb-width <n> Largest thumbnail width in pixels (default 320)" << std::endl;
+    std::cout << "  --trim           Copy frames a to b (--frames) losslessly into a new AVI file" << std::endl;
+    std::cout << "  --split <n>      Split into AVI files of n frames each, named by a pattern" << std::endl;
+    std::cout << "                   such as part%03d.avi" << std::endl;
+    std::cout << "  --concat         Join files of the same format losslessly into one AVI file" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Several files are played back to back without gaps." << std::endl;
     std::cout << std::endl;
     std::cout << "Supported formats:" << std::endl;
-    std::cout << "  - Uncompressed AVI files only" << std::endl;
-    std::cout << "  - 8-bit indexed color (with palette)" << std::endl;
-    std::cout << "  - 16-bit RGB565" << std::endl;
+    std::cout << "  - 8-bit indexed color (with palette), RLE8 and RLE4" << std::endl;
+    std::cout << "  - 16-bit RGB555 and RGB565, and other BI_BITFIELDS masks" << std::endl;
     std::cout << "  - 24-bit RGB" << std::endl;
-    std::cout << "  - 32-bit RGBA" << std::endl;
+    std::cout << "  - 32-bit XRGB and ARGB" << std::endl;
+    std::cout << "  - YUV: YUY2, UYVY, I420, YV12 and NV12" << std::endl;
+    std::cout << "  - 10-bit v210, 48-bit and 64-bit RGB (b48r, b64a)" << std::endl;
+    std::cout << "  - Motion-JPEG (MJPG), if built with libjpeg-turbo" << std::endl;
+    std::cout << "  - PCM or float audio (played at normal forward speed)" << std::endl;
     std::cout << std::endl;
     std::cout << "Controls:" << std::endl;
     std::cout << "  ESC key or close window to exit" << std::endl;
+    std::cout << "  SPACE            Pause / resume" << std::endl;
+    std::cout << "  LEFT / RIGHT     Seek back / forward one second" << std::endl;
+    std::cout << "  , / .            Step one frame back / forward" << std::endl;
+    std::cout << "  HOME             Go to the start (of the loop section)" << std::endl;
+    std::cout << "  R                Toggle reverse playback" << std::endl;
+    std::cout << "  UP / DOWN        Faster / slower (0.1x to 32x)" << std::endl;
+    std::cout << "  1                Normal speed" << std::endl;
+    std::cout << "  L                Toggle looping" << std::endl;
+    std::cout << "  F                Toggle fullscreen" << std::endl;
+    std::cout << "  [ / ]            Set loop section start / end at the current frame" << std::endl;
     std::cout << std::endl;
-    std::cout << "Note: For compressed AVI files, convert to uncompressed format first:" << std::endl;
+    std::cout << "Note: Other codecs (H.264, MPEG-4, ...) are not decoded; convert such files first:" << std::endl;
     std::cout << "  ffmpeg -i input.avi -c:v rawvideo -pix_fmt bgr24 -f avi output.avi" << std::endl;
 }
 
+/**
+ * @brief Play several files as a video wall
+ * 
+ * @param files Paths of the AVI files
+ * @param width Width of the wall in pixels
+ * @param height Height of the wall in pixels
+ * @param threads Worker threads, 0 for one per core
+ * @return 0 on success, 1 on error
+ */
+int playVideoWall(const std::vector<std::string>& files, uint32_t width, uint32_t height, unsigned threads) {
+    VideoWall wall(width, height, threads);
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!wall.addFile(files[i])) {
+            std::cerr << "Skipping " << files[i] << std::endl;
+        }
+    }
+    
+    if (!wall.initSDL()) {
+        std::cerr << "Failed to initialize the video wall" << std::endl;
+        return 1;
+    }
+    
+    std::cout << std::endl;
+    wall.play();
+    
+    std::cout << "Playback finished. Goodbye!" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Export the frames of a file
+ * 
+ * @param filepath Path of the AVI file
+ * @param format Output format
+ * @param output Output path, "-" for stdout
+ * @param stream Video stream to export, -1 for the primary stream
+ * @param first First frame to export
+ * @param last Last frame to export, -1 for the last frame of the stream
+ * @return 0 on success, 1 on error
+ */
+int exportFrames(const std::string& filepath, FrameExporter::Format format, const std::string& output,
+                 int stream, uint32_t first, int64_t last) {
+    AVIReader reader;
+    if (!reader.open(filepath)) {
+        return 1;
+    }
+    if (stream < 0) stream = reader.getVideoStream();
+    if (last < 0) last = static_cast<int64_t>(reader.getStream(stream).getChunkCount()) - 1;
+    
+    auto start = std::chrono::steady_clock::now();
+    FrameExporter exporter(reader, stream);
+    if (!exporter.open(output, format) ||
+        !exporter.exportFrames(first, static_cast<uint32_t>(std::max<int64_t>(last, 0)))) {
+        std::cerr << "Export failed" << std::endl;
+        return 1;
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Exported " << exporter.getFramesWritten() << " frames ("
+              << (exporter.getBytesWritten() >> 20) << " MB) in " << seconds << " seconds" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Write the per-frame checksum manifest of a file
+ * 
+ * @param filepath Path of the AVI file
+ * @param output Manifest path, "-" for stdout
+ * @param stream Video stream to fingerprint, -1 for the primary stream
+ * @param threads Worker threads, 0 for one per core
+ * @param standardOutput Stream the manifest goes to for "-"; messages go to std::cout
+ * @return 0 on success, 1 on error
+ */
+int hashFrames(const std::string& filepath, const std::string& output, int stream, unsigned threads,
+               std::ostream& standardOutput) {
+    AVIReader reader;
+    if (!reader.open(filepath)) {
+        return 1;
+    }
+    if (stream < 0) stream = reader.getVideoStream();
+    
+    auto start = std::chrono::steady_clock::now();
+    FrameHasher hasher(reader, stream, threads);
+    if (!hasher.run()) {
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if (output == "-") {
+        hasher.writeManifest(standardOutput, filepath);
+    } else {
+        std::ofstream manifest(output);
+        if (!manifest.is_open()) {
+            std::cerr << "Error: Cannot create file " << output << std::endl;
+            return 1;
+        }
+        hasher.writeManifest(manifest, filepath);
+    }
+    
+    std::cout << "Hashed " << hasher.getChecksums().size() << " frames ("
+              << (hasher.getBytesHashed() >> 20) << " MB) in " << seconds << " seconds on "
+              << hasher.getThreadCount() << " threads using " << crc32cImplementation() << std::endl;
+    hasher.printSummary(std::cout);
+    return 0;
+}
+
+/**
+ * @brief Write the frame difference time series of a file
+ * 
+ * @param filepath Path of the AVI file
+ * @param output CSV path, "-" for stdout
+ * @param stream Video stream to analyze, -1 for the primary stream
+ * @param threads Worker threads, 0 for one per core
+ * @param cutThreshold Mean luma difference of a scene cut
+ * @param freezeThreshold Largest mean luma difference of a frozen frame
+ * @param standardOutput Stream the CSV goes to for "-"; messages go to std::cout
+ * @return 0 on success, 1 on error
+ */
+int analyzeFrames(const std::string& filepath, const std::string& output, int stream, unsigned threads,
+                  double cutThreshold, double freezeThreshold, std::ostream& standardOutput) {
+    AVIReader reader;
+    if (!reader.open(filepath)) {
+        return 1;
+    }
+    if (stream < 0) stream = reader.getVideoStream();
+    
+    auto start = std::chrono::steady_clock::now();
+    FrameAnalyzer analyzer(reader, stream, threads);
+    analyzer.setThresholds(cutThreshold, freezeThreshold);
+    if (!analyzer.run()) {
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    if (output == "-") {
+        analyzer.writeTimeSeries(standardOutput);
+    } else {
+        std::ofstream csv(output);
+        if (!csv.is_open()) {
+            std::cerr << "Error: Cannot create file " << output << std::endl;
+            return 1;
+        }
+        analyzer.writeTimeSeries(csv);
+    }
+    
+    double duration = analyzer.getDifferences().size() * analyzer.getFrameSeconds();
+    std::cout << "Analyzed " << analyzer.getDifferences().size() << " frames in " << seconds
+              << " seconds on " << analyzer.getThreadCount() << " threads";
+    if (seconds > 0) {
+        std::cout << " (" << (duration / seconds) << "x real time)";
+    }
+    std::cout << std::endl;
+    analyzer.printSummary(std::cout);
+    return 0;
+}
+
+/**
+ * @brief Write a contact sheet of a file
+ * 
+ * @param filepath Path of the AVI file
+ * @param output Image path
+ * @param stream Video stream to render, -1 for the primary stream
+ * @param threads Worker threads, 0 for one per core
+ * @param columns Thumbnails per row
+ * @param rows Rows of thumbnails
+ * @param thumbWidth Largest thumbnail width in pixels
+ * @return 0 on success, 1 on error
+ */
+int writeContactSheet(const std::string& filepath, const std::string& output, int stream, unsigned threads,
+                      unsigned columns, unsigned rows, unsigned thumbWidth) {
+    auto start = std::chrono::steady_clock::now();
+    AVIReader reader;
+    if (!reader.open(filepath)) {
+        return 1;
+    }
+    if (stream < 0) stream = reader.getVideoStream();
+    
+    ContactSheet sheet(reader, stream, threads);
+    sheet.setLayout(columns, rows, thumbWidth);
+    if (!sheet.generate() || !sheet.write(output)) {
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Wrote " << sheet.getWidth() << "x" << sheet.getHeight() << " contact sheet of "
+              << sheet.getFrames().size() << " frames to " << output << " in " << seconds << " seconds" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Cut frames out of a file into new AVI files
+ * 
+ * @param filepath Path of the AVI file
+ * @param output Output path, or a pattern with the part number when splitting
+ * @param stream Video stream whose frames define the ranges, -1 for the primary stream
+ * @param first First frame to keep when trimming
+ * @param last Last frame to keep when trimming, -1 for the last frame of the stream
+ * @param framesPerPart Frames per part when splitting, 0 to trim
+ * @return 0 on success, 1 on error
+ */
+int editFile(const std::string& filepath, const std::string& output, int stream,
+             uint32_t first, int64_t last, uint32_t framesPerPart) {
+    if (output == "-" || (framesPerPart > 0 && !isNumberPattern(output))) {
+        std::cerr << "Error: " << (framesPerPart > 0 ? "--split needs an --output pattern such as part%03d.avi"
+                                                       : "--trim needs an --output file") << std::endl;
+        return 1;
+    }
+    
+    AVIReader reader;
+    if (!reader.open(filepath)) {
+        return 1;
+    }
+    if (stream < 0) stream = reader.getVideoStream();
+    if (last < 0) last = static_cast<int64_t>(reader.getStream(stream).getChunkCount()) - 1;
+    
+    auto start = std::chrono::steady_clock::now();
+    AVIEditor editor(reader, stream);
+    bool success = framesPerPart > 0 ? editor.split(output, framesPerPart)
+                                     : editor.trim(output, first, static_cast<uint32_t>(std::max<int64_t>(last, 0)));
+    if (!success) {
+        std::cerr << (framesPerPart > 0 ? "Split failed" : "Trim failed") << std::endl;
+        return 1;
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Wrote " << (editor.getBytesWritten() >> 20) << " MB in " << seconds << " seconds" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Join files into one AVI file
+ * 
+ * @param files Paths of the AVI files, in order
+ * @param output Output path
+ * @param stream Video stream that must match across the files, -1 for the primary stream
+ * @return 0 on success, 1 on error
+ */
+int concatFiles(const std::vector<std::string>& files, const std::string& output, int stream) {
+    if (output == "-") {
+        std::cerr << "Error: --concat needs an --output file" << std::endl;
+        return 1;
+    }
+    
+    std::vector<std::unique_ptr<AVIReader> > readers;
+    std::vector<const AVIReader*> others;
+    for (size_t i = 0; i < files.size(); ++i) {
+        readers.push_back(std::unique_ptr<AVIReader>(new AVIReader()));
+        if (!readers.back()->open(files[i])) {
+            return 1;
+        }
+        if (i > 0) others.push_back(readers.back().get());
+    }
+    if (stream < 0) stream = readers[0]->getVideoStream();
+    
+    auto start = std::chrono::steady_clock::now();
+    AVIEditor editor(*readers[0], stream);
+    if (!editor.concat(output, others)) {
+        std::cerr << "Concatenation failed" << std::endl;
+        return 1;
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Wrote " << (editor.getBytesWritten() >> 20) << " MB in " << seconds << " seconds" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Read a playlist file
+ * 
+ * Each non-empty line is the path of an AVI file; lines starting with
+ * '#' are comments.
+ * 
+ * @param listPath Path to the playlist file
+ * @param files Receives the listed paths
+ * @return true if the file could be read, false otherwise
+ */
+bool readPlaylist(const std::string& listPath, std::vector<std::string>& files) {
+    std::ifstream list(listPath);
+    if (!list.is_open()) {
+        std::cerr << "Error: Cannot read playlist '" << listPath << "'" << std::endl;
+        return false;
+    }
+    
+    std::string line;
+    while (std::getline(list, line)) {
+        // Tolerate lists written on Windows
+        if (!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        if (line.empty() || line[0] == '#') continue;
+        files.push_back(line);
+    }
+    return true;
+}
+
 /**
  * @brief Main program entry point
  * 
@@ -48,20 +412,200 @@ void printUsage(const char* programName) {
  * @return 0 on success, 1 on error
  */
 int main(int argc, char* argv[]) {
-    // Check command line arguments
-    if (argc != 2) {
-        if (argc > 2) {
-            std::cerr << "Error: Too many arguments" << std::endl;
+    std::string filepath;
+    std::vector<std::string> files;
+    size_t cacheMegabytes = 0;
+    bool loop = false;
+    bool reverse = false;
+    double speed = 1.0;
+    bool audio = true;
+    bool fullscreen = false;
+    bool dirtyRects = false;
+    unsigned textureCount = 2;
+    bool vsync = false;
+    std::vector<int> videoStreams;
+    bool wall = false;
+    unsigned wallWidth = 1920;
+    unsigned wallHeight = 1080;
+    unsigned threads = 0;
+    bool exporting = false;
+    bool hashing = false;
+    bool analyzing = false;
+    double cutThreshold = 30.0;
+    double freezeThreshold = 0.5;
+    std::string contactSheet;
+    unsigned gridColumns = 4;
+    unsigned gridRows = 4;
+    unsigned thumbWidth = 320;
+    bool trimming = false;
+    unsigned framesPerPart = 0;
+    bool concatenating = false;
+    FrameExporter::Format exportFormat = FrameExporter::FORMAT_RAW;
+    std::string exportOutput = "-";
+    unsigned firstFrame = 0;
+    long long lastFrame = -1;
+    
+    // Parse command line arguments
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        
+        if (arg == "--cache-mb" && i + 1 < argc) {
+            cacheMegabytes = std::strtoul(argv[++i], nullptr, 10);
+        } else if (arg == "--loop") {
+            loop = true;
+        } else if (arg == "--reverse") {
+            reverse = true;
+        } else if (arg == "--speed" && i + 1 < argc) {
+            speed = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--no-audio") {
+            audio = false;
+        } else if (arg == "--fullscreen") {
+            fullscreen = true;
+        } else if (arg == "--dirty-rects") {
+            dirtyRects = true;
+        } else if (arg == "--textures" && i + 1 < argc) {
+            textureCount = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--vsync") {
+            vsync = true;
+        } else if (arg == "--playlist" && i + 1 < argc) {
+            if (!readPlaylist(argv[++i], files)) {
+                return 1;
+            }
+        } else if (arg == "--video-stream" && i + 1 < argc) {
+            std::string stream = argv[++i];
+            videoStreams.push_back(stream == "all" ? -1 : std::atoi(stream.c_str()));
+        } else if (arg == "--wall") {
+            wall = true;
+        } else if (arg == "--wall-size" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%ux%u", &wallWidth, &wallHeight) != 2 ||
+                wallWidth == 0 || wallHeight == 0) {
+                std::cerr << "Error: Invalid wall size '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--export" && i + 1 < argc) {
+            exporting = true;
+            if (!FrameExporter::parseFormat(argv[++i], exportFormat)) {
+                std::cerr << "Error: Unknown export format '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--hash") {
+            hashing = true;
+        } else if (arg == "--analyze") {
+            analyzing = true;
+        } else if (arg == "--cut-threshold" && i + 1 < argc) {
+            cutThreshold = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--freeze-threshold" && i + 1 < argc) {
+            freezeThreshold = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--contact-sheet" && i + 1 < argc) {
+            contactSheet = argv[++i];
+        } else if (arg == "--grid" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%ux%u", &gridColumns, &gridRows) != 2 ||
+                gridColumns == 0 || gridRows == 0) {
+                std::cerr << "Error: Invalid grid '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--thumb-width" && i + 1 < argc) {
+            thumbWidth = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--trim") {
+            trimming = true;
+        } else if (arg == "--split" && i + 1 < argc) {
+            framesPerPart = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            if (framesPerPart == 0) {
+                std::cerr << "Error: Invalid part length '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--concat") {
+            concatenating = true;
+        } else if (arg == "--output" && i + 1 < argc) {
+            exportOutput = argv[++i];
+        } else if (arg == "--frames" && i + 1 < argc) {
+            if (std::sscanf(argv[++i], "%u-%lld", &firstFrame, &lastFrame) != 2 ||
+                lastFrame < static_cast<long long>(firstFrame)) {
+                std::cerr << "Error: Invalid frame range '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            std::cerr << "Error: Unknown or incomplete option '" << arg << "'" << std::endl;
+            std::cerr << std::endl;
+            printUsage(argv[0]);
+            return 1;
         } else {
-            std::cerr << "Error: Missing AVI file path" << std::endl;
+            files.push_back(arg);
+        }
+    }
+    
+    if (wall && !files.empty()) {
+        return playVideoWall(files, wallWidth, wallHeight, threads);
+    }
+    
+    if (!contactSheet.empty()) {
+        if (files.size() != 1) {
+            std::cerr << "Error: --contact-sheet takes exactly one AVI file" << std::endl;
+            return 1;
         }
+        int stream = videoStreams.empty() ? -1 : videoStreams[0];
+        return writeContactSheet(files[0], contactSheet, stream, threads, gridColumns, gridRows, thumbWidth);
+    }
+    
+    if (trimming || framesPerPart > 0) {
+        if (files.size() != 1) {
+            std::cerr << "Error: " << (trimming ? "--trim" : "--split") << " takes exactly one AVI file" << std::endl;
+            return 1;
+        }
+        int stream = videoStreams.empty() ? -1 : videoStreams[0];
+        return editFile(files[0], exportOutput, stream, firstFrame, lastFrame, trimming ? 0 : framesPerPart);
+    }
+    
+    if (concatenating) {
+        if (files.empty()) {
+            std::cerr << "Error: --concat needs at least one AVI file" << std::endl;
+            return 1;
+        }
+        int stream = videoStreams.empty() ? -1 : videoStreams[0];
+        return concatFiles(files, exportOutput, stream);
+    }
+    
+    if (exporting || hashing || analyzing) {
+        if (files.size() != 1) {
+            std::cerr << "Error: " << (hashing ? "--hash" : analyzing ? "--analyze" : "--export")
+                      << " takes exactly one AVI file" << std::endl;
+            return 1;
+        }
+        // Keep stdout clean for the exported frames or the manifest
+        std::streambuf* stdoutBuffer = std::cout.rdbuf();
+        std::ostream standardOutput(stdoutBuffer);
+        if (exportOutput == "-") {
+            std::cout.rdbuf(std::cerr.rdbuf());
+        }
+        int stream = videoStreams.empty() ? -1 : videoStreams[0];
+        int result;
+        if (hashing) {
+            result = hashFrames(files[0], exportOutput, stream, threads, standardOutput);
+        } else if (analyzing) {
+            result = analyzeFrames(files[0], exportOutput, stream, threads, cutThreshold, freezeThreshold, standardOutput);
+        } else {
+            result = exportFrames(files[0], exportFormat, exportOutput, stream, firstFrame, lastFrame);
+        }
+        std::cout.rdbuf(stdoutBuffer);
+        return result;
+    }
+    
+    if (!files.empty()) {
+        filepath = files[0];
+    }
+    
+    if (filepath.empty()) {
+        std::cerr << "Error: Missing AVI file path" << std::endl;
         std::cerr << std::endl;
         printUsage(argv[0]);
         return 1;
     }
     
-    std::string filepath = argv[1];
-    
     // Check if file exists by trying to open it
     std::ifstream testFile(filepath);
     if (!testFile.is_open()) {
@@ -75,13 +619,25 @@ int main(int argc, char* argv[]) {
     
     // Create player instance
     AVIPlayer player;
+    player.setCacheBudget(cacheMegabytes << 20);
+    player.setLoop(loop);
+    player.setReverse(reverse);
+    player.setPlaybackRate(speed);
+    player.setAudioEnabled(audio);
+    player.setFullscreen(fullscreen);
+    player.setDirtyRegions(dirtyRects);
+    player.setTextureCount(textureCount);
+    player.setVSync(vsync);
+    player.setVideoStreams(videoStreams);
+    player.setPlaylist(files);
+    player.setDecodeThreads(threads);
     
     // Load the AVI file
     if (!player.loadAVI(filepath)) {
         std::cerr << "Failed to load AVI file: " << filepath << std::endl;
         std::cerr << std::endl;
         std::cerr << "Common issues:" << std::endl;
-        std::cerr << "  - File may be compressed (use FFmpeg to convert)" << std::endl;
+        std::cerr << "  - Video may use a codec other than those listed by --help (use FFmpeg to convert)" << std::endl;
         std::cerr << "  - File may be corrupted or invalid" << std::endl;
         std::cerr << "  - File may not be an AVI format" << std::endl;
         return 1;
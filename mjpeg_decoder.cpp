@@ -0,0 +1,238 @@
+/**
+ * @file mjpeg_decoder.cpp
+ * @brief Implementation of the MJPEGDecoder class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "mjpeg_decoder.h"
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef HAVE_LIBJPEG
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+
+namespace {
+    /**
+     * @brief libjpeg error handler that returns to decodeImage()
+     *
+     * libjpeg's default handler exits the program on corrupt data.
+     */
+    struct ErrorManager {
+        jpeg_error_mgr base;    ///< libjpeg's handler, first so the two pointers convert
+        jmp_buf jump;           ///< Return point in decodeImage()
+    };
+
+    void onError(j_common_ptr info) {
+        longjmp(reinterpret_cast<ErrorManager*>(info->err)->jump, 1);
+    }
+
+    void onMessage(j_common_ptr, int) {
+        // Capture devices often cut the entropy data short; such frames
+        // are still shown, without a warning for each of them
+    }
+}
+#endif
+
+MJPEGDecoder::MJPEGDecoder(const AVIReader& reader, int streamNumber, const FrameConverter& converter)
+    : reader(reader), streamNumber(streamNumber), stream(reader.getStream(streamNumber)),
+      converter(converter), image(static_cast<size_t>(converter.getSourceStride()) * converter.getHeight()), imageFrame(-1),
+      pool(nullptr), window(nullptr), stride(1), decodeFailures(0) {
+}
+
+MJPEGDecoder::~MJPEGDecoder() {
+    // Tasks in flight write into the slots
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this] {
+        for (size_t i = 0; i < slots.size(); ++i) {
+            if (slots[i].busy) return false;
+        }
+        return true;
+    });
+}
+
+void MJPEGDecoder::startPipeline(ThreadPool& workers, ReadAheadWindow& readAhead, uint32_t depth) {
+    pool = &workers;
+    window = &readAhead;
+    slots.resize(std::max(depth, 2u));
+    for (size_t i = 0; i < slots.size(); ++i) {
+        slots[i].image.resize(static_cast<size_t>(converter.getSourceStride()) * converter.getHeight());
+    }
+}
+
+const uint8_t* MJPEGDecoder::decode(uint32_t frameIndex, const uint8_t* frameData) {
+    if (frameIndex >= stream.getChunkCount()) return nullptr;
+    uint32_t width = converter.getWidth();
+    uint32_t height = converter.getHeight();
+    int pitch = static_cast<int>(converter.getSourceStride());
+
+    if (!pool) {
+        if (imageFrame == frameIndex) return image.data();
+        uint32_t size = stream.chunkSizes[frameIndex];
+        if (!frameData) {
+            if (chunk.size() < size) chunk.resize(size);
+            if (!reader.readChunk(streamNumber, frameIndex, chunk.data(), chunk.size())) return nullptr;
+            frameData = chunk.data();
+        }
+
+        imageFrame = -1;
+        if (!decodeImage(frameData, size, image.data(), pitch, width, height)) {
+            decodeFailures++;
+            return nullptr;
+        }
+        imageFrame = frameIndex;
+        return image.data();
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    Slot* slot = findSlot(frameIndex);
+    if (!slot) slot = schedule(lock, frameIndex, frameData, frameIndex, true);
+    if (!slot) return nullptr;
+
+    // Keep the following frames decoding while this one is shown; empty
+    // chunks are dropped frames and never requested
+    int64_t next = frameIndex;
+    for (size_t k = 1; k < slots.size(); ++k) {
+        next += stride;
+        if (next < 0 || next >= static_cast<int64_t>(stream.getChunkCount())) break;
+        if (stream.chunkSizes[next] == 0 || findSlot(static_cast<uint32_t>(next))) continue;
+        if (!schedule(lock, static_cast<uint32_t>(next), nullptr, frameIndex, false)) break;
+    }
+
+    finished.wait(lock, [slot] { return !slot->busy; });
+    if (!slot->decoded) {
+        decodeFailures++;
+        return nullptr;
+    }
+    return slot->image.data();
+}
+
+MJPEGDecoder::Slot* MJPEGDecoder::findSlot(uint32_t frameIndex) {
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i].frame == frameIndex) return &slots[i];
+    }
+    return nullptr;
+}
+
+MJPEGDecoder::Slot* MJPEGDecoder::schedule(std::unique_lock<std::mutex>& lock, uint32_t frameIndex,
+                                           const uint8_t* frameData, uint32_t current, bool wait) {
+    Slot* slot = nullptr;
+    for (;;) {
+        for (size_t i = 0; i < slots.size() && !slot; ++i) {
+            if (!slots[i].busy && !isAhead(slots[i].frame, current)) slot = &slots[i];
+        }
+        if (slot || !wait) break;
+        // All slots still decode frames of an earlier position
+        finished.wait(lock);
+    }
+    if (!slot) return nullptr;
+
+    // Idle slots belong to this thread, so the chunk is fetched unlocked
+    slot->frame = -1;
+    slot->decoded = false;
+    lock.unlock();
+    uint32_t size = stream.chunkSizes[frameIndex];
+    if (!frameData) frameData = window->acquire(frameIndex);
+    if (frameData) slot->chunk.assign(frameData, frameData + size);
+    lock.lock();
+    if (!frameData) return nullptr;
+
+    slot->frame = frameIndex;
+    slot->busy = true;
+    uint32_t width = converter.getWidth();
+    uint32_t height = converter.getHeight();
+    int pitch = static_cast<int>(converter.getSourceStride());
+    pool->submit([this, slot, width, height, pitch] {
+        bool decoded = decodeImage(slot->chunk.data(), slot->chunk.size(), slot->image.data(), pitch, width, height);
+        std::lock_guard<std::mutex> guard(mutex);
+        slot->decoded = decoded;
+        slot->busy = false;
+        finished.notify_all();
+    });
+    return slot;
+}
+
+bool MJPEGDecoder::isAhead(int64_t frameIndex, uint32_t current) const {
+    if (frameIndex < 0 || stride == 0) return false;
+    int64_t distance = (frameIndex - static_cast<int64_t>(current)) * (stride < 0 ? -1 : 1);
+    int64_t step = std::abs(stride);
+    return distance >= 0 && distance % step == 0 && distance / step < static_cast<int64_t>(slots.size());
+}
+
+bool MJPEGDecoder::isAvailable() {
+#ifdef HAVE_LIBJPEG
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef HAVE_LIBJPEG
+bool MJPEGDecoder::decodeImage(const uint8_t* data, size_t size, uint8_t* pixels, int pitch,
+                               uint32_t width, uint32_t height) {
+    jpeg_decompress_struct info;
+    ErrorManager errors;
+    info.err = jpeg_std_error(&errors.base);
+    errors.base.error_exit = onError;
+    errors.base.emit_message = onMessage;
+    if (setjmp(errors.jump)) {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+
+    // AVI1 frames usually leave out the Huffman tables; libjpeg-turbo
+    // falls back to the standard ones
+    jpeg_create_decompress(&info);
+    jpeg_mem_src(&info, const_cast<unsigned char*>(data), static_cast<unsigned long>(size));
+    if (jpeg_read_header(&info, TRUE) != JPEG_HEADER_OK ||
+        info.image_width != width || info.image_height != height) {
+        jpeg_destroy_decompress(&info);
+        return false;
+    }
+
+    // libjpeg-turbo writes the texture layout directly; plain libjpeg
+    // writes RGB, which is widened in place
+#ifdef JCS_EXTENSIONS
+    info.out_color_space = JCS_EXT_BGRA;
+#else
+    info.out_color_space = JCS_RGB;
+#endif
+    jpeg_start_decompress(&info);
+    while (info.output_scanline < info.output_height) {
+        JSAMPROW rows[16];
+        JDIMENSION count = std::min<JDIMENSION>(16, info.output_height - info.output_scanline);
+        for (JDIMENSION i = 0; i < count; ++i) {
+            rows[i] = pixels + static_cast<size_t>(info.output_scanline + i) * pitch;
+        }
+        count = jpeg_read_scanlines(&info, rows, count);
+        if (count == 0) {
+            jpeg_destroy_decompress(&info);
+            return false;
+        }
+#ifndef JCS_EXTENSIONS
+        for (JDIMENSION i = 0; i < count; ++i) {
+            uint8_t* row = rows[i];
+            for (uint32_t x = width; x-- > 0;) {
+                uint8_t red = row[x * 3 + 0];
+                uint8_t green = row[x * 3 + 1];
+                uint8_t blue = row[x * 3 + 2];
+                row[x * 4 + 0] = blue;
+                row[x * 4 + 1] = green;
+                row[x * 4 + 2] = red;
+                row[x * 4 + 3] = 0xFF;
+            }
+        }
+#endif
+    }
+    jpeg_finish_decompress(&info);
+    jpeg_destroy_decompress(&info);
+    return true;
+}
+#else
+bool MJPEGDecoder::decodeImage(const uint8_t*, size_t, uint8_t*, int, uint32_t, uint32_t) {
+    return false;
+}
+#endif
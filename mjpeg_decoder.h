@@ -0,0 +1,191 @@
+/**
+ * @file mjpeg_decoder.h
+ * @brief Decoding of Motion-JPEG streams on a pool of workers
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the MJPEGDecoder class. Every MJPG frame is a
+ * complete JPEG image, so frames can be decoded independently and in any
+ * order. During playback and export the decoder keeps the next frames
+ * along the playback stride in flight on a thread pool, collects them as
+ * they complete (possibly out of order) and hands them out in
+ * presentation order. Decoding uses libjpeg-turbo and is only available
+ * when the program is built with it (HAVE_LIBJPEG).
+ */
+
+#ifndef MJPEG_DECODER_H
+#define MJPEG_DECODER_H
+
+#include "avi_reader.h"
+#include "frame_converter.h"
+#include "read_ahead.h"
+#include "thread_pool.h"
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Decoded images of a Motion-JPEG stream
+ *
+ * Without a pipeline, decode() decodes the requested frame on the calling
+ * thread; analysis, contact sheets and the video wall decode frames on
+ * their own workers this way. After startPipeline(), decode() also keeps
+ * up to depth - 1 following frames (along the stride) decoding on the
+ * pool. Each has a slot holding its compressed chunk and its image. Slots
+ * complete in any order and are handed out when their frame is requested,
+ * which reorders them into presentation order. Slots of frames that are
+ * no longer ahead of the playback position, after a seek for example, are
+ * reused once their decode has finished.
+ *
+ * Frames are decoded to top-down ARGB8888 (B, G, R, A bytes), the display
+ * format of MJPG streams at full size, so the converter only copies them.
+ *
+ * An instance is used by one thread; only its decode tasks run elsewhere.
+ */
+class MJPEGDecoder {
+private:
+    /**
+     * @brief One frame of the decode pipeline
+     */
+    struct Slot {
+        int64_t frame;                  ///< Frame held by the slot, -1 if none
+        bool busy;                      ///< True while a worker decodes it
+        bool decoded;                   ///< True if the image holds the frame
+        std::vector<uint8_t> chunk;     ///< Compressed frame
+        std::vector<uint8_t> image;     ///< Decoded ARGB8888 image
+
+        Slot() : frame(-1), busy(false), decoded(false) {}
+    };
+
+    const AVIReader& reader;            ///< Source of frame data
+    int streamNumber;                   ///< Video stream being decoded
+    const AVIStream& stream;            ///< Chunk index of the stream
+    const FrameConverter& converter;    ///< Geometry of the stream
+
+    std::vector<uint8_t> chunk;         ///< Scratch buffer for frames read here
+    std::vector<uint8_t> image;         ///< Image decoded on the calling thread
+    int64_t imageFrame;                 ///< Frame the image shows, -1 if none
+
+    ThreadPool* pool;                   ///< Workers of the pipeline, null without one
+    ReadAheadWindow* window;            ///< Source of chunks of the pipeline
+    int stride;                         ///< Frame step of playback (negative = reverse)
+    std::vector<Slot> slots;            ///< Frames in flight or completed
+    std::mutex mutex;                   ///< Guards the busy and decoded flags of the slots
+    std::condition_variable finished;   ///< Signals a completed slot
+    uint64_t decodeFailures;            ///< Frames that were not valid JPEG images
+
+    /**
+     * @brief Find the slot of a frame
+     *
+     * @param frameIndex Frame to look for
+     * @return Slot holding the frame, or nullptr
+     */
+    Slot* findSlot(uint32_t frameIndex);
+
+    /**
+     * @brief Load a frame into a free slot and queue its decode
+     *
+     * Takes a slot that is idle and holds no frame of the window starting
+     * at @p current. Called with @p lock held; it is released while the
+     * chunk is fetched.
+     *
+     * @param lock Lock of mutex
+     * @param frameIndex Frame to decode
+     * @param frameData Chunk of the frame, or nullptr to fetch it
+     * @param current Frame being presented
+     * @param wait true to wait for a slot to become idle, false to give up
+     * @return Slot of the frame, or nullptr if none was free
+     */
+    Slot* schedule(std::unique_lock<std::mutex>& lock, uint32_t frameIndex, const uint8_t* frameData,
+                   uint32_t current, bool wait);
+
+    /**
+     * @brief Check whether a frame is among those kept ahead of playback
+     *
+     * @param frameIndex Frame to check
+     * @param current Frame being presented
+     * @return true if the frame lies within depth frames along the stride
+     */
+    bool isAhead(int64_t frameIndex, uint32_t current) const;
+
+public:
+    /**
+     * @brief Create a decoder for a Motion-JPEG stream
+     *
+     * @param reader Open AVI file
+     * @param streamNumber Video stream to decode
+     * @param converter Converter configured for that stream (isMotionJPEG() is true)
+     */
+    MJPEGDecoder(const AVIReader& reader, int streamNumber, const FrameConverter& converter);
+
+    /**
+     * @brief Destructor
+     *
+     * Waits for the decodes still in flight.
+     */
+    ~MJPEGDecoder();
+
+    /**
+     * @brief Decode ahead of playback on a thread pool
+     *
+     * Chunks are then taken from the read-ahead window, which the caller
+     * must no longer use itself. The pool and the window must outlive the
+     * decoder.
+     *
+     * @param workers Pool to decode on
+     * @param readAhead Window to fetch chunks from
+     * @param depth Frames kept in flight or completed, at least 2
+     */
+    void startPipeline(ThreadPool& workers, ReadAheadWindow& readAhead, uint32_t depth);
+
+    /**
+     * @brief Set the playback stride
+     *
+     * @param frameStride Frame step of playback (negative = reverse)
+     */
+    void setStride(int frameStride) { stride = frameStride; }
+
+    /**
+     * @brief Decode a frame
+     *
+     * @param frameIndex Frame to decode
+     * @param frameData Chunk of that frame if the caller has it already,
+     *                  nullptr to read it
+     * @return Decoded top-down ARGB8888 image, valid until
+     *         the next call, or nullptr if the chunk could not be read or
+     *         decoded
+     */
+    const uint8_t* decode(uint32_t frameIndex, const uint8_t* frameData);
+
+    /** @brief Number of frames that could not be decoded */
+    uint64_t getFailureCount() const { return decodeFailures; }
+
+    /**
+     * @brief Decode one JPEG image
+     *
+     * @param data JPEG data
+     * @param size Bytes of data
+     * @param pixels Destination of the top-down ARGB8888 image
+     * @param pitch Row stride of the destination in bytes
+     * @param width Expected image width
+     * @param height Expected image height
+     * @return true on success, false if the data is not a JPEG image of
+     *         that size or is damaged beyond its last row
+     */
+    static bool decodeImage(const uint8_t* data, size_t size, uint8_t* pixels, int pitch,
+                            uint32_t width, uint32_t height);
+
+    /**
+     * @brief Check whether the program was built with libjpeg-turbo
+     *
+     * @return true if decodeImage() can decode
+     */
+    static bool isAvailable();
+
+private:
+    MJPEGDecoder(const MJPEGDecoder&);
+    MJPEGDecoder& operator=(const MJPEGDecoder&);
+};
+
+#endif // MJPEG_DECODER_H
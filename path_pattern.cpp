@@ -0,0 +1,69 @@
+/**
+ * @file path_pattern.cpp
+ * @brief Implementation of the output path pattern helpers
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "path_pattern.h"
+
+namespace {
+    /**
+     * @brief Widest conversion accepted
+     */
+    const size_t kMaxWidth = 32;
+
+    /**
+     * @brief Walk a pattern, copying literal text and expanding conversions
+     *
+     * @param pattern Pattern to walk
+     * @param number Number to insert
+     * @param out Receives the expanded path, may be null when only checking
+     * @return Number of conversions, or -1 if the pattern has a bad one
+     */
+    int expand(const std::string& pattern, uint32_t number, std::string* out) {
+        int conversions = 0;
+        for (size_t i = 0; i < pattern.size(); ++i) {
+            if (pattern[i] != '%') {
+                if (out) out->push_back(pattern[i]);
+                continue;
+            }
+            if (i + 1 < pattern.size() && pattern[i + 1] == '%') {
+                if (out) out->push_back('%');
+                ++i;
+                continue;
+            }
+
+            // %[0-9]*[du]
+            size_t start = i + 1;
+            size_t end = start;
+            while (end < pattern.size() && pattern[end] >= '0' && pattern[end] <= '9') ++end;
+            if (end >= pattern.size() || (pattern[end] != 'd' && pattern[end] != 'u')) return -1;
+            if (end - start > 2) return -1;
+            size_t width = start < end ? std::stoul(pattern.substr(start, end - start)) : 0;
+            if (width > kMaxWidth) return -1;
+            ++conversions;
+
+            if (out) {
+                std::string digits = std::to_string(number);
+                if (digits.size() < width) {
+                    out->append(width - digits.size(), pattern[start] == '0' ? '0' : ' ');
+                }
+                out->append(digits);
+            }
+            i = end;
+        }
+        return conversions;
+    }
+}
+
+bool isNumberPattern(const std::string& pattern) {
+    return expand(pattern, 0, nullptr) == 1;
+}
+
+std::string formatNumberPattern(const std::string& pattern, uint32_t number) {
+    std::string path;
+    expand(pattern, number, &path);
+    return path;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file path_pattern.h
+ * @brief Output paths with a printf-style number
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header declares the helpers that check and expand output path
+ * patterns such as frame%05d.ppm or part%03d.avi. Patterns come from the
+ * command line, so they are parsed here rather than handed to printf: a
+ * pattern is valid with exactly one %d or %u conversion, optionally with
+ * a width (zero-padded when it starts with 0), and %% for a literal
+ * percent sign.
+ */
+
+#ifndef PATH_PATTERN_H
+#define PATH_PATTERN_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Check that a path is a valid number pattern
+ *
+ * @param pattern Path to check
+ * @return true if it has exactly one %d or %u conversion and no other unescaped %
+ */
+bool isNumberPattern(const std::string& pattern);
+
+/**
+ * @brief Expand a number pattern
+ *
+ * @param pattern Path accepted by isNumberPattern()
+ * @param number Number to insert
+ * @return The path with the number in place of its conversion and % in place of %%
+ */
+std::string formatNumberPattern(const std::string& pattern, uint32_t number);
+
+#endif // PATH_PATTERN_H
@@ -0,0 +1,195 @@
+/**
+ * @file read_ahead.cpp
+ * @brief Implementation of the ReadAheadWindow class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "read_ahead.h"
+#include <algorithm>
+
+namespace {
+    /**
+     * @brief Largest gap between two frames that are still read together
+     *
+     * Covers chunk headers, padding and small interleaved chunks, so frames
+     * that follow each other in the file become one read while frames that
+     * are skipped during fast playback are never read.
+     */
+    const uint64_t kCoalesceGap = 4096;
+}
+
+ReadAheadWindow::ReadAheadWindow(const AVIReader& reader, int streamNumber, size_t blockBytes)
+    : reader(reader), stream(reader.getStream(streamNumber)), blockBytes(blockBytes), current(0), stride(1),
+      prefetchPending(false), prefetchBusy(false), prefetchAnchor(0),
+      prefetchStride(1), stopping(false), stalls(0), bytesRead(0), readCalls(0) {
+    worker = std::thread(&ReadAheadWindow::workerLoop, this);
+}
+
+ReadAheadWindow::~ReadAheadWindow() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    worker.join();
+}
+
+void ReadAheadWindow::setStride(int frameStride) {
+    std::lock_guard<std::mutex> lock(mutex);
+    stride = frameStride != 0 ? frameStride : 1;
+}
+
+const uint8_t* ReadAheadWindow::acquire(uint32_t frameIndex) {
+    if (frameIndex >= stream.getChunkCount()) return nullptr;
+
+    std::unique_lock<std::mutex> lock(mutex);
+
+    int64_t position = find(blocks[current], frameIndex);
+    if (position < 0 || blocks[current].stride != stride) {
+        // The in-flight prefetch may be the block we need. After a stride
+        // change it is, once it was read along the new stride, even while
+        // the current block still holds the frame
+        cv.wait(lock, [this] { return !prefetchPending && !prefetchBusy; });
+
+        const Block& other = blocks[1 - current];
+        int64_t otherPosition = find(other, frameIndex);
+        if (otherPosition >= 0 && (position < 0 || other.stride == stride)) {
+            current = 1 - current;
+            position = otherPosition;
+        } else if (position < 0) {
+            // Not prefetched (first frame, seek, direction or speed
+            // change): the worker is idle, so read the block ourselves
+            stalls++;
+            int frameStride = stride;
+            lock.unlock();
+            fillBlock(blocks[current], frameIndex, frameStride);
+            lock.lock();
+            position = find(blocks[current], frameIndex);
+        }
+
+        schedulePrefetch(frameIndex);
+    }
+
+    if (position < 0) return nullptr;
+    const Block& block = blocks[current];
+    return block.data.data() + block.positions[static_cast<size_t>(position)];
+}
+
+int64_t ReadAheadWindow::find(const Block& block, uint32_t frameIndex) {
+    if (!block.valid) return -1;
+
+    int64_t distance = static_cast<int64_t>(frameIndex) - block.anchor;
+    if (distance % block.stride != 0) return -1;
+
+    int64_t position = distance / block.stride;
+    if (position < 0 || position >= block.count) return -1;
+    return position;
+}
+
+void ReadAheadWindow::fillBlock(Block& block, uint32_t anchor, int frameStride) {
+    int64_t frameCount = stream.getChunkCount();
+
+    // Schedule frames along the stride while their payloads fit the budget
+    std::vector<uint32_t> frames;
+    uint64_t scheduledBytes = 0;
+    for (int64_t index = anchor; index >= 0 && index < frameCount; index += frameStride) {
+        uint32_t size = stream.chunkSizes[static_cast<uint32_t>(index)];
+        if (!frames.empty() && scheduledBytes + size > blockBytes) break;
+        frames.push_back(static_cast<uint32_t>(index));
+        scheduledBytes += size;
+    }
+
+    // Visit frames in file order so that neighbours can share a read
+    std::vector<size_t> order(frames.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return stream.chunkOffsets[frames[a]] < stream.chunkOffsets[frames[b]];
+    });
+
+    // Group frames into runs that are read with one call each
+    struct Run {
+        uint64_t start;         ///< File offset of the run
+        uint64_t end;           ///< File offset one past the run
+        size_t dataPosition;    ///< Offset of the run in the block data
+    };
+    std::vector<Run> runs;
+    block.positions.resize(frames.size());
+    size_t dataSize = 0;
+
+    for (size_t k = 0; k < order.size(); ++k) {
+        uint32_t frameIndex = frames[order[k]];
+        uint64_t start = stream.chunkOffsets[frameIndex];
+        uint64_t end = start + stream.chunkSizes[frameIndex];
+
+        if (runs.empty() || start > runs.back().end + kCoalesceGap || start < runs.back().end) {
+            Run run = { start, end, dataSize };
+            runs.push_back(run);
+        } else {
+            runs.back().end = end;
+        }
+        Run& run = runs.back();
+        dataSize = run.dataPosition + static_cast<size_t>(run.end - run.start);
+        block.positions[order[k]] = run.dataPosition + static_cast<size_t>(start - run.start);
+    }
+
+    block.valid = false;
+    block.data.resize(dataSize);
+    block.anchor = anchor;
+    block.stride = frameStride;
+    block.count = static_cast<uint32_t>(frames.size());
+
+    bool ok = !frames.empty();
+    for (size_t i = 0; ok && i < runs.size(); ++i) {
+        size_t length = static_cast<size_t>(runs[i].end - runs[i].start);
+        ok = reader.readAt(runs[i].start, block.data.data() + runs[i].dataPosition, length);
+        bytesRead += length;
+        readCalls++;
+    }
+    block.valid = ok;
+}
+
+void ReadAheadWindow::schedulePrefetch(uint32_t frameIndex) {
+    const Block& block = blocks[current];
+    if (!block.valid) return;
+
+    // Continue after the current block, or right after the current frame
+    // if the stride changed while the block was being played
+    int64_t anchor = block.stride == stride
+                   ? block.anchor + static_cast<int64_t>(block.count) * block.stride
+                   : static_cast<int64_t>(frameIndex) + stride;
+    if (anchor < 0 || anchor >= static_cast<int64_t>(stream.getChunkCount())) return;
+
+    // A block along the new stride that holds the anchor anywhere was
+    // scheduled after the last stride change and still serves
+    const Block& other = blocks[1 - current];
+    if (other.stride == stride && find(other, static_cast<uint32_t>(anchor)) >= 0) return;
+
+    prefetchAnchor = static_cast<uint32_t>(anchor);
+    prefetchStride = stride;
+    prefetchPending = true;
+    cv.notify_all();
+}
+
+void ReadAheadWindow::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        cv.wait(lock, [this] { return stopping || prefetchPending; });
+        if (stopping) break;
+
+        prefetchPending = false;
+        prefetchBusy = true;
+        Block& target = blocks[1 - current];
+        uint32_t anchor = prefetchAnchor;
+        int frameStride = prefetchStride;
+
+        lock.unlock();
+        fillBlock(target, anchor, frameStride);
+        lock.lock();
+
+        prefetchBusy = false;
+        cv.notify_all();
+    }
+}
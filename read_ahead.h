@@ -0,0 +1,171 @@
+/**
+ * @file read_ahead.h
+ * @brief Direction- and stride-aware read-ahead window over the frame index
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the ReadAheadWindow class. It reads blocks of the
+ * frames playback will display, coalescing adjacent frames into one large
+ * sequential read, and prefetches the next block on a background thread in
+ * whichever direction and at whichever stride playback is moving. Reverse
+ * playback therefore issues the same large sequential reads as forward
+ * playback, and fast playback reads only the frames it shows.
+ */
+
+#ifndef READ_AHEAD_H
+#define READ_AHEAD_H
+
+#include "avi_reader.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Double-buffered, stride-aware frame prefetcher
+ *
+ * Playback visits frames anchor, anchor + stride, anchor + 2 * stride, ...
+ * where the stride is negative for reverse playback and larger than one for
+ * fast playback. Frames are served from the current block. Whenever a block
+ * becomes current, the block following it along the stride is read in the
+ * background into the second buffer. A block holds as many scheduled frames
+ * as fit in the block budget; frames that lie next to each other in the file
+ * are coalesced into a single positional read, and skipped frames are never
+ * read.
+ *
+ * acquire() must be called from a single thread (the playback loop).
+ */
+class ReadAheadWindow {
+private:
+    /**
+     * @brief Scheduled frames held in memory
+     *
+     * Holds frames anchor + i * stride for i in [0, count).
+     */
+    struct Block {
+        uint32_t anchor;                ///< First frame in playback order
+        int stride;                     ///< Distance between scheduled frames
+        uint32_t count;                 ///< Number of frames in the block
+        std::vector<size_t> positions;  ///< Offset of each frame in data
+        std::vector<uint8_t> data;      ///< Frame payloads, coalesced runs back to back
+        bool valid;                     ///< True if the block holds readable data
+
+        Block() : anchor(0), stride(1), count(0), valid(false) {}
+    };
+
+    const AVIReader& reader;        ///< Source of frame data
+    const AVIStream& stream;        ///< Video stream whose frames are read
+    size_t blockBytes;              ///< Maximum number of bytes read per block
+
+    Block blocks[2];                ///< Current block and prefetch block
+    int current;                    ///< Index of the block frames are served from
+    int stride;                     ///< Frame step of playback (negative = reverse)
+
+    std::thread worker;             ///< Background prefetch thread
+    std::mutex mutex;               ///< Protects the prefetch state below
+    std::condition_variable cv;     ///< Signals prefetch requests and completion
+    bool prefetchPending;           ///< A prefetch was requested but not started
+    bool prefetchBusy;              ///< The worker is filling the prefetch block
+    uint32_t prefetchAnchor;        ///< Frame the requested block starts from
+    int prefetchStride;             ///< Stride of the requested block
+    bool stopping;                  ///< Tells the worker to exit
+
+    uint64_t stalls;                ///< Frames that had to be read synchronously
+    std::atomic<uint64_t> bytesRead;   ///< Total bytes read from the file
+    std::atomic<uint64_t> readCalls;   ///< Total number of positional reads
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * Starts the prefetch thread.
+     *
+     * @param reader Reader to fetch frames from; must outlive the window
+     * @param streamNumber Video stream to read frames of
+     * @param blockBytes Maximum number of bytes read per block (two blocks are kept)
+     */
+    ReadAheadWindow(const AVIReader& reader, int streamNumber, size_t blockBytes);
+
+    /**
+     * @brief Destructor
+     *
+     * Stops and joins the prefetch thread.
+     */
+    ~ReadAheadWindow();
+
+    /**
+     * @brief Set the playback stride
+     *
+     * Subsequent prefetches schedule every |stride|-th frame, moving
+     * backwards when the stride is negative.
+     *
+     * @param frameStride +1 for normal forward playback, -1 for reverse, +/-n to show every n-th frame
+     */
+    void setStride(int frameStride);
+
+    /**
+     * @brief Get the payload of a frame
+     *
+     * Serves the frame from memory when it is in the current or the
+     * prefetched block and otherwise reads a block starting at it
+     * synchronously. In both cases the next block along the stride is then
+     * prefetched.
+     *
+     * @param frameIndex Frame to fetch
+     * @return Pointer to the frame payload, valid until the next call; nullptr on error
+     */
+    const uint8_t* acquire(uint32_t frameIndex);
+
+    /** @brief Number of frames that were not prefetched in time */
+    uint64_t getStallCount() const { return stalls; }
+
+    /** @brief Total number of bytes read from the file */
+    uint64_t getBytesRead() const { return bytesRead.load(); }
+
+    /** @brief Total number of positional reads issued */
+    uint64_t getReadCount() const { return readCalls.load(); }
+
+private:
+    ReadAheadWindow(const ReadAheadWindow&);
+    ReadAheadWindow& operator=(const ReadAheadWindow&);
+
+    /**
+     * @brief Find a frame in a block
+     *
+     * @param block Block to search
+     * @param frameIndex Frame to look for
+     * @return Position of the frame within the block, or -1 if absent
+     */
+    static int64_t find(const Block& block, uint32_t frameIndex);
+
+    /**
+     * @brief Read a block of frames
+     *
+     * Schedules frames anchor, anchor + stride, ... while their payloads fit
+     * the budget, then reads them, merging frames that are adjacent in the
+     * file into a single read.
+     *
+     * @param block Block to fill
+     * @param anchor First frame of the block in playback order
+     * @param frameStride Distance between scheduled frames
+     */
+    void fillBlock(Block& block, uint32_t anchor, int frameStride);
+
+    /**
+     * @brief Request the block following the current one
+     *
+     * Must be called with the mutex held and the worker idle.
+     *
+     * @param frameIndex Frame just acquired from the current block
+     */
+    void schedulePrefetch(uint32_t frameIndex);
+
+    /**
+     * @brief Prefetch thread main loop
+     */
+    void workerLoop();
+};
+
+#endif // READ_AHEAD_H
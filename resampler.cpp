@@ -0,0 +1,230 @@
+/**
+ * @file resampler.cpp
+ * @brief Implementation of the Resampler class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "resampler.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define RESAMPLER_SSE2 1
+#endif
+
+namespace {
+    /**
+     * @brief Weight of a whole source pixel, 14 bits
+     */
+    const int32_t kUnit = 1 << 14;
+
+    /**
+     * @brief Area weights of one axis
+     *
+     * Output pixel i spans source positions [i * source, (i + 1) * source)
+     * and source pixel j spans [j * output, (j + 1) * output), so all
+     * overlaps are exact integers. Rounding is corrected on the largest
+     * weight so that every output pixel sums to kUnit.
+     *
+     * @param source Source pixels
+     * @param output Output pixels, at most source
+     * @param first Receives the first source pixel of every output pixel
+     * @param weights Receives the weights of every output pixel
+     */
+    void computeWeights(uint32_t source, uint32_t output, std::vector<uint32_t>& first,
+                        std::vector<std::vector<int16_t>>& weights) {
+        first.assign(output, 0);
+        weights.assign(output, std::vector<int16_t>());
+        for (uint32_t i = 0; i < output; ++i) {
+            uint64_t begin = static_cast<uint64_t>(i) * source;
+            uint64_t end = begin + source;
+            uint64_t j0 = begin / output;
+            uint64_t j1 = (end + output - 1) / output;
+            first[i] = static_cast<uint32_t>(j0);
+
+            int32_t total = 0;
+            size_t largest = 0;
+            std::vector<int16_t>& w = weights[i];
+            for (uint64_t j = j0; j < j1; ++j) {
+                uint64_t overlap = std::min(end, (j + 1) * output) - std::max(begin, j * output);
+                int32_t weight = static_cast<int32_t>((overlap * kUnit + source / 2) / source);
+                if (!w.empty() && weight > w[largest]) largest = w.size();
+                w.push_back(static_cast<int16_t>(weight));
+                total += weight;
+            }
+            w[largest] = static_cast<int16_t>(w[largest] + kUnit - total);
+        }
+    }
+
+    /**
+     * @brief Add a weighted filtered row to the sums of an output row
+     *
+     * @param sums Sums of the output row, one per channel
+     * @param filtered Horizontally filtered source row
+     * @param count Channels in the row
+     * @param weight Weight of the source row in the output row
+     */
+    void accumulateRow(int32_t* sums, const int16_t* filtered, size_t count, int16_t weight) {
+        size_t i = 0;
+#if defined(RESAMPLER_SSE2)
+        // Samples are zero-extended against zero weights, so each
+        // multiply-add is a plain product
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i w = _mm_set1_epi32(weight);
+        for (; i + 8 <= count; i += 8) {
+            __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(filtered + i));
+            __m128i* low = reinterpret_cast<__m128i*>(sums + i);
+            __m128i* high = reinterpret_cast<__m128i*>(sums + i + 4);
+            _mm_storeu_si128(low, _mm_add_epi32(_mm_loadu_si128(low),
+                                                _mm_madd_epi16(_mm_unpacklo_epi16(samples, zero), w)));
+            _mm_storeu_si128(high, _mm_add_epi32(_mm_loadu_si128(high),
+                                                 _mm_madd_epi16(_mm_unpackhi_epi16(samples, zero), w)));
+        }
+#endif
+        for (; i < count; ++i) {
+            sums[i] += filtered[i] * weight;
+        }
+    }
+
+    /**
+     * @brief Round the sums of a finished output row to bytes and clear them
+     *
+     * @param sums Sums of the output row, 21 fractional bits
+     * @param dst Destination row
+     * @param count Channels in the row
+     */
+    void storeRow(int32_t* sums, uint8_t* dst, size_t count) {
+        size_t i = 0;
+#if defined(RESAMPLER_SSE2)
+        const __m128i half = _mm_set1_epi32(1 << 20);
+        for (; i + 8 <= count; i += 8) {
+            __m128i* low = reinterpret_cast<__m128i*>(sums + i);
+            __m128i* high = reinterpret_cast<__m128i*>(sums + i + 4);
+            __m128i a = _mm_srai_epi32(_mm_add_epi32(_mm_loadu_si128(low), half), 21);
+            __m128i b = _mm_srai_epi32(_mm_add_epi32(_mm_loadu_si128(high), half), 21);
+            __m128i words = _mm_packs_epi32(a, b);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(words, words));
+            _mm_storeu_si128(low, _mm_setzero_si128());
+            _mm_storeu_si128(high, _mm_setzero_si128());
+        }
+#endif
+        for (; i < count; ++i) {
+            dst[i] = static_cast<uint8_t>((sums[i] + (1 << 20)) >> 21);
+            sums[i] = 0;
+        }
+    }
+}
+
+Resampler::Resampler()
+    : sourceWidth(0), sourceHeight(0), outputWidth(0), outputHeight(0) {
+}
+
+void Resampler::configure(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight) {
+    sourceWidth = srcWidth;
+    sourceHeight = srcHeight;
+    outputWidth = std::max(1u, std::min(dstWidth, srcWidth));
+    outputHeight = std::max(1u, std::min(dstHeight, srcHeight));
+
+    // Columns: taps padded to pairs with a zero weight, which may read
+    // the pixel past the end of the row
+    std::vector<uint32_t> first;
+    std::vector<std::vector<int16_t>> weights;
+    computeWeights(sourceWidth, outputWidth, first, weights);
+    columnFirst = first;
+    columnPairs.assign(outputWidth, 0);
+    columnOffset.assign(outputWidth, 0);
+    columnWeights.clear();
+    for (uint32_t x = 0; x < outputWidth; ++x) {
+        if (weights[x].size() & 1) weights[x].push_back(0);
+        columnPairs[x] = static_cast<uint32_t>(weights[x].size() / 2);
+        columnOffset[x] = static_cast<uint32_t>(columnWeights.size());
+        columnWeights.insert(columnWeights.end(), weights[x].begin(), weights[x].end());
+    }
+
+    // Rows: output rows are visited in order, so the first one to claim a
+    // source row is the upper of the two it covers
+    computeWeights(sourceHeight, outputHeight, first, weights);
+    rowTarget.assign(sourceHeight, UINT32_MAX);
+    rowWeights.assign(static_cast<size_t>(sourceHeight) * 2, 0);
+    for (uint32_t y = 0; y < outputHeight; ++y) {
+        for (size_t k = 0; k < weights[y].size(); ++k) {
+            uint32_t row = first[y] + static_cast<uint32_t>(k);
+            if (rowTarget[row] == UINT32_MAX) {
+                rowTarget[row] = y;
+                rowWeights[row * 2] = weights[y][k];
+            } else {
+                rowWeights[row * 2 + 1] = weights[y][k];
+            }
+        }
+    }
+}
+
+void Resampler::resample(const ResamplerRowSource& source, uint8_t* pixels, int pitch) const {
+    size_t count = static_cast<size_t>(outputWidth) * 4;
+    std::vector<uint8_t> row((static_cast<size_t>(sourceWidth) + 1) * 4);
+    std::vector<int16_t> filtered(count);
+    std::vector<int32_t> sums(count * 2);
+
+    // Two output rows are open at a time: the one being finished and the
+    // one the straddling source rows spill into
+    for (uint32_t y = 0; y < sourceHeight; ++y) {
+        uint32_t target = rowTarget[y];
+        source(y, row.data());
+        filterRow(row.data(), filtered.data());
+        accumulateRow(&sums[(target & 1) * count], filtered.data(), count, rowWeights[y * 2]);
+        if (rowWeights[y * 2 + 1] != 0) {
+            accumulateRow(&sums[((target + 1) & 1) * count], filtered.data(), count, rowWeights[y * 2 + 1]);
+        }
+        if (y + 1 == sourceHeight || rowTarget[y + 1] != target) {
+            storeRow(&sums[(target & 1) * count], pixels + static_cast<size_t>(target) * pitch, count);
+        }
+    }
+}
+
+void Resampler::filterRow(const uint8_t* row, int16_t* filtered) const {
+#if defined(RESAMPLER_SSE2)
+    // Two pixels at a time: their channels are interleaved as B0 B1 G0 G1
+    // R0 R1 A0 A1 and multiplied by W0 W1 with one multiply-add
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i half = _mm_set1_epi32(64);
+    for (uint32_t x = 0; x < outputWidth; ++x) {
+        const uint8_t* p = row + static_cast<size_t>(columnFirst[x]) * 4;
+        const int16_t* w = &columnWeights[columnOffset[x]];
+        __m128i sum = _mm_setzero_si128();
+        for (uint32_t k = 0; k < columnPairs[x]; ++k, p += 8, w += 2) {
+            __m128i pair = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), zero);
+            pair = _mm_unpacklo_epi16(pair, _mm_srli_si128(pair, 8));
+            int32_t weights;
+            std::memcpy(&weights, w, sizeof(weights));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(pair, _mm_set1_epi32(weights)));
+        }
+        sum = _mm_srai_epi32(_mm_add_epi32(sum, half), 7);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(filtered + static_cast<size_t>(x) * 4), _mm_packs_epi32(sum, sum));
+    }
+#else
+    for (uint32_t x = 0; x < outputWidth; ++x) {
+        const uint8_t* p = row + static_cast<size_t>(columnFirst[x]) * 4;
+        const int16_t* w = &columnWeights[columnOffset[x]];
+        int32_t sum[4] = { 0, 0, 0, 0 };
+        for (uint32_t k = 0; k < columnPairs[x] * 2; ++k, p += 4) {
+            for (int c = 0; c < 4; ++c) {
+                sum[c] += p[c] * w[k];
+            }
+        }
+        for (int c = 0; c < 4; ++c) {
+            filtered[x * 4 + c] = static_cast<int16_t>((sum[c] + 64) >> 7);
+        }
+    }
+#endif
+}
+
+const char* Resampler::getImplementation() {
+#if defined(RESAMPLER_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,113 @@
+/**
+ * @file resampler.h
+ * @brief Area-averaging downscaler for converted rows
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the Resampler class, which shrinks a frame to an
+ * arbitrary smaller size while it is being converted. Source rows are
+ * requested one at a time in ARGB8888 (B, G, R, A bytes), filtered
+ * horizontally right away and accumulated into the output rows they
+ * cover, so a full-size converted frame never exists in memory. The
+ * filter averages the source pixels under each output pixel, weighted by
+ * the area they cover, which for ratios below two behaves like bilinear
+ * filtering and for larger ratios keeps the image free of aliasing. The
+ * arithmetic is fixed point; the SSE2 and scalar paths produce the same
+ * bytes.
+ */
+
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Supplies one top-down source row in ARGB8888
+ *
+ * Called with the row index and a buffer of the source width in pixels.
+ */
+typedef std::function<void(uint32_t y, uint8_t* row)> ResamplerRowSource;
+
+/**
+ * @brief Downscaler from one frame size to a smaller one
+ *
+ * Weights are computed once by configure(); resample() may then be
+ * called from any thread.
+ *
+ * Horizontally, each output pixel has a run of consecutive source pixels
+ * with 14-bit weights that sum to one, padded to an even count so that
+ * the SSE2 path multiplies two pixels per instruction. Filtered rows keep
+ * 7 fractional bits. Vertically, a source row covers at most two output
+ * rows, so each carries its weight for the first and for the second; the
+ * output row is written once its last source row has been added.
+ */
+class Resampler {
+private:
+    uint32_t sourceWidth;                ///< Pixels per source row
+    uint32_t sourceHeight;               ///< Source rows
+    uint32_t outputWidth;                ///< Pixels per output row
+    uint32_t outputHeight;               ///< Output rows
+    std::vector<uint32_t> columnFirst;   ///< First source pixel of every output pixel
+    std::vector<uint32_t> columnPairs;   ///< Pairs of taps of every output pixel
+    std::vector<uint32_t> columnOffset;  ///< Index of the first weight of every output pixel
+    std::vector<int16_t> columnWeights;  ///< Horizontal weights, 16384 = 1
+    std::vector<uint32_t> rowTarget;     ///< First output row of every source row
+    std::vector<int16_t> rowWeights;     ///< Weights of every source row in its first and second output row
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * Creates an unconfigured resampler.
+     */
+    Resampler();
+
+    /**
+     * @brief Compute the filter weights
+     *
+     * @param srcWidth Pixels per source row
+     * @param srcHeight Source rows
+     * @param dstWidth Pixels per output row, from 1 to srcWidth
+     * @param dstHeight Output rows, from 1 to srcHeight
+     */
+    void configure(uint32_t srcWidth, uint32_t srcHeight, uint32_t dstWidth, uint32_t dstHeight);
+
+    /**
+     * @brief Shrink a frame
+     *
+     * Requests every source row once, top to bottom.
+     *
+     * @param source Converts a source row into the given buffer
+     * @param pixels Destination of the top-down ARGB8888 output
+     * @param pitch Row stride of the destination in bytes
+     */
+    void resample(const ResamplerRowSource& source, uint8_t* pixels, int pitch) const;
+
+    /** @brief Pixels per output row */
+    uint32_t getOutputWidth() const { return outputWidth; }
+
+    /** @brief Output rows */
+    uint32_t getOutputHeight() const { return outputHeight; }
+
+    /**
+     * @brief Name of the filter implementation in use
+     *
+     * @return "SSE2" or "scalar"
+     */
+    static const char* getImplementation();
+
+private:
+    /**
+     * @brief Filter a source row horizontally
+     *
+     * @param row Source row in ARGB8888, with one readable pixel past its end
+     * @param filtered Receives four channels per output pixel, 7 fractional bits
+     */
+    void filterRow(const uint8_t* row, int16_t* filtered) const;
+};
+
+#endif // RESAMPLER_H
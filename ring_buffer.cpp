@@ -0,0 +1,65 @@
+/**
+ * @file ring_buffer.cpp
+ * @brief Implementation of the RingBuffer class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "ring_buffer.h"
+#include <cstring>
+
+RingBuffer::RingBuffer(size_t capacity)
+    : mask(0), writePosition(0), readPosition(0) {
+    size_t size = 1;
+    while (size < capacity) size <<= 1;
+    storage.resize(size);
+    mask = size - 1;
+}
+
+size_t RingBuffer::write(const uint8_t* data, size_t size) {
+    size_t head = writePosition.load(std::memory_order_relaxed);
+    size_t tail = readPosition.load(std::memory_order_acquire);
+    size_t space = capacity() - (head - tail);
+    if (size > space) size = space;
+
+    // Copy in up to two pieces around the wrap point
+    size_t start = head & mask;
+    size_t first = capacity() - start;
+    if (first > size) first = size;
+    std::memcpy(storage.data() + start, data, first);
+    std::memcpy(storage.data(), data + first, size - first);
+
+    writePosition.store(head + size, std::memory_order_release);
+    return size;
+}
+
+size_t RingBuffer::read(uint8_t* data, size_t size) {
+    size_t tail = readPosition.load(std::memory_order_relaxed);
+    size_t head = writePosition.load(std::memory_order_acquire);
+    size_t available = head - tail;
+    if (size > available) size = available;
+
+    size_t start = tail & mask;
+    size_t first = capacity() - start;
+    if (first > size) first = size;
+    std::memcpy(data, storage.data() + start, first);
+    std::memcpy(data + first, storage.data(), size - first);
+
+    readPosition.store(tail + size, std::memory_order_release);
+    return size;
+}
+
+size_t RingBuffer::readable() const {
+    return writePosition.load(std::memory_order_acquire) -
+           readPosition.load(std::memory_order_acquire);
+}
+
+size_t RingBuffer::writable() const {
+    return capacity() - readable();
+}
+
+void RingBuffer::reset() {
+    writePosition.store(0, std::memory_order_relaxed);
+    readPosition.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,78 @@
+/**
+ * @file ring_buffer.h
+ * @brief Lock-free single-producer single-consumer byte ring buffer
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the RingBuffer class used to hand audio samples from
+ * the feeder thread to the SDL audio callback without locks, so that the
+ * real-time callback never waits on another thread.
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Lock-free SPSC byte FIFO
+ *
+ * One thread may call write() while another calls read() concurrently.
+ * The capacity is rounded up to a power of two so positions wrap with a
+ * mask. reset() must only be called while neither side is active.
+ */
+class RingBuffer {
+private:
+    std::vector<uint8_t> storage;       ///< Backing storage
+    size_t mask;                        ///< Capacity minus one
+    std::atomic<size_t> writePosition;  ///< Total bytes written (producer owned)
+    std::atomic<size_t> readPosition;   ///< Total bytes read (consumer owned)
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param capacity Minimum capacity in bytes (rounded up to a power of two)
+     */
+    explicit RingBuffer(size_t capacity);
+
+    /**
+     * @brief Append bytes (producer side)
+     *
+     * @param data Bytes to append
+     * @param size Number of bytes to append
+     * @return Number of bytes actually appended, limited by the free space
+     */
+    size_t write(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Remove bytes (consumer side)
+     *
+     * @param data Destination buffer
+     * @param size Maximum number of bytes to remove
+     * @return Number of bytes actually removed, limited by the fill level
+     */
+    size_t read(uint8_t* data, size_t size);
+
+    /** @brief Bytes available to the consumer */
+    size_t readable() const;
+
+    /** @brief Free space available to the producer */
+    size_t writable() const;
+
+    /** @brief Capacity in bytes */
+    size_t capacity() const { return mask + 1; }
+
+    /**
+     * @brief Discard all buffered bytes
+     *
+     * Not thread-safe: both producer and consumer must be stopped.
+     */
+    void reset();
+};
+
+#endif // RING_BUFFER_H
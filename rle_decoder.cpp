@@ -0,0 +1,55 @@
+/**
+ * @file rle_decoder.cpp
+ * @brief Implementation of the RLEDecoder class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "rle_decoder.h"
+#include <algorithm>
+
+RLEDecoder::RLEDecoder(const AVIReader& reader, int streamNumber, const FrameConverter& converter)
+    : reader(reader), streamNumber(streamNumber), stream(reader.getStream(streamNumber)),
+      converter(converter), image(static_cast<size_t>(converter.getSourceStride()) * converter.getHeight()), imageFrame(-1) {
+}
+
+bool RLEDecoder::apply(uint32_t frameIndex, const uint8_t* frameData) {
+    uint32_t size = stream.chunkSizes[frameIndex];
+    // An empty chunk repeats the previous frame
+    if (size == 0) return true;
+
+    if (!frameData) {
+        if (chunk.size() < size) chunk.resize(size);
+        if (!reader.readChunk(streamNumber, frameIndex, chunk.data(), chunk.size())) return false;
+        frameData = chunk.data();
+    }
+
+    converter.decodeRLE(frameData, size, image.data(), static_cast<int>(converter.getSourceStride()));
+    return true;
+}
+
+const uint8_t* RLEDecoder::decode(uint32_t frameIndex, const uint8_t* frameData) {
+    if (frameIndex >= stream.getChunkCount()) return nullptr;
+    if (imageFrame == frameIndex) return image.data();
+
+    // Continue from the image if no key frame lies between it and the
+    // requested frame, otherwise start over from the key frame
+    uint32_t key = stream.findKeyframe(frameIndex);
+    uint32_t next;
+    if (imageFrame >= key && imageFrame < frameIndex) {
+        next = static_cast<uint32_t>(imageFrame) + 1;
+    } else {
+        std::fill(image.begin(), image.end(), 0);
+        next = key;
+    }
+
+    imageFrame = -1;
+    for (; next < frameIndex; ++next) {
+        if (!apply(next, nullptr)) return nullptr;
+    }
+    if (!apply(frameIndex, frameData)) return nullptr;
+
+    imageFrame = frameIndex;
+    return image.data();
+}
@@ -0,0 +1,76 @@
+/**
+ * @file rle_decoder.h
+ * @brief Decoding of run-length encoded streams into whole frames
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the RLEDecoder class. BI_RLE8 and BI_RLE4 frames
+ * usually describe only the pixels that changed since the previous frame,
+ * so a frame can only be shown once every frame since the last key frame
+ * has been applied. The decoder keeps the last decoded image and applies
+ * the missing frames to it, or starts over from the key frame when the
+ * requested frame lies behind it.
+ */
+
+#ifndef RLE_DECODER_H
+#define RLE_DECODER_H
+
+#include "avi_reader.h"
+#include "frame_converter.h"
+#include <vector>
+
+/**
+ * @brief Persistent image of a run-length encoded stream
+ *
+ * Sequential playback applies one frame per call. Seeking forward applies
+ * the frames in between, unless a key frame lies closer, and seeking
+ * backward (reverse playback included) decodes again from the key frame
+ * before the requested frame. Streams without an index have no key frame
+ * flags and are decoded from their first frame.
+ *
+ * An instance is not thread-safe; concurrent users create one each.
+ */
+class RLEDecoder {
+private:
+    const AVIReader& reader;            ///< Source of frame data
+    int streamNumber;                   ///< Video stream being decoded
+    const AVIStream& stream;            ///< Chunk index and key frames of the stream
+    const FrameConverter& converter;    ///< Palette and geometry of the stream
+
+    std::vector<uint8_t> image;         ///< Decoded RGB24 image, top-down
+    int64_t imageFrame;                 ///< Frame the image shows, -1 if none
+    std::vector<uint8_t> chunk;         ///< Scratch buffer for frames read here
+
+    /**
+     * @brief Apply one frame to the image
+     *
+     * @param frameIndex Frame to apply
+     * @param frameData Its chunk, or nullptr to read it from the file
+     * @return true on success, false if the chunk could not be read
+     */
+    bool apply(uint32_t frameIndex, const uint8_t* frameData);
+
+public:
+    /**
+     * @brief Create a decoder for a run-length encoded stream
+     *
+     * @param reader Open AVI file
+     * @param streamNumber Video stream to decode
+     * @param converter Converter configured for that stream (isRunLength() is true)
+     */
+    RLEDecoder(const AVIReader& reader, int streamNumber, const FrameConverter& converter);
+
+    /**
+     * @brief Decode a frame
+     *
+     * @param frameIndex Frame to decode
+     * @param frameData Chunk of that frame if the caller has it already,
+     *                  nullptr to read it from the file
+     * @return Decoded top-down RGB24 image, valid until
+     *         the next call, or nullptr if a chunk could not be read
+     */
+    const uint8_t* decode(uint32_t frameIndex, const uint8_t* frameData);
+};
+
+#endif // RLE_DECODER_H
@@ -0,0 +1,126 @@
+/**
+ * @file thread_pool.cpp
+ * @brief Implementation of the ThreadPool class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "thread_pool.h"
+
+namespace {
+    /**
+     * @brief Pool and queue index of the calling worker thread
+     *
+     * Lets submit() called from inside a task push to the worker's own
+     * queue instead of a random one.
+     */
+    thread_local const ThreadPool* currentPool = nullptr;
+    thread_local size_t currentWorker = 0;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : queued(0), stopping(false), pending(0), nextQueue(0), steals(0) {
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    if (threadCount == 0) threadCount = 4;
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.push_back(std::thread(&ThreadPool::workerLoop, this, static_cast<size_t>(i)));
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    waitIdle();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    pending++;
+
+    // Count the task before it becomes visible, so a worker that takes it
+    // right away never decrements below zero
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued++;
+    }
+
+    size_t target = currentPool == this ? currentWorker : nextQueue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return pending.load() == 0; });
+}
+
+bool ThreadPool::takeTask(size_t self, std::function<void()>& task) {
+    // Own queue first, newest task (its data is most likely still in cache)
+    {
+        Queue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Steal the oldest task of another worker
+    for (size_t i = 1; i < queues.size(); ++i) {
+        Queue& victim = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            steals++;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t self) {
+    currentPool = this;
+    currentWorker = self;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || queued > 0; });
+            if (queued == 0) return; // Stopping with nothing left to run
+        }
+
+        std::function<void()> task;
+        if (!takeTask(self, task)) {
+            // Counted but not pushed yet, or another worker got there first
+            std::this_thread::yield();
+            continue;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queued--;
+        }
+        task();
+
+        if (--pending == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            idle.notify_all();
+        }
+    }
+}
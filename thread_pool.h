@@ -0,0 +1,122 @@
+/**
+ * @file thread_pool.h
+ * @brief Work-stealing thread pool
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the ThreadPool class, a fixed set of worker threads
+ * that share frame reads and conversions of many streams. Each worker owns
+ * a task queue; idle workers steal from the others so that one slow stream
+ * does not leave cores unused.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size pool of workers with per-worker queues and stealing
+ *
+ * Tasks submitted from outside the pool are spread round-robin over the
+ * worker queues; tasks submitted by a worker go to its own queue. A worker
+ * takes its newest task first (good cache locality) and, when its queue is
+ * empty, steals the oldest task of another worker.
+ *
+ * Usage example:
+ * @code
+ * ThreadPool pool;
+ * for (int i = 0; i < 16; ++i) {
+ *     pool.submit([i] { decodeTile(i); });
+ * }
+ * pool.waitIdle();
+ * @endcode
+ */
+class ThreadPool {
+private:
+    /**
+     * @brief Task queue owned by one worker
+     */
+    struct Queue {
+        std::mutex mutex;                          ///< Guards tasks
+        std::deque<std::function<void()>> tasks;   ///< Queued tasks, newest at the back
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;    ///< One queue per worker
+    std::vector<std::thread> workers;              ///< Worker threads
+
+    std::mutex mutex;                  ///< Guards the sleep/wake state below
+    std::condition_variable wake;      ///< Signals queued work or shutdown
+    std::condition_variable idle;      ///< Signals that all tasks have finished
+    size_t queued;                     ///< Tasks in any queue, not yet started
+    bool stopping;                     ///< Tells the workers to exit
+
+    std::atomic<size_t> pending;       ///< Tasks submitted but not finished
+    std::atomic<size_t> nextQueue;     ///< Round-robin target for outside submissions
+    std::atomic<uint64_t> steals;      ///< Tasks taken from another worker's queue
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * Starts the worker threads.
+     *
+     * @param threadCount Number of workers; 0 uses one per hardware thread
+     */
+    explicit ThreadPool(unsigned threadCount = 0);
+
+    /**
+     * @brief Destructor
+     *
+     * Waits for all submitted tasks, then stops and joins the workers.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Queue a task for execution on a worker
+     *
+     * @param task Function to run
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Block until every submitted task has finished
+     */
+    void waitIdle();
+
+    /** @brief Number of worker threads */
+    unsigned getThreadCount() const { return static_cast<unsigned>(workers.size()); }
+
+    /** @brief Number of tasks that were stolen from another worker */
+    uint64_t getStealCount() const { return steals.load(); }
+
+private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    /**
+     * @brief Take a task, preferring the worker's own queue
+     *
+     * @param self Index of the calling worker
+     * @param task Receives the task
+     * @return true if a task was taken
+     */
+    bool takeTask(size_t self, std::function<void()>& task);
+
+    /**
+     * @brief Worker thread main loop
+     *
+     * @param self Index of the worker
+     */
+    void workerLoop(size_t self);
+};
+
+#endif // THREAD_POOL_H
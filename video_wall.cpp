@@ -0,0 +1,242 @@
+/**
+ * @file video_wall.cpp
+ * @brief Implementation of the VideoWall class
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "video_wall.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+VideoWall::VideoWall(uint32_t width, uint32_t height, unsigned threads)
+    : window(nullptr), renderer(nullptr), texture(nullptr),
+      wallWidth(width), wallHeight(height), pool(threads), framesDecoded(0) {
+}
+
+VideoWall::~VideoWall() {
+    cleanup();
+}
+
+bool VideoWall::addFile(const std::string& filepath) {
+    std::unique_ptr<Feed> feed(new Feed());
+    feed->path = filepath;
+
+    std::cout << "Loading AVI file: " << filepath << std::endl;
+    if (!feed->reader.open(filepath)) {
+        return false;
+    }
+    if (!feed->converter.configure(feed->reader.getBitmapHeader(), feed->reader.getPalette(),
+                                   feed->reader.getColorMasks())) {
+        std::cerr << "Error: Unsupported pixel format in " << filepath << std::endl;
+        return false;
+    }
+    if (feed->converter.isRunLength()) {
+        feed->decoder.reset(new RLEDecoder(feed->reader, feed->reader.getVideoStream(), feed->converter));
+    }
+    if (feed->converter.isMotionJPEG()) {
+        feed->jpegDecoder.reset(new MJPEGDecoder(feed->reader, feed->reader.getVideoStream(), feed->converter));
+    }
+
+    // Exact stream rate when present, otherwise the avih frame duration
+    const AVIStreamHeader& streamHeader = feed->reader.getStreamHeader();
+    const AVIMainHeader& mainHeader = feed->reader.getMainHeader();
+    if (streamHeader.rate > 0 && streamHeader.scale > 0) {
+        feed->frameSeconds = static_cast<double>(streamHeader.scale) / streamHeader.rate;
+    } else if (mainHeader.microSecPerFrame > 0) {
+        feed->frameSeconds = mainHeader.microSecPerFrame / 1e6;
+    } else {
+        feed->frameSeconds = 1.0 / 30; // Default fallback
+    }
+
+    feed->frame.reserve(feed->reader.getMaxFrameSize());
+    feeds.push_back(std::move(feed));
+    return true;
+}
+
+void VideoWall::layoutTiles() {
+    // Near-square grid, filled row by row
+    uint32_t count = static_cast<uint32_t>(feeds.size());
+    uint32_t columns = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    uint32_t rows = (count + columns - 1) / columns;
+    uint32_t tileWidth = wallWidth / columns;
+    uint32_t tileHeight = wallHeight / rows;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        Feed& feed = *feeds[i];
+        uint32_t width = feed.converter.getWidth();
+        uint32_t height = feed.converter.getHeight();
+
+        // Smallest integer decimation that fits the tile
+        feed.step = std::max(1u, std::max((width + tileWidth - 1) / tileWidth,
+                                          (height + tileHeight - 1) / tileHeight));
+
+        // Center the decimated image in its tile
+        int outWidth = static_cast<int>(width / feed.step);
+        int outHeight = static_cast<int>(height / feed.step);
+        feed.area.x = static_cast<int>((i % columns) * tileWidth) + (static_cast<int>(tileWidth) - outWidth) / 2;
+        feed.area.y = static_cast<int>((i / columns) * tileHeight) + (static_cast<int>(tileHeight) - outHeight) / 2;
+        feed.area.w = outWidth;
+        feed.area.h = outHeight;
+    }
+
+    std::cout << "Video wall: " << count << " feeds on a " << columns << "x" << rows
+              << " grid of " << tileWidth << "x" << tileHeight << " tiles, "
+              << pool.getThreadCount() << " worker threads" << std::endl;
+}
+
+bool VideoWall::initSDL() {
+    if (feeds.empty()) {
+        std::cerr << "Error: No playable files for the video wall" << std::endl;
+        return false;
+    }
+
+    layoutTiles();
+    mosaic.assign(static_cast<size_t>(wallWidth) * wallHeight * 3, 0);
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        std::cerr << "SDL Init Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    window = SDL_CreateWindow("AVI Player - Video Wall",
+                              SDL_WINDOWPOS_CENTERED,
+                              SDL_WINDOWPOS_CENTERED,
+                              wallWidth, wallHeight,
+                              SDL_WINDOW_SHOWN);
+    if (!window) {
+        std::cerr << "Window Creation Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    if (!renderer) {
+        std::cerr << "Renderer Creation Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+
+    // One texture for all tiles: one upload target and one copy per present
+    texture = SDL_CreateTexture(renderer,
+                                SDL_PIXELFORMAT_RGB24,
+                                SDL_TEXTUREACCESS_STREAMING,
+                                wallWidth, wallHeight);
+    if (!texture) {
+        std::cerr << "Texture Creation Error: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    SDL_UpdateTexture(texture, nullptr, mosaic.data(), wallWidth * 3);
+
+    return true;
+}
+
+void VideoWall::play() {
+    bool quit = false;
+    bool paused = false;
+    SDL_Event e;
+    int pitch = static_cast<int>(wallWidth * 3);
+
+    auto start = std::chrono::steady_clock::now();
+    auto pauseStart = start;
+
+    std::cout << "Playing video wall... Press ESC or close window to exit." << std::endl;
+
+    while (!quit) {
+        while (SDL_PollEvent(&e)) {
+            if (e.type == SDL_QUIT ||
+                (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE)) {
+                quit = true;
+            } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_SPACE) {
+                // Resume where playback stopped rather than catching up
+                paused = !paused;
+                if (paused) {
+                    pauseStart = std::chrono::steady_clock::now();
+                } else {
+                    start += std::chrono::steady_clock::now() - pauseStart;
+                }
+            }
+        }
+
+        // Each feed has at most one frame in flight. Finished tiles are
+        // uploaded as they come in, so a slow feed only holds up its own
+        // tile; it skips to the frame due when it is ready again
+        double elapsed = std::chrono::duration<double>(
+            (paused ? pauseStart : std::chrono::steady_clock::now()) - start).count();
+        bool uploaded = false;
+        for (size_t i = 0; i < feeds.size(); ++i) {
+            Feed* feed = feeds[i].get();
+            if (feed->busy.load(std::memory_order_acquire)) continue;
+
+            if (feed->dirty) {
+                const uint8_t* tile = mosaic.data() + feed->area.y * pitch + feed->area.x * 3;
+                SDL_UpdateTexture(texture, &feed->area, tile, pitch);
+                feed->dirty = false;
+                uploaded = true;
+            }
+
+            int64_t frameIndex = static_cast<int64_t>(elapsed / feed->frameSeconds) %
+                                 feed->reader.getFrameCount();
+            if (!paused && frameIndex != feed->shownFrame) {
+                feed->shownFrame = frameIndex;
+                feed->busy.store(true, std::memory_order_relaxed);
+                pool.submit([this, feed, frameIndex] {
+                    decodeFeed(*feed, static_cast<uint32_t>(frameIndex));
+                    feed->busy.store(false, std::memory_order_release);
+                });
+            }
+        }
+
+        if (uploaded) {
+            SDL_RenderClear(renderer);
+            SDL_RenderCopy(renderer, texture, nullptr, nullptr);
+            SDL_RenderPresent(renderer);
+        }
+
+        // Small delay to prevent excessive CPU usage
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::cout << "Decoded " << framesDecoded.load() << " frames of " << feeds.size()
+              << " feeds on " << pool.getThreadCount() << " threads ("
+              << pool.getStealCount() << " stolen)" << std::endl;
+}
+
+void VideoWall::decodeFeed(Feed& feed, uint32_t frameIndex) {
+    // Short or empty chunks (dropped frames) keep the previous image
+    if (feed.reader.getFrameSize(frameIndex) < feed.converter.getSourceFrameSize()) return;
+    const uint8_t* frameData;
+    if (feed.decoder || feed.jpegDecoder) {
+        frameData = feed.decoder ? feed.decoder->decode(frameIndex, nullptr)
+                                 : feed.jpegDecoder->decode(frameIndex, nullptr);
+        if (!frameData) return;
+    } else {
+        if (!feed.reader.readFrame(frameIndex, feed.frame)) return;
+        frameData = feed.frame.data();
+    }
+
+    uint8_t* tile = mosaic.data() + (static_cast<size_t>(feed.area.y) * wallWidth + feed.area.x) * 3;
+    feed.converter.convertToRGB24(frameData, tile, static_cast<int>(wallWidth * 3), feed.step);
+    feed.dirty = true;
+    framesDecoded++;
+}
+
+void VideoWall::cleanup() {
+    pool.waitIdle();
+    if (texture) {
+        SDL_DestroyTexture(texture);
+        texture = nullptr;
+    }
+    if (renderer) {
+        SDL_DestroyRenderer(renderer);
+        renderer = nullptr;
+    }
+    if (window) {
+        SDL_DestroyWindow(window);
+        window = nullptr;
+    }
+    feeds.clear();
+    SDL_Quit();
+}
@@ -0,0 +1,154 @@
+/**
+ * @file video_wall.h
+ * @brief Mosaic playback of many AVI files in one window
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header defines the VideoWall class, which plays any number of AVI
+ * files as tiles of one streaming texture. All feeds share one SDL context,
+ * one event loop and one work-stealing pool for reads and conversions.
+ */
+
+#ifndef VIDEO_WALL_H
+#define VIDEO_WALL_H
+
+#include "avi_reader.h"
+#include "frame_converter.h"
+#include "mjpeg_decoder.h"
+#include "rle_decoder.h"
+#include "thread_pool.h"
+#include <SDL2/SDL.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Video wall player
+ *
+ * Feeds are laid out on a near-square grid. Each feed is decimated by an
+ * integer factor to fit its tile and converted straight into an RGB24
+ * mosaic, from which only the tiles that changed are uploaded. Every feed
+ * follows its own frame rate and loops forever. Per feed, the wall keeps
+ * one raw frame buffer and its tile of the mosaic, instead of a whole
+ * player with its own window, renderer and read-ahead blocks.
+ *
+ * Usage example:
+ * @code
+ * VideoWall wall(1920, 1080, 0);
+ * wall.addFile("cam1.avi");
+ * wall.addFile("cam2.avi");
+ * if (wall.initSDL()) {
+ *     wall.play();
+ * }
+ * @endcode
+ */
+class VideoWall {
+private:
+    /**
+     * @brief One file shown on the wall
+     */
+    struct Feed {
+        std::string path;                ///< File the feed plays
+        AVIReader reader;                ///< Frame reader and index
+        FrameConverter converter;        ///< Conversion to the RGB24 mosaic
+        std::vector<uint8_t> frame;      ///< Raw frame buffer
+        std::unique_ptr<RLEDecoder> decoder; ///< Decoded image of RLE feeds, null otherwise
+        std::unique_ptr<MJPEGDecoder> jpegDecoder; ///< Decoded image of MJPG feeds, null otherwise
+        double frameSeconds;             ///< Frame duration
+        uint32_t step;                   ///< Decimation factor to fit the tile
+        SDL_Rect area;                   ///< Position of the image in the mosaic
+        int64_t shownFrame;              ///< Frame last queued for the mosaic, -1 if none
+        bool dirty;                      ///< True if the tile must be uploaded
+        std::atomic<bool> busy;          ///< True while a worker updates the tile
+
+        Feed() : frameSeconds(0), step(1), shownFrame(-1), dirty(false), busy(false) {}
+    };
+
+    SDL_Window* window;              ///< SDL window handle
+    SDL_Renderer* renderer;          ///< SDL renderer handle
+    SDL_Texture* texture;            ///< Streaming texture holding all tiles
+
+    uint32_t wallWidth;              ///< Window and mosaic width
+    uint32_t wallHeight;             ///< Window and mosaic height
+    std::vector<uint8_t> mosaic;     ///< RGB24 image of the whole wall
+    std::vector<std::unique_ptr<Feed>> feeds; ///< Files on the wall
+    ThreadPool pool;                 ///< Shared workers for reads and conversions
+    std::atomic<uint64_t> framesDecoded; ///< Frames read and converted
+
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param width Width of the wall in pixels
+     * @param height Height of the wall in pixels
+     * @param threads Worker threads; 0 uses one per hardware thread
+     */
+    VideoWall(uint32_t width, uint32_t height, unsigned threads);
+
+    /**
+     * @brief Destructor
+     *
+     * Cleans up SDL resources and closes files.
+     */
+    ~VideoWall();
+
+    /**
+     * @brief Add a file to the wall
+     *
+     * Opens and indexes the file. Files that cannot be played are reported
+     * and left out.
+     *
+     * @param filepath Path to the AVI file
+     * @return true if the file was added, false otherwise
+     */
+    bool addFile(const std::string& filepath);
+
+    /** @brief Number of files on the wall */
+    size_t getFeedCount() const { return feeds.size(); }
+
+    /**
+     * @brief Lay out the tiles and create the window
+     *
+     * Must be called after all files have been added.
+     *
+     * @return true if SDL initialized successfully, false otherwise
+     */
+    bool initSDL();
+
+    /**
+     * @brief Play all feeds until the user quits
+     *
+     * ESC or closing the window exits, SPACE pauses.
+     */
+    void play();
+
+private:
+    VideoWall(const VideoWall&);
+    VideoWall& operator=(const VideoWall&);
+
+    /**
+     * @brief Compute the grid and the tile of every feed
+     */
+    void layoutTiles();
+
+    /**
+     * @brief Read a frame of a feed and convert it into its tile
+     *
+     * Runs on a pool worker. Feeds write disjoint parts of the mosaic, so
+     * no locking is needed. Clearing the feed's busy flag hands the tile
+     * and its dirty flag back to the main thread.
+     *
+     * @param feed Feed to update
+     * @param frameIndex Frame to show
+     */
+    void decodeFeed(Feed& feed, uint32_t frameIndex);
+
+    /**
+     * @brief Clean up resources
+     */
+    void cleanup();
+};
+
+#endif // VIDEO_WALL_H
@@ -0,0 +1,401 @@
+/**
+ * @file yuv_convert.cpp
+ * @brief Implementation of the YUV to RGB row kernels
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "yuv_convert.h"
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define YUV_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    inline uint8_t clampByte(int value) {
+        return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+    }
+
+    inline int16_t toFixed(double gain) {
+        return static_cast<int16_t>(std::floor(gain * 16384.0 + 0.5));
+    }
+
+    /**
+     * @brief Convert one pixel
+     *
+     * The arithmetic of the SIMD kernels, step by step: every product is
+     * truncated to 6 fractional bits as a 16-bit high multiply does, and
+     * the sum is rounded once.
+     */
+    inline void convertPixel(int y, int u, int v, uint8_t& red, uint8_t& green, uint8_t& blue,
+                             const YUVCoefficients& c) {
+        int luma = y - c.yOffset;
+        luma = luma * 64 + (luma * 128 * c.yScale >> 16) + 32;
+        int cb = (u - 128) * 256;
+        int cr = (v - 128) * 256;
+        red = clampByte((luma + (cr * c.redV >> 16)) >> 6);
+        green = clampByte((luma - ((cb * c.greenU >> 16) + (cr * c.greenV >> 16))) >> 6);
+        blue = clampByte((luma + (cb >> 1) + (cb * c.blueU >> 16)) >> 6);
+    }
+
+    /**
+     * @brief Portable row conversion, also used for the tails of the SIMD rows
+     *
+     * @param x First pixel to convert; even
+     */
+    template <YUVSource source, RGBLayout layout>
+    void convertRowSoftware(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                            uint32_t x, uint32_t width, const YUVCoefficients& c) {
+        for (; x < width; ++x) {
+            int luma, cb, cr;
+            if (source == YUV_SOURCE_PLANAR) {
+                luma = y[x];
+                cb = u[x / 2];
+                cr = v[x / 2];
+            } else if (source == YUV_SOURCE_NV12) {
+                luma = y[x];
+                cb = u[x & ~1u];
+                cr = u[x | 1u];
+            } else {
+                const uint8_t* pair = y + (x / 2) * 4;
+                bool yuy2 = source == YUV_SOURCE_YUY2;
+                luma = pair[(yuy2 ? 0 : 1) + (x & 1) * 2];
+                cb = pair[yuy2 ? 1 : 0];
+                cr = pair[yuy2 ? 3 : 2];
+            }
+
+            uint8_t red, green, blue;
+            convertPixel(luma, cb, cr, red, green, blue, c);
+            if (layout == RGB_LAYOUT_RGB24) {
+                uint8_t* out = dst + x * 3;
+                out[0] = red;
+                out[1] = green;
+                out[2] = blue;
+            } else {
+                uint8_t* out = dst + x * 4;
+                out[0] = blue;
+                out[1] = green;
+                out[2] = red;
+                out[3] = 255;
+            }
+        }
+    }
+
+#if defined(YUV_X86)
+    /**
+     * @brief Row conversion with SSE4.1, 16 pixels per step
+     *
+     * Chroma is widened to 16 bits, its terms are computed once per pair
+     * of pixels and then duplicated. RGB24 is stored as four overlapping
+     * 16-byte writes, so a step must leave two pixels behind it.
+     *
+     * Compiled for SSE4.1 regardless of the build flags and only called
+     * after the CPU has been checked.
+     */
+    template <YUVSource source, RGBLayout layout>
+    __attribute__((target("sse4.1")))
+    void convertRowSSE41(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                         uint32_t width, const YUVCoefficients& c) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lowBytes = _mm_set1_epi16(0x00FF);
+        const __m128i alpha = _mm_set1_epi8(-1);
+        const __m128i bias = _mm_set1_epi16(128);
+        const __m128i rounding = _mm_set1_epi16(32);
+        const __m128i yOffset = _mm_set1_epi16(c.yOffset);
+        const __m128i yScale = _mm_set1_epi16(c.yScale);
+        const __m128i redV = _mm_set1_epi16(c.redV);
+        const __m128i greenU = _mm_set1_epi16(c.greenU);
+        const __m128i greenV = _mm_set1_epi16(c.greenV);
+        const __m128i blueU = _mm_set1_epi16(c.blueU);
+        const __m128i dropAlpha = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+        uint32_t end = layout == RGB_LAYOUT_RGB24 ? (width > 2 ? width - 2 : 0) : width;
+        uint32_t x = 0;
+        for (; x + 16 <= end; x += 16) {
+            __m128i y0, y1, cb, cr;
+            if (source == YUV_SOURCE_PLANAR || source == YUV_SOURCE_NV12) {
+                __m128i luma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x));
+                y0 = _mm_cvtepu8_epi16(luma);
+                y1 = _mm_unpackhi_epi8(luma, zero);
+                if (source == YUV_SOURCE_PLANAR) {
+                    cb = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(u + x / 2)));
+                    cr = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(v + x / 2)));
+                } else {
+                    __m128i chroma = _mm_loadu_si128(reinterpret_cast<const __m128i*>(u + x));
+                    cb = _mm_and_si128(chroma, lowBytes);
+                    cr = _mm_srli_epi16(chroma, 8);
+                }
+            } else {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x * 2));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + x * 2 + 16));
+                __m128i chroma;
+                if (source == YUV_SOURCE_YUY2) {
+                    y0 = _mm_and_si128(a, lowBytes);
+                    y1 = _mm_and_si128(b, lowBytes);
+                    chroma = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+                } else {
+                    y0 = _mm_srli_epi16(a, 8);
+                    y1 = _mm_srli_epi16(b, 8);
+                    chroma = _mm_packus_epi16(_mm_and_si128(a, lowBytes), _mm_and_si128(b, lowBytes));
+                }
+                cb = _mm_and_si128(chroma, lowBytes);
+                cr = _mm_srli_epi16(chroma, 8);
+            }
+
+            // Luma and chroma terms with 6 fractional bits
+            y0 = _mm_sub_epi16(y0, yOffset);
+            y0 = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(y0, 6), _mm_mulhi_epi16(_mm_slli_epi16(y0, 7), yScale)), rounding);
+            y1 = _mm_sub_epi16(y1, yOffset);
+            y1 = _mm_add_epi16(_mm_add_epi16(_mm_slli_epi16(y1, 6), _mm_mulhi_epi16(_mm_slli_epi16(y1, 7), yScale)), rounding);
+            cb = _mm_slli_epi16(_mm_sub_epi16(cb, bias), 8);
+            cr = _mm_slli_epi16(_mm_sub_epi16(cr, bias), 8);
+            __m128i redTerm = _mm_mulhi_epi16(cr, redV);
+            __m128i greenTerm = _mm_add_epi16(_mm_mulhi_epi16(cb, greenU), _mm_mulhi_epi16(cr, greenV));
+            __m128i blueTerm = _mm_add_epi16(_mm_srai_epi16(cb, 1), _mm_mulhi_epi16(cb, blueU));
+
+            __m128i red = _mm_packus_epi16(
+                _mm_srai_epi16(_mm_adds_epi16(y0, _mm_unpacklo_epi16(redTerm, redTerm)), 6),
+                _mm_srai_epi16(_mm_adds_epi16(y1, _mm_unpackhi_epi16(redTerm, redTerm)), 6));
+            __m128i green = _mm_packus_epi16(
+                _mm_srai_epi16(_mm_subs_epi16(y0, _mm_unpacklo_epi16(greenTerm, greenTerm)), 6),
+                _mm_srai_epi16(_mm_subs_epi16(y1, _mm_unpackhi_epi16(greenTerm, greenTerm)), 6));
+            __m128i blue = _mm_packus_epi16(
+                _mm_srai_epi16(_mm_adds_epi16(y0, _mm_unpacklo_epi16(blueTerm, blueTerm)), 6),
+                _mm_srai_epi16(_mm_adds_epi16(y1, _mm_unpackhi_epi16(blueTerm, blueTerm)), 6));
+
+            __m128i blueGreen0 = _mm_unpacklo_epi8(blue, green);
+            __m128i blueGreen1 = _mm_unpackhi_epi8(blue, green);
+            __m128i redAlpha0 = _mm_unpacklo_epi8(red, alpha);
+            __m128i redAlpha1 = _mm_unpackhi_epi8(red, alpha);
+            __m128i pixels[4] = {
+                _mm_unpacklo_epi16(blueGreen0, redAlpha0),
+                _mm_unpackhi_epi16(blueGreen0, redAlpha0),
+                _mm_unpacklo_epi16(blueGreen1, redAlpha1),
+                _mm_unpackhi_epi16(blueGreen1, redAlpha1)
+            };
+            if (layout == RGB_LAYOUT_BGRA32) {
+                __m128i* out = reinterpret_cast<__m128i*>(dst + x * 4);
+                for (int i = 0; i < 4; ++i) _mm_storeu_si128(out + i, pixels[i]);
+            } else {
+                uint8_t* out = dst + x * 3;
+                for (int i = 0; i < 4; ++i) {
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 12), _mm_shuffle_epi8(pixels[i], dropAlpha));
+                }
+            }
+        }
+        convertRowSoftware<source, layout>(y, u, v, dst, x, width, c);
+    }
+
+    /**
+     * @brief Row conversion with AVX2, 32 pixels per step
+     *
+     * The SSE4.1 algorithm on both 128-bit lanes. Loads are arranged so
+     * that the lane-wise unpacks and packs keep the pixels in order, and
+     * the BGRA lanes are swapped back into place before storing.
+     *
+     * Compiled for AVX2 regardless of the build flags and only called
+     * after the CPU has been checked.
+     */
+    template <YUVSource source, RGBLayout layout>
+    __attribute__((target("avx2")))
+    void convertRowAVX2(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                        uint32_t width, const YUVCoefficients& c) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i lowBytes = _mm256_set1_epi16(0x00FF);
+        const __m256i alpha = _mm256_set1_epi8(-1);
+        const __m256i bias = _mm256_set1_epi16(128);
+        const __m256i rounding = _mm256_set1_epi16(32);
+        const __m256i yOffset = _mm256_set1_epi16(c.yOffset);
+        const __m256i yScale = _mm256_set1_epi16(c.yScale);
+        const __m256i redV = _mm256_set1_epi16(c.redV);
+        const __m256i greenU = _mm256_set1_epi16(c.greenU);
+        const __m256i greenV = _mm256_set1_epi16(c.greenV);
+        const __m256i blueU = _mm256_set1_epi16(c.blueU);
+        const __m256i dropAlpha = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,
+                                                   2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+
+        uint32_t end = layout == RGB_LAYOUT_RGB24 ? (width > 2 ? width - 2 : 0) : width;
+        uint32_t x = 0;
+        for (; x + 32 <= end; x += 32) {
+            // y0 holds pixels 0-7 and 16-23, y1 pixels 8-15 and 24-31,
+            // chroma pairs 0-7 and 8-15
+            __m256i y0, y1, cb, cr;
+            if (source == YUV_SOURCE_PLANAR || source == YUV_SOURCE_NV12) {
+                __m256i luma = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + x));
+                y0 = _mm256_unpacklo_epi8(luma, zero);
+                y1 = _mm256_unpackhi_epi8(luma, zero);
+                if (source == YUV_SOURCE_PLANAR) {
+                    cb = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(u + x / 2)));
+                    cr = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + x / 2)));
+                } else {
+                    __m256i chroma = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(u + x));
+                    cb = _mm256_and_si256(chroma, lowBytes);
+                    cr = _mm256_srli_epi16(chroma, 8);
+                }
+            } else {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + x * 2));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + x * 2 + 32));
+                __m256i lumaA, lumaB, chroma;
+                if (source == YUV_SOURCE_YUY2) {
+                    lumaA = _mm256_and_si256(a, lowBytes);
+                    lumaB = _mm256_and_si256(b, lowBytes);
+                    chroma = _mm256_packus_epi16(_mm256_srli_epi16(a, 8), _mm256_srli_epi16(b, 8));
+                } else {
+                    lumaA = _mm256_srli_epi16(a, 8);
+                    lumaB = _mm256_srli_epi16(b, 8);
+                    chroma = _mm256_packus_epi16(_mm256_and_si256(a, lowBytes), _mm256_and_si256(b, lowBytes));
+                }
+                y0 = _mm256_permute2x128_si256(lumaA, lumaB, 0x20);
+                y1 = _mm256_permute2x128_si256(lumaA, lumaB, 0x31);
+                chroma = _mm256_permute4x64_epi64(chroma, 0xD8);
+                cb = _mm256_and_si256(chroma, lowBytes);
+                cr = _mm256_srli_epi16(chroma, 8);
+            }
+
+            y0 = _mm256_sub_epi16(y0, yOffset);
+            y0 = _mm256_add_epi16(_mm256_add_epi16(_mm256_slli_epi16(y0, 6), _mm256_mulhi_epi16(_mm256_slli_epi16(y0, 7), yScale)), rounding);
+            y1 = _mm256_sub_epi16(y1, yOffset);
+            y1 = _mm256_add_epi16(_mm256_add_epi16(_mm256_slli_epi16(y1, 6), _mm256_mulhi_epi16(_mm256_slli_epi16(y1, 7), yScale)), rounding);
+            cb = _mm256_slli_epi16(_mm256_sub_epi16(cb, bias), 8);
+            cr = _mm256_slli_epi16(_mm256_sub_epi16(cr, bias), 8);
+            __m256i redTerm = _mm256_mulhi_epi16(cr, redV);
+            __m256i greenTerm = _mm256_add_epi16(_mm256_mulhi_epi16(cb, greenU), _mm256_mulhi_epi16(cr, greenV));
+            __m256i blueTerm = _mm256_add_epi16(_mm256_srai_epi16(cb, 1), _mm256_mulhi_epi16(cb, blueU));
+
+            __m256i red = _mm256_packus_epi16(
+                _mm256_srai_epi16(_mm256_adds_epi16(y0, _mm256_unpacklo_epi16(redTerm, redTerm)), 6),
+                _mm256_srai_epi16(_mm256_adds_epi16(y1, _mm256_unpackhi_epi16(redTerm, redTerm)), 6));
+            __m256i green = _mm256_packus_epi16(
+                _mm256_srai_epi16(_mm256_subs_epi16(y0, _mm256_unpacklo_epi16(greenTerm, greenTerm)), 6),
+                _mm256_srai_epi16(_mm256_subs_epi16(y1, _mm256_unpackhi_epi16(greenTerm, greenTerm)), 6));
+            __m256i blue = _mm256_packus_epi16(
+                _mm256_srai_epi16(_mm256_adds_epi16(y0, _mm256_unpacklo_epi16(blueTerm, blueTerm)), 6),
+                _mm256_srai_epi16(_mm256_adds_epi16(y1, _mm256_unpackhi_epi16(blueTerm, blueTerm)), 6));
+
+            __m256i blueGreen0 = _mm256_unpacklo_epi8(blue, green);
+            __m256i blueGreen1 = _mm256_unpackhi_epi8(blue, green);
+            __m256i redAlpha0 = _mm256_unpacklo_epi8(red, alpha);
+            __m256i redAlpha1 = _mm256_unpackhi_epi8(red, alpha);
+            __m256i p0 = _mm256_unpacklo_epi16(blueGreen0, redAlpha0);     // 0-3, 16-19
+            __m256i p1 = _mm256_unpackhi_epi16(blueGreen0, redAlpha0);     // 4-7, 20-23
+            __m256i p2 = _mm256_unpacklo_epi16(blueGreen1, redAlpha1);     // 8-11, 24-27
+            __m256i p3 = _mm256_unpackhi_epi16(blueGreen1, redAlpha1);     // 12-15, 28-31
+            __m256i pixels[4] = {
+                _mm256_permute2x128_si256(p0, p1, 0x20),
+                _mm256_permute2x128_si256(p2, p3, 0x20),
+                _mm256_permute2x128_si256(p0, p1, 0x31),
+                _mm256_permute2x128_si256(p2, p3, 0x31)
+            };
+            if (layout == RGB_LAYOUT_BGRA32) {
+                __m256i* out = reinterpret_cast<__m256i*>(dst + x * 4);
+                for (int i = 0; i < 4; ++i) _mm256_storeu_si256(out + i, pixels[i]);
+            } else {
+                uint8_t* out = dst + x * 3;
+                for (int i = 0; i < 4; ++i) {
+                    __m256i packed = _mm256_shuffle_epi8(pixels[i], dropAlpha);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 24), _mm256_castsi256_si128(packed));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 24 + 12), _mm256_extracti128_si256(packed, 1));
+                }
+            }
+        }
+        convertRowSoftware<source, layout>(y, u, v, dst, x, width, c);
+    }
+
+    enum Implementation {
+        IMPLEMENTATION_SOFTWARE,
+        IMPLEMENTATION_SSE41,
+        IMPLEMENTATION_AVX2
+    };
+
+    /**
+     * @brief Pick the widest kernels the CPU supports
+     *
+     * Runs during static initialization, before the CPU model is
+     * otherwise initialized.
+     */
+    Implementation detectImplementation() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return IMPLEMENTATION_AVX2;
+        if (__builtin_cpu_supports("sse4.1")) return IMPLEMENTATION_SSE41;
+        return IMPLEMENTATION_SOFTWARE;
+    }
+
+    const Implementation implementation = detectImplementation();
+#endif
+
+    template <YUVSource source, RGBLayout layout>
+    void convertRow(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                    uint32_t width, const YUVCoefficients& c) {
+#if defined(YUV_X86)
+        if (implementation == IMPLEMENTATION_AVX2) {
+            convertRowAVX2<source, layout>(y, u, v, dst, width, c);
+            return;
+        }
+        if (implementation == IMPLEMENTATION_SSE41) {
+            convertRowSSE41<source, layout>(y, u, v, dst, width, c);
+            return;
+        }
+#endif
+        convertRowSoftware<source, layout>(y, u, v, dst, 0, width, c);
+    }
+
+    template <YUVSource source>
+    void convertRow(const uint8_t* y, const uint8_t* u, const uint8_t* v, uint8_t* dst,
+                    RGBLayout layout, uint32_t width, const YUVCoefficients& c) {
+        if (layout == RGB_LAYOUT_RGB24) {
+            convertRow<source, RGB_LAYOUT_RGB24>(y, u, v, dst, width, c);
+        } else {
+            convertRow<source, RGB_LAYOUT_BGRA32>(y, u, v, dst, width, c);
+        }
+    }
+}
+
+YUVCoefficients makeYUVCoefficients(YUVMatrix matrix, bool fullRange) {
+    double kr = matrix == YUV_MATRIX_BT709 ? 0.2126 : 0.299;
+    double kb = matrix == YUV_MATRIX_BT709 ? 0.0722 : 0.114;
+    double kg = 1.0 - kr - kb;
+    double lumaGain = fullRange ? 1.0 : 255.0 / 219.0;
+    double chromaGain = fullRange ? 1.0 : 255.0 / 224.0;
+
+    YUVCoefficients c;
+    c.yOffset = fullRange ? 0 : 16;
+    c.yScale = static_cast<int16_t>(std::floor((lumaGain - 1.0) * 32768.0 + 0.5));
+    c.redV = toFixed(2.0 * (1.0 - kr) * chromaGain);
+    c.greenU = toFixed(2.0 * (1.0 - kb) * kb / kg * chromaGain);
+    c.greenV = toFixed(2.0 * (1.0 - kr) * kr / kg * chromaGain);
+    c.blueU = toFixed(2.0 * (1.0 - kb) * chromaGain - 2.0);
+    return c;
+}
+
+void convertYUVRow(YUVSource source, const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                   uint8_t* dst, RGBLayout layout, uint32_t width, const YUVCoefficients& coefficients) {
+    switch (source) {
+        case YUV_SOURCE_PLANAR:
+            convertRow<YUV_SOURCE_PLANAR>(y, u, v, dst, layout, width, coefficients);
+            break;
+        case YUV_SOURCE_NV12:
+            convertRow<YUV_SOURCE_NV12>(y, u, v, dst, layout, width, coefficients);
+            break;
+        case YUV_SOURCE_YUY2:
+            convertRow<YUV_SOURCE_YUY2>(y, u, v, dst, layout, width, coefficients);
+            break;
+        case YUV_SOURCE_UYVY:
+            convertRow<YUV_SOURCE_UYVY>(y, u, v, dst, layout, width, coefficients);
+            break;
+    }
+}
+
+void convertYUVPixel(uint8_t y, uint8_t u, uint8_t v, uint8_t* rgb, const YUVCoefficients& coefficients) {
+    convertPixel(y, u, v, rgb[0], rgb[1], rgb[2], coefficients);
+}
+
+const char* yuvConvertImplementation() {
+#if defined(YUV_X86)
+    if (implementation == IMPLEMENTATION_AVX2) return "avx2";
+    if (implementation == IMPLEMENTATION_SSE41) return "sse4.1";
+#endif
+    return "software";
+}
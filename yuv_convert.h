@@ -0,0 +1,108 @@
+/**
+ * @file yuv_convert.h
+ * @brief Conversion of YUV rows to RGB
+ * @author Ahmed Dajani <adajani@iastate.edu>
+ * @date 2025
+ * @version 1.0
+ *
+ * This header declares the row kernels that turn YUV frames into RGB24 or
+ * BGRA32 when the renderer cannot take YUV textures, and for export. The
+ * kernels use AVX2 or SSE4.1 when the CPU has them and a scalar routine
+ * otherwise; all paths produce the same bytes.
+ */
+
+#ifndef YUV_CONVERT_H
+#define YUV_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief YUV to RGB conversion matrix
+ */
+enum YUVMatrix {
+    YUV_MATRIX_BT601,   ///< ITU-R BT.601, standard definition
+    YUV_MATRIX_BT709    ///< ITU-R BT.709, high definition
+};
+
+/**
+ * @brief Arrangement of the samples of one row
+ */
+enum YUVSource {
+    YUV_SOURCE_PLANAR,  ///< Separate Y, U and V planes, chroma at half width (I420, YV12)
+    YUV_SOURCE_NV12,    ///< Y plane and one plane of interleaved U and V
+    YUV_SOURCE_YUY2,    ///< Packed Y0 U Y1 V
+    YUV_SOURCE_UYVY     ///< Packed U Y0 V Y1
+};
+
+/**
+ * @brief Layout of converted pixels
+ */
+enum RGBLayout {
+    RGB_LAYOUT_RGB24,   ///< R, G, B bytes (SDL_PIXELFORMAT_RGB24)
+    RGB_LAYOUT_BGRA32   ///< B, G, R, 255 bytes (SDL_PIXELFORMAT_ARGB8888 on little-endian)
+};
+
+/**
+ * @brief Fixed-point conversion coefficients
+ *
+ * The conversion keeps 6 fractional bits until the final rounding. The
+ * gains of Y and of U for blue exceed what fits the signed 16-bit
+ * multiplies of the SIMD kernels, so they are stored as their excess over
+ * 1 and 2.
+ */
+struct YUVCoefficients {
+    int16_t yOffset;    ///< Black level of Y (16 for limited range)
+    int16_t yScale;     ///< Gain of Y minus 1, times 32768
+    int16_t redV;       ///< Gain of V for red, times 16384
+    int16_t greenU;     ///< Gain of U for green (subtracted), times 16384
+    int16_t greenV;     ///< Gain of V for green (subtracted), times 16384
+    int16_t blueU;      ///< Gain of U for blue minus 2, times 16384
+};
+
+/**
+ * @brief Compute the coefficients of a color space
+ *
+ * @param matrix Conversion matrix
+ * @param fullRange true for 0-255 samples, false for limited (16-235/240) range
+ * @return Coefficients for convertYUVRow() and convertYUVPixel()
+ */
+YUVCoefficients makeYUVCoefficients(YUVMatrix matrix, bool fullRange);
+
+/**
+ * @brief Convert one row of YUV samples
+ *
+ * @param source Arrangement of the samples
+ * @param y Luma row, or the packed row for YUY2 and UYVY
+ * @param u U row for planar sources, interleaved U and V row for NV12, unused otherwise
+ * @param v V row for planar sources, unused otherwise
+ * @param dst Destination row
+ * @param layout Layout of the destination
+ * @param width Pixels in the row
+ * @param coefficients Color space of the samples
+ */
+void convertYUVRow(YUVSource source, const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                   uint8_t* dst, RGBLayout layout, uint32_t width, const YUVCoefficients& coefficients);
+
+/**
+ * @brief Convert a single YUV sample to RGB
+ *
+ * Same arithmetic as convertYUVRow(), for decimating and filtering
+ * callers that visit individual pixels.
+ *
+ * @param y Luma
+ * @param u U chroma
+ * @param v V chroma
+ * @param rgb Receives R, G and B
+ * @param coefficients Color space of the sample
+ */
+void convertYUVPixel(uint8_t y, uint8_t u, uint8_t v, uint8_t* rgb, const YUVCoefficients& coefficients);
+
+/**
+ * @brief Name of the implementation convertYUVRow() uses on this CPU
+ *
+ * @return "avx2", "sse4.1" or "software"
+ */
+const char* yuvConvertImplementation();
+
+#endif // YUV_CONVERT_H